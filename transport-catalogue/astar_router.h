@@ -0,0 +1,146 @@
+#pragma once
+
+#include "routing_engine.h"
+#include "dijkstra_router.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+namespace graph {
+/**
+ * Маршрутизация поиском A* на каждый запрос.
+ * Heuristic — вызываемый объект Weight(VertexId vertex, VertexId to), нижняя оценка
+ * веса пути от vertex до to. Оценка должна быть допустимой (не превышать веса
+ * кратчайшего пути), тогда найденный маршрут оптимален; при согласованной оценке
+ * каждая вершина извлекается из очереди не более одного раза.
+ * Построение O(E), память O(V + E), запрос в худшем случае как у Дейкстры.
+ */
+template <typename Weight, typename Heuristic>
+class AStarRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    AStarRouter(const Graph& graph, Heuristic heuristic);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    /**
+     * Оценка ведёт поиск к одной вершине, поэтому до нескольких вершин
+     * выполняется один поиск Дейкстры без оценки
+     */
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override;
+
+    std::optional<SearchStats> GetSearchStats() const override;
+
+private:
+    /**
+     * Элемент очереди с приоритетом: оценка полного пути, вес пути до вершины и сама вершина
+     */
+    using QueueItem = std::tuple<Weight, Weight, VertexId>;
+    using Heap = std::vector<QueueItem>;
+    /**
+     * Рабочая область одного запроса
+     */
+    struct Workspace {
+        SearchLabels<Weight> labels;
+        Heap heap;
+    };
+
+    static constexpr Weight ZERO_WEIGHT{};
+
+    const Graph& graph_;
+    Heuristic heuristic_;
+    WorkspacePool<Workspace> workspaces_;
+    SearchStatsCounter stats_;
+};
+
+template <typename Weight, typename Heuristic>
+AStarRouter<Weight, Heuristic>::AStarRouter(const Graph& graph, Heuristic heuristic)
+    : graph_(graph)
+    , heuristic_(std::move(heuristic))
+{
+    CheckNonNegativeWeights(graph);
+}
+
+template <typename Weight, typename Heuristic>
+std::optional<typename AStarRouter<Weight, Heuristic>::RouteInfo>
+AStarRouter<Weight, Heuristic>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    auto workspace = workspaces_.Acquire();
+    auto& labels = workspace->labels;
+    labels.Reset(graph_.GetVertexCount());
+    auto& heap = workspace->heap;
+    heap.clear();
+    const auto push = [&heap](Weight estimate, Weight weight, VertexId vertex) {
+        heap.emplace_back(estimate, weight, vertex);
+        std::push_heap(heap.begin(), heap.end(), std::greater<QueueItem>{});
+    };
+
+    size_t settled_count = 0;
+    bool found = false;
+    labels.Set(from, ZERO_WEIGHT, SearchLabels<Weight>::NO_EDGE);
+    push(heuristic_(from, to), ZERO_WEIGHT, from);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<QueueItem>{});
+        const auto [estimate, weight, vertex] = heap.back();
+        heap.pop_back();
+        // устаревшая запись: до вершины уже найден более короткий путь
+        if (labels.GetWeight(vertex) < weight) {
+            continue;
+        }
+        ++settled_count;
+        if (vertex == to) {
+            found = true;
+            break;
+        }
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const VertexId edge_to = graph_.GetEdgeTarget(edge_id);
+            const Weight candidate_weight = weight + graph_.GetEdgeWeight(edge_id);
+            if (!labels.IsReached(edge_to) || candidate_weight < labels.GetWeight(edge_to)) {
+                labels.Set(edge_to, candidate_weight, edge_id);
+                push(candidate_weight + heuristic_(edge_to, to), candidate_weight, edge_to);
+            }
+        }
+    }
+    stats_.AddSearch(settled_count);
+    if (!found) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = labels.GetPrevEdge(to); edge_id != SearchLabels<Weight>::NO_EDGE;
+         edge_id = labels.GetPrevEdge(graph_.GetEdgeSource(edge_id)))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{labels.GetWeight(to), std::move(edges)};
+}
+
+template <typename Weight, typename Heuristic>
+std::vector<std::optional<Weight>> AStarRouter<Weight, Heuristic>::BuildWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    if (targets.size() == 1) {
+        return RoutingEngine<Weight>::BuildWeights(from, targets);
+    }
+    if (targets.empty()) {
+        return {};
+    }
+    const ShortestPathTree<Weight> tree(graph_, from, targets);
+    stats_.AddSearch(tree.GetSettledCount());
+    return tree.GetWeights(targets);
+}
+
+template <typename Weight, typename Heuristic>
+std::optional<SearchStats> AStarRouter<Weight, Heuristic>::GetSearchStats() const {
+    return stats_.Get();
+}
+
+}  // namespace graph
@@ -0,0 +1,96 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+/**
+ * Счётчики выделений динамической памяти
+ */
+std::atomic<size_t> allocation_count{0};
+std::atomic<size_t> allocated_bytes{0};
+/**
+ * Текущий и пиковый объём выделенной памяти
+ */
+std::atomic<size_t> live_bytes{0};
+std::atomic<size_t> peak_bytes{0};
+/**
+ * Размер заголовка блока, в котором хранится запрошенный размер;
+ * сохраняет выравнивание возвращаемого указателя
+ */
+constexpr size_t ALLOCATION_HEADER = alignof(std::max_align_t);
+
+void* Allocate(std::size_t size) noexcept {
+    void* block = std::malloc(size + ALLOCATION_HEADER);
+    if (block == nullptr) {
+        return nullptr;
+    }
+    *static_cast<std::size_t*>(block) = size;
+    ++allocation_count;
+    allocated_bytes += size;
+    const size_t live = live_bytes += size;
+    size_t peak = peak_bytes.load();
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live)) {
+    }
+    return static_cast<char*>(block) + ALLOCATION_HEADER;
+}
+
+void Deallocate(void* pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - ALLOCATION_HEADER;
+    live_bytes -= *static_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+}
+
+namespace benchmark {
+
+AllocationStats GetAllocationStats() {
+    return {allocation_count.load(), allocated_bytes.load(), live_bytes.load(), peak_bytes.load()};
+}
+
+void ResetPeakBytes() {
+    peak_bytes = live_bytes.load();
+}
+
+}
+/**
+ * Глобальные операторы выделения памяти с подсчётом выделений и объёма памяти
+ */
+void* operator new(std::size_t size) {
+    if (void* pointer = Allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+void operator delete(void* pointer) noexcept {
+    Deallocate(pointer);
+}
+void operator delete[](void* pointer) noexcept {
+    Deallocate(pointer);
+}
+void operator delete(void* pointer, std::size_t) noexcept {
+    Deallocate(pointer);
+}
+void operator delete[](void* pointer, std::size_t) noexcept {
+    Deallocate(pointer);
+}
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    Deallocate(pointer);
+}
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    Deallocate(pointer);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+/**
+ * Подсчёт выделений динамической памяти.
+ * Глобальные operator new и operator delete заменены в allocation_counter.cpp:
+ * выделение и освобождение определены в одной единице трансляции и не встраиваются
+ * в код контейнеров, поэтому пары new/delete остаются согласованными.
+ */
+namespace benchmark {
+/**
+ * Снимок счётчиков выделений
+ */
+struct AllocationStats {
+    size_t allocation_count = 0;
+    size_t allocated_bytes = 0;
+    /**
+     * Текущий и пиковый объём выделенной памяти
+     */
+    size_t live_bytes = 0;
+    size_t peak_bytes = 0;
+};
+
+AllocationStats GetAllocationStats();
+/**
+ * Сбрасывает пиковый объём до текущего
+ */
+void ResetPeakBytes();
+
+}
@@ -0,0 +1,310 @@
+#include "network_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+namespace benchmark {
+
+namespace {
+/**
+ * Широта и долгота центра сети
+ */
+constexpr double CENTER_LAT = 55.75;
+constexpr double CENTER_LNG = 37.6;
+constexpr double METRES_PER_DEGREE = 111320.0;
+constexpr double PI = 3.14159265358979323846;
+/**
+ * Отношение дорожного расстояния к расстоянию по прямой
+ */
+constexpr double MIN_ROAD_RATIO = 1.1;
+constexpr double MAX_ROAD_RATIO = 1.4;
+/**
+ * Остановка сети: название и положение относительно центра, в метрах
+ */
+struct StopPlace {
+    std::string name;
+    double x;
+    double y;
+};
+/**
+ * Маршрут сети: индексы остановок в порядке следования
+ */
+struct RoutePlan {
+    std::vector<size_t> stops;
+    bool is_roundtrip = false;
+};
+/**
+ * Остановки и маршруты сети до заполнения каталога
+ */
+struct NetworkPlan {
+    std::vector<StopPlace> stops;
+    std::vector<RoutePlan> routes;
+};
+/**
+ * Разбить последовательность остановок на маршруты длиной route_length,
+ * соседние маршруты перекрываются на одну остановку
+ */
+void AddSegments(const std::vector<size_t>& line, size_t route_length, std::vector<RoutePlan>& routes) {
+    const size_t step = std::max<size_t>(route_length, 2) - 1;
+    for (size_t begin = 0; begin + 1 < line.size(); begin += step) {
+        const size_t end = std::min(line.size(), begin + step + 1);
+        routes.push_back({std::vector<size_t>(line.begin() + begin, line.begin() + end), false});
+    }
+}
+
+NetworkPlan MakeGrid(const NetworkParams& params) {
+    const size_t side = std::max<size_t>(2, static_cast<size_t>(std::ceil(std::sqrt(params.stop_count))));
+    NetworkPlan plan;
+    plan.stops.reserve(side * side);
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t column = 0; column < side; ++column) {
+            plan.stops.push_back({"G" + std::to_string(row) + "_" + std::to_string(column),
+                                  static_cast<double>(column) * params.stop_spacing,
+                                  static_cast<double>(row) * params.stop_spacing});
+        }
+    }
+    std::vector<size_t> line(side);
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t column = 0; column < side; ++column) {
+            line[column] = row * side + column;
+        }
+        AddSegments(line, params.route_length, plan.routes);
+    }
+    for (size_t column = 0; column < side; ++column) {
+        for (size_t row = 0; row < side; ++row) {
+            line[row] = row * side + column;
+        }
+        AddSegments(line, params.route_length, plan.routes);
+    }
+    return plan;
+}
+
+NetworkPlan MakeRadial(const NetworkParams& params) {
+    // радиальный маршрут проходит центр и все кольца
+    const size_t rings = std::max<size_t>(params.route_length, 2) - 1;
+    const size_t spokes = std::max<size_t>(3, (params.stop_count + rings - 2) / rings);
+    NetworkPlan plan;
+    plan.stops.reserve(rings * spokes + 1);
+    plan.stops.push_back({"R0", 0.0, 0.0});
+    for (size_t ring = 1; ring <= rings; ++ring) {
+        const double radius = static_cast<double>(ring) * params.stop_spacing;
+        for (size_t spoke = 0; spoke < spokes; ++spoke) {
+            const double angle = 2.0 * PI * static_cast<double>(spoke) / static_cast<double>(spokes);
+            plan.stops.push_back({"R" + std::to_string(ring) + "_" + std::to_string(spoke),
+                                  radius * std::cos(angle), radius * std::sin(angle)});
+        }
+    }
+    const auto get_stop = [spokes](size_t ring, size_t spoke) {
+        return 1 + (ring - 1) * spokes + spoke % spokes;
+    };
+    for (size_t spoke = 0; spoke < spokes; ++spoke) {
+        RoutePlan route;
+        route.stops.push_back(0);
+        for (size_t ring = 1; ring <= rings; ++ring) {
+            route.stops.push_back(get_stop(ring, spoke));
+        }
+        plan.routes.push_back(std::move(route));
+    }
+    for (size_t ring = 1; ring <= rings; ++ring) {
+        std::vector<size_t> line;
+        for (size_t spoke = 0; spoke <= spokes; ++spoke) {
+            line.push_back(get_stop(ring, spoke));
+        }
+        if (spokes < params.route_length) {
+            plan.routes.push_back({std::move(line), true});
+        }
+        else {
+            AddSegments(line, params.route_length, plan.routes);
+        }
+    }
+    return plan;
+}
+
+NetworkPlan MakeCity(const NetworkParams& params, std::mt19937& random) {
+    const size_t stop_count = std::max<size_t>(params.stop_count, 2);
+    const double side = std::sqrt(static_cast<double>(stop_count)) * params.stop_spacing;
+    std::uniform_real_distribution<double> coordinate(0.0, side);
+    NetworkPlan plan;
+    plan.stops.reserve(stop_count);
+    for (size_t i = 0; i < stop_count; ++i) {
+        plan.stops.push_back({"C" + std::to_string(i), coordinate(random), coordinate(random)});
+    }
+    // соседи ищутся по квадратным ячейкам со стороной в радиус поиска
+    const double radius = 2.0 * params.stop_spacing;
+    const size_t cells_per_side = std::max<size_t>(1, static_cast<size_t>(side / radius));
+    const auto get_cell = [&](double value) {
+        return std::min(cells_per_side - 1, static_cast<size_t>(value / radius));
+    };
+    std::vector<std::vector<size_t>> cells(cells_per_side * cells_per_side);
+    for (size_t i = 0; i < stop_count; ++i) {
+        cells[get_cell(plan.stops[i].y) * cells_per_side + get_cell(plan.stops[i].x)].push_back(i);
+    }
+
+    std::uniform_int_distribution<size_t> any_stop(0, stop_count - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const size_t route_length = std::max<size_t>(params.route_length, 2);
+    const size_t route_count = (2 * stop_count + route_length - 1) / route_length;
+    std::vector<char> visited(stop_count, 0);
+    for (size_t r = 0; r < route_count; ++r) {
+        RoutePlan route;
+        size_t current = any_stop(random);
+        const double angle = 2.0 * PI * unit(random);
+        double direction_x = std::cos(angle);
+        double direction_y = std::sin(angle);
+        route.stops.push_back(current);
+        visited[current] = 1;
+        while (route.stops.size() < route_length) {
+            // следующая остановка — непосещённый сосед, лучше всего продолжающий направление
+            const StopPlace& place = plan.stops[current];
+            const size_t cell_x = get_cell(place.x);
+            const size_t cell_y = get_cell(place.y);
+            std::optional<size_t> next;
+            double best_score = 0.0;
+            for (size_t y = cell_y > 0 ? cell_y - 1 : 0; y <= std::min(cells_per_side - 1, cell_y + 1); ++y) {
+                for (size_t x = cell_x > 0 ? cell_x - 1 : 0; x <= std::min(cells_per_side - 1, cell_x + 1); ++x) {
+                    for (const size_t candidate : cells[y * cells_per_side + x]) {
+                        const double dx = plan.stops[candidate].x - place.x;
+                        const double dy = plan.stops[candidate].y - place.y;
+                        const double length = std::hypot(dx, dy);
+                        if (visited[candidate] || length == 0.0 || length > radius) {
+                            continue;
+                        }
+                        const double score = (dx * direction_x + dy * direction_y) / length + unit(random);
+                        if (!next || score > best_score) {
+                            next = candidate;
+                            best_score = score;
+                        }
+                    }
+                }
+            }
+            if (!next) {
+                break;
+            }
+            const double dx = plan.stops[*next].x - place.x;
+            const double dy = plan.stops[*next].y - place.y;
+            const double length = std::hypot(dx, dy);
+            direction_x = dx / length;
+            direction_y = dy / length;
+            current = *next;
+            route.stops.push_back(current);
+            visited[current] = 1;
+        }
+        for (const size_t stop : route.stops) {
+            visited[stop] = 0;
+        }
+        if (route.stops.size() >= 2) {
+            plan.routes.push_back(std::move(route));
+        }
+    }
+    return plan;
+}
+
+geo::Coordinates ToCoordinates(const StopPlace& place) {
+    return {CENTER_LAT + place.y / METRES_PER_DEGREE,
+            CENTER_LNG + place.x / (METRES_PER_DEGREE * std::cos(CENTER_LAT * PI / 180.0))};
+}
+
+}  // namespace
+
+std::string_view NetworkKindName(NetworkKind kind) {
+    switch (kind) {
+    case NetworkKind::GRID:
+        return "grid";
+    case NetworkKind::RADIAL:
+        return "radial";
+    case NetworkKind::CITY:
+        return "city";
+    }
+    return {};
+}
+
+std::optional<NetworkKind> NetworkKindFromName(std::string_view name) {
+    for (const NetworkKind kind : {NetworkKind::GRID, NetworkKind::RADIAL, NetworkKind::CITY}) {
+        if (NetworkKindName(kind) == name) {
+            return kind;
+        }
+    }
+    return std::nullopt;
+}
+
+void GenerateNetwork(const NetworkParams& params, transport::Catalogue& catalogue) {
+    std::mt19937 random(params.seed);
+    NetworkPlan plan;
+    switch (params.kind) {
+    case NetworkKind::GRID:
+        plan = MakeGrid(params);
+        break;
+    case NetworkKind::RADIAL:
+        plan = MakeRadial(params);
+        break;
+    case NetworkKind::CITY:
+        plan = MakeCity(params, random);
+        break;
+    }
+
+    std::vector<const transport::Stop*> stops;
+    stops.reserve(plan.stops.size());
+    for (const auto& place : plan.stops) {
+        catalogue.AddStop({place.name, ToCoordinates(place)});
+        stops.push_back(catalogue.FindStop(place.name));
+    }
+    // расстояния задаются один раз для каждой упорядоченной пары остановок
+    std::unordered_set<uint64_t> known_distances;
+    std::uniform_real_distribution<double> road_ratio(MIN_ROAD_RATIO, MAX_ROAD_RATIO);
+    const auto set_distance = [&](size_t from, size_t to) {
+        if (from == to || !known_distances.insert(static_cast<uint64_t>(from) * stops.size() + to).second) {
+            return;
+        }
+        const double geo_distance = geo::ComputeDistance(stops[from]->coordinates, stops[to]->coordinates);
+        catalogue.SetDistance(stops[from], stops[to], static_cast<int>(std::ceil(geo_distance * road_ratio(random))));
+    };
+    std::bernoulli_distribution asymmetric(0.5);
+    for (size_t r = 0; r < plan.routes.size(); ++r) {
+        const auto& route = plan.routes[r];
+        std::vector<const transport::Stop*> route_stops;
+        for (size_t i = 0; i < route.stops.size(); ++i) {
+            route_stops.push_back(stops[route.stops[i]]);
+            if (i > 0) {
+                set_distance(route.stops[i - 1], route.stops[i]);
+                // обратное расстояние без отдельного значения берётся из прямого
+                if (!route.is_roundtrip && asymmetric(random)) {
+                    set_distance(route.stops[i], route.stops[i - 1]);
+                }
+            }
+        }
+        if (!route.is_roundtrip) {
+            route_stops.insert(route_stops.end(), std::next(route_stops.rbegin()), route_stops.rend());
+        }
+        catalogue.AddRoute(std::to_string(r + 1), route_stops, route.is_roundtrip);
+    }
+    const size_t distance_count = static_cast<size_t>(params.distance_density * static_cast<double>(stops.size()));
+    std::uniform_int_distribution<size_t> any_stop(0, stops.size() - 1);
+    for (size_t attempt = 0; known_distances.size() < distance_count && attempt < 2 * distance_count; ++attempt) {
+        set_distance(any_stop(random), any_stop(random));
+    }
+}
+
+std::vector<std::pair<const transport::Stop*, const transport::Stop*>>
+GenerateQueries(const transport::Catalogue& catalogue, size_t count, uint32_t seed) {
+    const auto stops = catalogue.GetStops(transport::SORTED);
+    std::vector<std::pair<const transport::Stop*, const transport::Stop*>> queries;
+    if (stops.size() < 2) {
+        return queries;
+    }
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<size_t> any_stop(0, stops.size() - 1);
+    queries.reserve(count);
+    while (queries.size() < count) {
+        const size_t from = any_stop(random);
+        const size_t to = any_stop(random);
+        if (from != to) {
+            queries.emplace_back(stops[from], stops[to]);
+        }
+    }
+    return queries;
+}
+
+}  // namespace benchmark
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+/**
+ * Синтетические транспортные сети для измерения производительности маршрутизации
+ */
+namespace benchmark {
+/**
+ * Вид синтетической сети
+ */
+enum class NetworkKind {
+    /**
+     * Остановки в узлах квадратной решётки; маршруты идут вдоль строк и столбцов
+     * отрезками заданной длины, соседние отрезки перекрываются на одну остановку
+     */
+    GRID = 0,
+    /**
+     * Центральная остановка и кольца остановок вокруг неё; радиальные маршруты
+     * идут от центра до внешнего кольца, кольцевые — по дугам колец
+     */
+    RADIAL,
+    /**
+     * Остановки, случайно разбросанные по квадратному городу; маршруты —
+     * случайные блуждания по ближайшим соседям с предпочтением прямого направления,
+     * каждая остановка в среднем обслуживается двумя маршрутами
+     */
+    CITY
+};
+/**
+ * Параметры синтетической сети
+ */
+struct NetworkParams {
+    NetworkKind kind = NetworkKind::GRID;
+    /**
+     * Количество остановок (для решётки и колец округляется до полной фигуры)
+     */
+    size_t stop_count = 1000;
+    /**
+     * Количество остановок маршрута
+     */
+    size_t route_length = 20;
+    /**
+     * Среднее количество дорожных расстояний на остановку. Кроме расстояний между
+     * соседними остановками маршрутов добавляются расстояния между случайными
+     * остановками: они не влияют на маршруты, но увеличивают таблицу расстояний,
+     * как в реальных данных.
+     */
+    double distance_density = 2.0;
+    /**
+     * Расстояние между соседними остановками, в метрах
+     */
+    double stop_spacing = 400.0;
+    uint32_t seed = 1;
+};
+/**
+ * Название вида сети
+ */
+std::string_view NetworkKindName(NetworkKind kind);
+/**
+ * Вид сети по названию (grid, radial, city)
+ */
+std::optional<NetworkKind> NetworkKindFromName(std::string_view name);
+/**
+ * Заполнить каталог остановками, маршрутами и расстояниями синтетической сети
+ */
+void GenerateNetwork(const NetworkParams& params, transport::Catalogue& catalogue);
+/**
+ * Случайные пары различных остановок каталога для запросов маршрута
+ */
+std::vector<std::pair<const transport::Stop*, const transport::Stop*>>
+GenerateQueries(const transport::Catalogue& catalogue, size_t count, uint32_t seed);
+
+}  // namespace benchmark
@@ -0,0 +1,552 @@
+#include "allocation_counter.h"
+#include "json_builder.h"
+#include "json_reader.h"
+#include "request_handler.h"
+#include "map_renderer.h"
+#include "network_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+/**
+ * Сравнение алгоритмов маршрутизации.
+ * Сеть берётся из входного JSON (запросы — его запросы Route) или генерируется
+ * (решётка, кольца или случайный город; запросы — случайные пары остановок).
+ * Для каждого алгоритма измеряются время Router::Build, пиковый и оставшийся
+ * после сборки объём динамической памяти, количество выделений при сборке,
+ * перцентили задержки GetOptimalRoute (или GetTravelTime при --travel-times)
+ * количество извлечённых из очереди вершин, рёбер графа и отброшенных параллельных рёбер.
+ * Результаты выводятся таблицей или в JSON.
+ *
+ * Использование: routing-benchmark [параметры] [input.json]
+ *   --network grid|radial|city   сгенерировать сеть вместо чтения входного JSON
+ *   --stops N                    количество остановок (1000)
+ *   --route-length N             количество остановок маршрута (20)
+ *   --distance-density D         среднее количество дорожных расстояний на остановку (2)
+ *   --spacing M                  расстояние между соседними остановками, м (400)
+ *   --seed S                     зерно генератора сети и запросов (1)
+ *   --queries N                  количество случайных запросов (1000)
+ *   --algorithms A,B,...         алгоритмы (dijkstra,a_star)
+ *   --graph-model span_edges|linear
+ *   --compact                    компактная таблица маршрутов для Флойда–Уоршелла
+ *   --travel-times               запрашивать только время поездки, без построения маршрута
+ *   --keep-parallel-edges        не отбрасывать параллельные рёбра-поездки
+ *   --fixed-point                веса в фиксированной точке (сотые доли секунды)
+ *   --close-stops N              закрыть N остановок, равномерно выбранных из упорядоченных
+ *   --min-plus-kernel scalar|avx2|avx512  ядро релаксации компактной таблицы
+ *   --json                       вывести результаты в JSON вместо таблицы
+ *   --output FILE                дополнительно записать результаты в JSON-файл
+ * Без --network и входного файла сеть читается из стандартного ввода.
+ */
+namespace {
+using StopPair = std::pair<const transport::Stop*, const transport::Stop*>;
+/**
+ * Параметры запуска
+ */
+struct Options {
+    std::optional<benchmark::NetworkParams> network;
+    std::string input_file;
+    size_t query_count = 1000;
+    std::vector<std::string> algorithms = {"dijkstra", "a_star"};
+    transport::TransitGraphModel graph_model = transport::TransitGraphModel::SPAN_EDGES;
+    bool compact_routes_storage = false;
+    bool travel_times_only = false;
+    bool prune_parallel_edges = true;
+    bool fixed_point_weights = false;
+    size_t closed_stop_count = 0;
+    bool json_output = false;
+    std::string output_file;
+};
+/**
+ * Перцентили задержки запросов, в микросекундах
+ */
+struct LatencyStats {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+/**
+ * Результат прогона одного алгоритма
+ */
+struct BenchmarkResult {
+    std::string algorithm;
+    double build_ms = 0.0;
+    size_t build_allocations = 0;
+    /**
+     * Пиковый прирост объёма памяти при сборке
+     */
+    size_t build_peak_bytes = 0;
+    /**
+     * Память, занятая маршрутизатором после сборки
+     */
+    size_t retained_bytes = 0;
+    double queries_ms = 0.0;
+    LatencyStats latency;
+    size_t found = 0;
+    /**
+     * Сумма времени найденных маршрутов — для сверки алгоритмов между собой
+     */
+    double total_time_sum = 0.0;
+    std::optional<graph::SearchStats> search_stats;
+    size_t edge_count = 0;
+    size_t pruned_edge_count = 0;
+};
+
+const std::map<std::string_view, transport::RoutingAlgorithm>& GetAlgorithms() {
+    static const std::map<std::string_view, transport::RoutingAlgorithm> algorithms = {
+        {"floyd_warshall", transport::RoutingAlgorithm::FLOYD_WARSHALL},
+        {"floyd_warshall_parallel", transport::RoutingAlgorithm::FLOYD_WARSHALL_PARALLEL},
+        {"dijkstra", transport::RoutingAlgorithm::DIJKSTRA},
+        {"dijkstra_cached", transport::RoutingAlgorithm::DIJKSTRA_CACHED},
+        {"contraction_hierarchies", transport::RoutingAlgorithm::CONTRACTION_HIERARCHIES},
+        {"a_star", transport::RoutingAlgorithm::A_STAR},
+        {"raptor", transport::RoutingAlgorithm::RAPTOR},
+        {"bidirectional_dijkstra", transport::RoutingAlgorithm::BIDIRECTIONAL_DIJKSTRA},
+        {"hub_labels", transport::RoutingAlgorithm::HUB_LABELS},
+    };
+    return algorithms;
+}
+
+std::string_view MinPlusKernelName(graph::MinPlusKernel kernel) {
+    switch (kernel) {
+    case graph::MinPlusKernel::SCALAR:
+        return "scalar";
+    case graph::MinPlusKernel::AVX2:
+        return "avx2";
+    case graph::MinPlusKernel::AVX512:
+        return "avx512";
+    }
+    return {};
+}
+
+std::optional<graph::MinPlusKernel> MinPlusKernelFromName(std::string_view name) {
+    for (const auto kernel : {graph::MinPlusKernel::SCALAR, graph::MinPlusKernel::AVX2, graph::MinPlusKernel::AVX512}) {
+        if (MinPlusKernelName(kernel) == name) {
+            return kernel;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> SplitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream stream(list);
+    for (std::string item; std::getline(stream, item, ',');) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+/**
+ * Разбор параметров командной строки; при ошибке выбрасывает std::invalid_argument
+ */
+Options ParseOptions(int argc, char* argv[]) {
+    using namespace std::literals;
+    Options options;
+    benchmark::NetworkParams params;
+    std::optional<benchmark::NetworkKind> kind;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        if (argument == "--json"sv) {
+            options.json_output = true;
+            continue;
+        }
+        if (argument == "--compact"sv) {
+            options.compact_routes_storage = true;
+            continue;
+        }
+        if (argument == "--travel-times"sv) {
+            options.travel_times_only = true;
+            continue;
+        }
+        if (argument == "--fixed-point"sv) {
+            options.fixed_point_weights = true;
+            continue;
+        }
+        if (argument == "--keep-parallel-edges"sv) {
+            options.prune_parallel_edges = false;
+            continue;
+        }
+        if (argument.substr(0, 2) != "--"sv) {
+            options.input_file = argument;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for "s + std::string(argument));
+        }
+        const std::string value = argv[++i];
+        if (argument == "--network"sv) {
+            kind = benchmark::NetworkKindFromName(value);
+            if (!kind) {
+                throw std::invalid_argument("Unknown network: "s + value);
+            }
+        }
+        else if (argument == "--stops"sv) {
+            params.stop_count = std::stoul(value);
+        }
+        else if (argument == "--route-length"sv) {
+            params.route_length = std::stoul(value);
+        }
+        else if (argument == "--distance-density"sv) {
+            params.distance_density = std::stod(value);
+        }
+        else if (argument == "--spacing"sv) {
+            params.stop_spacing = std::stod(value);
+        }
+        else if (argument == "--seed"sv) {
+            params.seed = static_cast<uint32_t>(std::stoul(value));
+        }
+        else if (argument == "--queries"sv) {
+            options.query_count = std::stoul(value);
+        }
+        else if (argument == "--close-stops"sv) {
+            options.closed_stop_count = std::stoul(value);
+        }
+        else if (argument == "--algorithms"sv) {
+            options.algorithms = SplitList(value);
+        }
+        else if (argument == "--graph-model"sv) {
+            if (value == "span_edges"s) {
+                options.graph_model = transport::TransitGraphModel::SPAN_EDGES;
+            }
+            else if (value == "linear"s) {
+                options.graph_model = transport::TransitGraphModel::LINEAR;
+            }
+            else {
+                throw std::invalid_argument("Unknown graph model: "s + value);
+            }
+        }
+        else if (argument == "--min-plus-kernel"sv) {
+            const auto kernel = MinPlusKernelFromName(value);
+            if (!kernel || !graph::SetMinPlusKernel(*kernel)) {
+                throw std::invalid_argument("Unsupported min-plus kernel: "s + value);
+            }
+        }
+        else if (argument == "--output"sv) {
+            options.output_file = value;
+        }
+        else {
+            throw std::invalid_argument("Unknown option: "s + std::string(argument));
+        }
+    }
+    for (const auto& algorithm : options.algorithms) {
+        if (GetAlgorithms().count(algorithm) == 0) {
+            throw std::invalid_argument("Unknown algorithm: "s + algorithm);
+        }
+    }
+    if (kind) {
+        params.kind = *kind;
+        options.network = params;
+    }
+    return options;
+}
+/**
+ * Пары остановок запросов Route входного документа
+ */
+std::vector<StopPair> ReadRouteRequests(const std::string& input, const transport::Catalogue& catalogue) {
+    using namespace std::literals;
+    std::istringstream stream(input);
+    const auto document = json::Load(stream);
+    std::vector<StopPair> requests;
+    const auto& root = document.GetRoot().AsMap();
+    if (!root.count("stat_requests"s)) {
+        return requests;
+    }
+    for (const auto& request : root.at("stat_requests"s).AsArray()) {
+        const auto& request_map = request.AsMap();
+        if (request_map.at("type"s).AsString() != "Route"s) {
+            continue;
+        }
+        const auto from = catalogue.FindStop(request_map.at("from"s).AsString());
+        const auto to = catalogue.FindStop(request_map.at("to"s).AsString());
+        if (from != nullptr && to != nullptr) {
+            requests.emplace_back(from, to);
+        }
+    }
+    return requests;
+}
+
+LatencyStats ComputeLatencyStats(std::vector<double> latencies) {
+    LatencyStats stats;
+    if (latencies.empty()) {
+        return stats;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    // перцентиль по ближайшему рангу
+    const auto percentile = [&latencies](double fraction) {
+        const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(latencies.size())));
+        return latencies[std::max<size_t>(rank, 1) - 1];
+    };
+    double sum = 0.0;
+    for (const double latency : latencies) {
+        sum += latency;
+    }
+    stats.mean = sum / static_cast<double>(latencies.size());
+    stats.p50 = percentile(0.5);
+    stats.p90 = percentile(0.9);
+    stats.p99 = percentile(0.99);
+    stats.max = latencies.back();
+    return stats;
+}
+/**
+ * Собрать маршрутизатор заданным алгоритмом и ответить на запросы
+ */
+BenchmarkResult Run(const transport::Catalogue& catalogue, const std::vector<StopPair>& queries,
+                    transport::RoutingSettings routing_settings, const std::string& algorithm_name,
+                    const Options& options) {
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    routing_settings.algorithm = GetAlgorithms().at(algorithm_name);
+    BenchmarkResult result;
+    result.algorithm = algorithm_name;
+    std::vector<double> latencies;
+    latencies.reserve(queries.size());
+    transport::Router router(routing_settings);
+
+    benchmark::ResetPeakBytes();
+    const auto before = benchmark::GetAllocationStats();
+    const auto build_start = Clock::now();
+    router.Build(catalogue);
+    result.build_ms = Milliseconds(Clock::now() - build_start).count();
+    const auto after = benchmark::GetAllocationStats();
+    result.build_allocations = after.allocation_count - before.allocation_count;
+    result.build_peak_bytes = after.peak_bytes - before.live_bytes;
+    result.retained_bytes = after.live_bytes > before.live_bytes ? after.live_bytes - before.live_bytes : 0;
+    result.edge_count = router.GetEdgeCount();
+    result.pruned_edge_count = router.GetPrunedEdgeCount();
+    const auto& stops = catalogue.GetStops(transport::SORTED);
+    const size_t closed_stop_count = std::min(options.closed_stop_count, stops.size());
+    for (size_t i = 0; i < closed_stop_count; ++i) {
+        router.SetStopClosed(stops[i * stops.size() / closed_stop_count], true);
+    }
+
+    const auto queries_start = Clock::now();
+    for (const auto& [from, to] : queries) {
+        const auto query_start = Clock::now();
+        std::optional<double> total_time;
+        if (options.travel_times_only) {
+            total_time = router.GetTravelTime(from, to);
+        }
+        else if (const auto response = router.GetOptimalRoute(from, to)) {
+            total_time = response->total_time;
+        }
+        latencies.push_back(Microseconds(Clock::now() - query_start).count());
+        if (total_time) {
+            ++result.found;
+            result.total_time_sum += *total_time;
+        }
+    }
+    result.queries_ms = Milliseconds(Clock::now() - queries_start).count();
+    result.latency = ComputeLatencyStats(std::move(latencies));
+    result.search_stats = router.GetSearchStats();
+    return result;
+}
+
+double ToMegabytes(size_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void PrintTable(const std::vector<BenchmarkResult>& results, size_t stop_count, size_t query_count,
+                std::ostream& output) {
+    using namespace std::literals;
+    output << "stops: "s << stop_count << ", queries: "s << query_count
+           << ", min-plus kernel: "s << MinPlusKernelName(graph::GetMinPlusKernel()) << '\n';
+    output << std::left << std::setw(24) << "algorithm"s << std::right
+           << std::setw(12) << "build, ms"s << std::setw(12) << "allocs"s
+           << std::setw(12) << "peak, MB"s << std::setw(12) << "kept, MB"s
+           << std::setw(10) << "edges"s << std::setw(10) << "pruned"s
+           << std::setw(10) << "mean, us"s << std::setw(10) << "p50, us"s << std::setw(10) << "p90, us"s
+           << std::setw(10) << "p99, us"s << std::setw(10) << "max, us"s
+           << std::setw(8) << "found"s << std::setw(14) << "settled/query"s << std::setw(16) << "sum of times"s
+           << '\n';
+    output << std::fixed << std::setprecision(2);
+    for (const auto& result : results) {
+        const size_t settled = result.search_stats ? result.search_stats->settled_vertices : 0;
+        const size_t searches = result.search_stats ? result.search_stats->searches : 0;
+        output << std::left << std::setw(24) << result.algorithm << std::right
+               << std::setw(12) << result.build_ms << std::setw(12) << result.build_allocations
+               << std::setw(12) << ToMegabytes(result.build_peak_bytes)
+               << std::setw(12) << ToMegabytes(result.retained_bytes)
+               << std::setw(10) << result.edge_count << std::setw(10) << result.pruned_edge_count
+               << std::setw(10) << result.latency.mean << std::setw(10) << result.latency.p50
+               << std::setw(10) << result.latency.p90 << std::setw(10) << result.latency.p99
+               << std::setw(10) << result.latency.max
+               << std::setw(8) << result.found
+               << std::setw(14) << (searches > 0 ? static_cast<double>(settled) / searches : 0.0)
+               << std::setw(16) << result.total_time_sum << '\n';
+    }
+}
+
+json::Node ResultsToJson(const Options& options, const std::vector<BenchmarkResult>& results,
+                         size_t stop_count, size_t bus_count, size_t query_count) {
+    using namespace std::literals;
+    json::Dict network;
+    if (options.network) {
+        const auto& params = *options.network;
+        network = json::Builder{}
+                  .StartDict()
+                  .Key("kind"s).Value(std::string(benchmark::NetworkKindName(params.kind)))
+                  .Key("route_length"s).Value(static_cast<int>(params.route_length))
+                  .Key("distance_density"s).Value(params.distance_density)
+                  .Key("spacing"s).Value(params.stop_spacing)
+                  .Key("seed"s).Value(static_cast<int>(params.seed))
+                  .EndDict()
+                  .Build()
+                  .AsMap();
+    }
+    else {
+        network["input"s] = options.input_file.empty() ? "stdin"s : options.input_file;
+    }
+    network["stops"s] = static_cast<int>(stop_count);
+    network["buses"s] = static_cast<int>(bus_count);
+    network["graph_model"s] = options.graph_model == transport::TransitGraphModel::LINEAR ? "linear"s
+                                                                                           : "span_edges"s;
+    json::Array items;
+    for (const auto& result : results) {
+        auto item = json::Builder{}
+                    .StartDict()
+                    .Key("algorithm"s).Value(result.algorithm)
+                    .Key("build_ms"s).Value(result.build_ms)
+                    .Key("build_allocations"s).Value(static_cast<double>(result.build_allocations))
+                    .Key("build_peak_mb"s).Value(ToMegabytes(result.build_peak_bytes))
+                    .Key("retained_mb"s).Value(ToMegabytes(result.retained_bytes))
+                    .Key("edges"s).Value(static_cast<int>(result.edge_count))
+                    .Key("pruned_edges"s).Value(static_cast<int>(result.pruned_edge_count))
+                    .Key("queries_ms"s).Value(result.queries_ms)
+                    .Key("latency_us"s).StartDict()
+                        .Key("mean"s).Value(result.latency.mean)
+                        .Key("p50"s).Value(result.latency.p50)
+                        .Key("p90"s).Value(result.latency.p90)
+                        .Key("p99"s).Value(result.latency.p99)
+                        .Key("max"s).Value(result.latency.max)
+                    .EndDict()
+                    .Key("found"s).Value(static_cast<int>(result.found))
+                    .Key("total_time_sum"s).Value(result.total_time_sum)
+                    .EndDict()
+                    .Build()
+                    .AsMap();
+        if (result.search_stats) {
+            item["searches"s] = static_cast<double>(result.search_stats->searches);
+            item["settled_vertices"s] = static_cast<double>(result.search_stats->settled_vertices);
+        }
+        items.emplace_back(std::move(item));
+    }
+    return json::Builder{}
+    .StartDict()
+    .Key("network"s).Value(std::move(network))
+    .Key("queries"s).Value(static_cast<int>(query_count))
+    .Key("compact_routes_storage"s).Value(options.compact_routes_storage)
+    .Key("travel_times_only"s).Value(options.travel_times_only)
+    .Key("prune_parallel_edges"s).Value(options.prune_parallel_edges)
+    .Key("fixed_point_weights"s).Value(options.fixed_point_weights)
+    .Key("closed_stops"s).Value(static_cast<int>(options.closed_stop_count))
+    .Key("min_plus_kernel"s).Value(std::string(MinPlusKernelName(graph::GetMinPlusKernel())))
+    .Key("results"s).Value(std::move(items))
+    .EndDict()
+    .Build();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    using namespace std::literals;
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    transport::RoutingSettings routing_settings;
+    routing_settings.bus_wait_time = 6;
+    routing_settings.bus_velocity = 40.0;
+    // каталог входного JSON принадлежит обработчику запросов
+    JsonReader json_doc;
+    std::optional<renderer::MapRenderer> renderer;
+    std::optional<transport::Router> loader_router;
+    std::optional<RequestHandler> handler;
+    transport::Catalogue generated_catalogue;
+    const transport::Catalogue* catalogue = &generated_catalogue;
+    std::vector<StopPair> queries;
+    if (options.network) {
+        benchmark::GenerateNetwork(*options.network, generated_catalogue);
+        queries = benchmark::GenerateQueries(generated_catalogue, options.query_count, options.network->seed);
+    }
+    else {
+        std::ostringstream buffer;
+        if (!options.input_file.empty()) {
+            std::ifstream file(options.input_file);
+            if (!file) {
+                std::cerr << "Cannot open "s << options.input_file << std::endl;
+                return 1;
+            }
+            buffer << file.rdbuf();
+        }
+        else {
+            buffer << std::cin.rdbuf();
+        }
+        const std::string input = buffer.str();
+        std::istringstream stream(input);
+        json_doc.ReadInput(stream);
+        renderer.emplace(json_doc.GetRenderSettings());
+        routing_settings = json_doc.GetRoutingSettings();
+        // каталог загружается с маршрутизатором, который собирается быстрее всех
+        auto loader_settings = routing_settings;
+        loader_settings.algorithm = transport::RoutingAlgorithm::DIJKSTRA;
+        loader_settings.cache_file.clear();
+        loader_router.emplace(loader_settings);
+        handler.emplace(*renderer, *loader_router);
+        json_doc.UploadData(*handler);
+        catalogue = &handler->GetCatalogue();
+        queries = ReadRouteRequests(input, *catalogue);
+        if (queries.empty()) {
+            queries = benchmark::GenerateQueries(*catalogue, options.query_count, 1);
+        }
+    }
+    routing_settings.graph_model = options.graph_model;
+    routing_settings.compact_routes_storage = options.compact_routes_storage;
+    routing_settings.prune_parallel_edges = options.prune_parallel_edges;
+    routing_settings.fixed_point_weights = options.fixed_point_weights;
+    routing_settings.cache_file.clear();
+
+    std::vector<BenchmarkResult> results;
+    for (const auto& algorithm : options.algorithms) {
+        results.push_back(Run(*catalogue, queries, routing_settings, algorithm, options));
+    }
+    const size_t stop_count = catalogue->GetStops(transport::SORTED).size();
+    const size_t bus_count = catalogue->GetBuses(transport::SORTED).size();
+    if (options.json_output || !options.output_file.empty()) {
+        const json::Document document{ResultsToJson(options, results, stop_count, bus_count, queries.size())};
+        if (options.json_output) {
+            json::Print(document, std::cout);
+            std::cout << '\n';
+        }
+        if (!options.output_file.empty()) {
+            std::ofstream file(options.output_file);
+            json::Print(document, file);
+            file << '\n';
+        }
+    }
+    if (!options.json_output) {
+        PrintTable(results, stop_count, queries.size(), std::cout);
+    }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "routing_engine.h"
+#include "dijkstra_router.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace graph {
+/**
+ * Маршрутизация двунаправленным поиском Дейкстры на каждый запрос.
+ * Прямой поиск идёт из from по исходящим рёбрам, обратный — из to по входящим
+ * (DirectedWeightedGraph::GetIncomingEdges). На каждом шаге продвигается поиск
+ * с меньшим ключом в вершине очереди. Лучший найденный путь запоминается
+ * при релаксации ребра в вершину, достигнутую другим поиском; поиск останавливается,
+ * когда сумма минимальных ключей обеих очередей не меньше его веса, — любой
+ * более короткий путь прошёл бы через вершину, не извлечённую ни одним поиском.
+ * Обычно извлекается около половины вершин однонаправленного поиска.
+ * Построение O(E), граф должен быть заморожен.
+ */
+template <typename Weight>
+class BidirectionalDijkstraRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    /**
+     * До нескольких вершин выполняется один поиск Дейкстры из from
+     */
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override;
+
+    std::optional<SearchStats> GetSearchStats() const override;
+    /**
+     * Поиск выполняется по текущему графу, поэтому обновление не требуется
+     */
+    bool UpdateGraph(const EdgeIdsRemap& remap) override;
+
+private:
+    /**
+     * Элемент очереди с приоритетом: вес пути и вершина
+     */
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Heap = std::vector<QueueItem>;
+    /**
+     * Рабочая область одного запроса. Метки обратного поиска хранят вес пути
+     * от вершины до to и первое ребро этого пути.
+     */
+    struct Workspace {
+        SearchLabels<Weight> forward_labels;
+        SearchLabels<Weight> backward_labels;
+        Heap forward_heap;
+        Heap backward_heap;
+    };
+
+    static constexpr Weight ZERO_WEIGHT{};
+
+    const Graph& graph_;
+    WorkspacePool<Workspace> workspaces_;
+    SearchStatsCounter stats_;
+};
+
+template <typename Weight>
+BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    CheckNonNegativeWeights(graph);
+}
+
+template <typename Weight>
+std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo>
+BidirectionalDijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    auto workspace = workspaces_.Acquire();
+    auto& forward_labels = workspace->forward_labels;
+    auto& backward_labels = workspace->backward_labels;
+    auto& forward_heap = workspace->forward_heap;
+    auto& backward_heap = workspace->backward_heap;
+    forward_labels.Reset(graph_.GetVertexCount());
+    backward_labels.Reset(graph_.GetVertexCount());
+    forward_heap.clear();
+    backward_heap.clear();
+    const auto push = [](Heap& heap, Weight weight, VertexId vertex) {
+        heap.emplace_back(weight, vertex);
+        std::push_heap(heap.begin(), heap.end(), std::greater<QueueItem>{});
+    };
+
+    // лучший путь через вершину встречи
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    const auto update_best = [&](VertexId vertex) {
+        if (!forward_labels.IsReached(vertex) || !backward_labels.IsReached(vertex)) {
+            return;
+        }
+        const Weight weight = forward_labels.GetWeight(vertex) + backward_labels.GetWeight(vertex);
+        if (!best_weight || weight < *best_weight) {
+            best_weight = weight;
+            meeting_vertex = vertex;
+        }
+    };
+    forward_labels.Set(from, ZERO_WEIGHT, SearchLabels<Weight>::NO_EDGE);
+    push(forward_heap, ZERO_WEIGHT, from);
+    backward_labels.Set(to, ZERO_WEIGHT, SearchLabels<Weight>::NO_EDGE);
+    push(backward_heap, ZERO_WEIGHT, to);
+    update_best(from);
+
+    size_t settled_count = 0;
+    while (!forward_heap.empty() && !backward_heap.empty()) {
+        if (best_weight && forward_heap.front().first + backward_heap.front().first >= *best_weight) {
+            break;
+        }
+        const bool is_forward = forward_heap.front().first <= backward_heap.front().first;
+        auto& heap = is_forward ? forward_heap : backward_heap;
+        auto& labels = is_forward ? forward_labels : backward_labels;
+        std::pop_heap(heap.begin(), heap.end(), std::greater<QueueItem>{});
+        const auto [weight, vertex] = heap.back();
+        heap.pop_back();
+        // устаревшая запись: до вершины уже найден более короткий путь
+        if (labels.GetWeight(vertex) < weight) {
+            continue;
+        }
+        ++settled_count;
+        const auto relax = [&](EdgeId edge_id, VertexId next_vertex) {
+            const Weight candidate_weight = weight + graph_.GetEdgeWeight(edge_id);
+            if (!labels.IsReached(next_vertex) || candidate_weight < labels.GetWeight(next_vertex)) {
+                labels.Set(next_vertex, candidate_weight, edge_id);
+                push(heap, candidate_weight, next_vertex);
+                update_best(next_vertex);
+            }
+        };
+        if (is_forward) {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(edge_id, graph_.GetEdgeTarget(edge_id));
+            }
+        }
+        else {
+            for (const EdgeId edge_id : graph_.GetIncomingEdges(vertex)) {
+                relax(edge_id, graph_.GetEdgeSource(edge_id));
+            }
+        }
+    }
+    stats_.AddSearch(settled_count);
+    if (!best_weight) {
+        return std::nullopt;
+    }
+    // рёбра от from до вершины встречи, затем от неё до to
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = forward_labels.GetPrevEdge(meeting_vertex); edge_id != SearchLabels<Weight>::NO_EDGE;
+         edge_id = forward_labels.GetPrevEdge(graph_.GetEdgeSource(edge_id)))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (EdgeId edge_id = backward_labels.GetPrevEdge(meeting_vertex); edge_id != SearchLabels<Weight>::NO_EDGE;
+         edge_id = backward_labels.GetPrevEdge(graph_.GetEdgeTarget(edge_id)))
+    {
+        edges.push_back(edge_id);
+    }
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> BidirectionalDijkstraRouter<Weight>::BuildWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    if (targets.size() == 1) {
+        return RoutingEngine<Weight>::BuildWeights(from, targets);
+    }
+    if (targets.empty()) {
+        return {};
+    }
+    const ShortestPathTree<Weight> tree(graph_, from, targets);
+    stats_.AddSearch(tree.GetSettledCount());
+    return tree.GetWeights(targets);
+}
+
+template <typename Weight>
+std::optional<SearchStats> BidirectionalDijkstraRouter<Weight>::GetSearchStats() const {
+    return stats_.Get();
+}
+
+template <typename Weight>
+bool BidirectionalDijkstraRouter<Weight>::UpdateGraph(const EdgeIdsRemap& remap) {
+    (void)remap;
+    CheckNonNegativeWeights(graph_);
+    return true;
+}
+
+}  // namespace graph
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "dijkstra_router.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace graph {
+/**
+ * Маршрутизация с ленивым построением деревьев кратчайших путей.
+ * Дерево для вершины отправления строится при первом запросе из неё и хранится
+ * в LRU-кэше, ограниченном по памяти. Повторный запрос из той же вершины
+ * выполняется за O(длины маршрута).
+ */
+template <typename Weight>
+class CachedDijkstraRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+    using Tree = ShortestPathTree<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+    /**
+     * Статистика обращений к кэшу деревьев
+     */
+    struct CacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t trees = 0;
+        size_t memory_usage = 0;
+    };
+    /**
+     * Конструктор.
+     * memory_budget — предельный объём памяти под деревья в байтах;
+     * последнее построенное дерево хранится всегда, даже если превышает лимит.
+     */
+    CachedDijkstraRouter(const Graph& graph, size_t memory_budget);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    /**
+     * Веса читаются из дерева вершины from, построенного или взятого из кэша
+     */
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override;
+    /**
+     * Статистика обращений к кэшу
+     */
+    CacheStats GetCacheStats() const;
+
+private:
+    /**
+     * Найти дерево в кэше или построить его
+     */
+    std::shared_ptr<const Tree> GetTree(VertexId from) const;
+
+    using LruList = std::list<std::pair<VertexId, std::shared_ptr<const Tree>>>;
+
+    const Graph& graph_;
+    const size_t memory_budget_;
+    mutable std::mutex mutex_;
+    // начало списка — недавно использованные деревья
+    mutable LruList lru_;
+    mutable std::unordered_map<VertexId, typename LruList::iterator> trees_;
+    mutable CacheStats stats_;
+};
+
+template <typename Weight>
+CachedDijkstraRouter<Weight>::CachedDijkstraRouter(const Graph& graph, size_t memory_budget)
+    : graph_(graph)
+    , memory_budget_(memory_budget)
+{
+    CheckNonNegativeWeights(graph);
+}
+
+template <typename Weight>
+std::optional<typename CachedDijkstraRouter<Weight>::RouteInfo>
+CachedDijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    return GetTree(from)->BuildRoute(graph_, to);
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> CachedDijkstraRouter<Weight>::BuildWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    return GetTree(from)->GetWeights(targets);
+}
+
+template <typename Weight>
+typename CachedDijkstraRouter<Weight>::CacheStats CachedDijkstraRouter<Weight>::GetCacheStats() const {
+    std::lock_guard guard(mutex_);
+    return stats_;
+}
+
+template <typename Weight>
+std::shared_ptr<const typename CachedDijkstraRouter<Weight>::Tree>
+CachedDijkstraRouter<Weight>::GetTree(VertexId from) const {
+    {
+        std::lock_guard guard(mutex_);
+        if (const auto it = trees_.find(from); it != trees_.end()) {
+            ++stats_.hits;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->second;
+        }
+        ++stats_.misses;
+    }
+    // дерево строится без блокировки, чтобы не задерживать другие запросы
+    auto tree = std::make_shared<const Tree>(graph_, from);
+
+    std::lock_guard guard(mutex_);
+    if (const auto it = trees_.find(from); it != trees_.end()) {
+        // дерево успело построить другое обращение
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+    lru_.emplace_front(from, tree);
+    trees_[from] = lru_.begin();
+    ++stats_.trees;
+    stats_.memory_usage += tree->GetMemoryUsage();
+    while (stats_.memory_usage > memory_budget_ && lru_.size() > 1) {
+        const auto& [vertex, evicted] = lru_.back();
+        stats_.memory_usage -= evicted->GetMemoryUsage();
+        trees_.erase(vertex);
+        lru_.pop_back();
+        --stats_.trees;
+        ++stats_.evictions;
+    }
+    return tree;
+}
+
+}  // namespace graph
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "graph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace graph {
+/**
+ * Закрытые вершины и рёбра графа — битовые маски по их идентификаторам.
+ * Ребро непроходимо, если закрыто оно само или одна из его вершин.
+ * Закрытия только убирают пути из графа, поэтому кратчайший путь, не задевающий
+ * закрытий, остаётся кратчайшим, а при отсутствии пути его нет и после закрытий.
+ */
+class Closures {
+public:
+    void SetVertexClosed(VertexId vertex, bool is_closed) {
+        Assign(vertices_, vertex, is_closed);
+    }
+
+    void SetEdgeClosed(EdgeId edge_id, bool is_closed) {
+        Assign(edges_, edge_id, is_closed);
+    }
+
+    bool IsVertexClosed(VertexId vertex) const {
+        return Test(vertices_, vertex);
+    }
+
+    bool IsEdgeClosed(EdgeId edge_id) const {
+        return Test(edges_, edge_id);
+    }
+    /**
+     * Можно ли пройти по ребру: открыты оно само и обе его вершины.
+     * Граф должен быть заморожен.
+     */
+    template <typename Weight>
+    bool IsEdgeOpen(const DirectedWeightedGraph<Weight>& graph, EdgeId edge_id) const {
+        return !IsEdgeClosed(edge_id) && !IsVertexClosed(graph.GetEdgeSource(edge_id))
+                && !IsVertexClosed(graph.GetEdgeTarget(edge_id));
+    }
+    /**
+     * Проходим ли весь путь
+     */
+    template <typename Weight>
+    bool IsPathOpen(const DirectedWeightedGraph<Weight>& graph, const std::vector<EdgeId>& edges) const {
+        for (const EdgeId edge_id : edges) {
+            if (!IsEdgeOpen(graph, edge_id)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * Нет ни одной закрытой вершины и ни одного закрытого ребра
+     */
+    bool IsEmpty() const {
+        return closed_count_ == 0;
+    }
+
+    void Clear() {
+        vertices_.clear();
+        edges_.clear();
+        closed_count_ = 0;
+    }
+
+private:
+    static constexpr size_t WORD_BITS = 64;
+
+    static bool Test(const std::vector<uint64_t>& mask, size_t index) {
+        const size_t word = index / WORD_BITS;
+        return word < mask.size() && (mask[word] >> (index % WORD_BITS) & 1) != 0;
+    }
+
+    void Assign(std::vector<uint64_t>& mask, size_t index, bool value) {
+        if (Test(mask, index) == value) {
+            return;
+        }
+        const size_t word = index / WORD_BITS;
+        if (word >= mask.size()) {
+            mask.resize(word + 1, 0);
+        }
+        mask[word] ^= uint64_t{1} << (index % WORD_BITS);
+        closed_count_ = value ? closed_count_ + 1 : closed_count_ - 1;
+    }
+    /**
+     * Маски растут по мере закрытия, биты за их концом считаются открытыми
+     */
+    std::vector<uint64_t> vertices_;
+    std::vector<uint64_t> edges_;
+    size_t closed_count_ = 0;
+};
+
+}  // namespace graph
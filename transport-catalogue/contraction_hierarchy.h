@@ -0,0 +1,733 @@
+#pragma once
+
+#include "routing_engine.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+/**
+ * Маршрутизация по иерархии сжатия (Contraction Hierarchies).
+ * При построении вершины упорядочиваются по важности и последовательно сжимаются:
+ * для каждой пары соседей сжимаемой вершины, кратчайший путь между которыми проходит
+ * через неё, добавляется ребро-сокращение (shortcut). Запрос — двунаправленный поиск
+ * Дейкстры только по рёбрам, ведущим к более важным вершинам; сокращения в найденном
+ * пути раскрываются обратно в исходные рёбра графа.
+ *
+ * Независимые множества вершин сжимаются параллельно на пуле потоков,
+ * поэтому результат не зависит от количества потоков.
+ */
+template <typename Weight>
+class ContractionHierarchy final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+    /**
+     * Предельное количество вершин, извлекаемых поиском свидетеля при сжатии
+     */
+    static constexpr size_t DEFAULT_WITNESS_SETTLE_LIMIT = 500;
+
+    ContractionHierarchy(const Graph& graph, parallel::ThreadPool& thread_pool,
+                         size_t witness_settle_limit = DEFAULT_WITNESS_SETTLE_LIMIT);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    /**
+     * Таблица весов алгоритмом с корзинами (bucket-based many-to-many):
+     * обратные поиски из всех вершин targets записывают веса в корзины пройденных
+     * вершин, затем прямой поиск из каждой вершины sources просматривает корзины
+     * извлечённых вершин. Поиски каждой фазы выполняются параллельно.
+     */
+    std::vector<std::vector<std::optional<Weight>>> BuildWeightsTable(
+            const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+            parallel::ThreadPool& thread_pool) const override;
+    /**
+     * Количество добавленных рёбер-сокращений
+     */
+    size_t GetShortcutCount() const;
+
+    size_t GetVertexCount() const;
+    /**
+     * Номер вершины в порядке сжатия: чем больше, тем важнее вершина
+     */
+    size_t GetRank(VertexId vertex) const;
+    /**
+     * Обойти рёбра иерархии между вершиной и более важными вершинами:
+     * при is_forward — исходящие, иначе входящие. visit(neighbor, weight)
+     * вызывается для каждого ребра.
+     */
+    template <typename Visit>
+    void ForEachUpwardArc(VertexId vertex, bool is_forward, Visit visit) const {
+        const auto& offsets = is_forward ? upward_offsets_ : downward_offsets_;
+        const auto& search_arcs = is_forward ? upward_arcs_ : downward_arcs_;
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const Arc& arc = arcs_[search_arcs[i]];
+            visit(is_forward ? arc.to : arc.from, arc.weight);
+        }
+    }
+
+private:
+    static constexpr EdgeId NO_ARC = std::numeric_limits<EdgeId>::max();
+    /**
+     * Предельное количество извлекаемых вершин в поиске свидетелей при оценке приоритета;
+     * на графе пересадок меньший предел переоценивает число сокращений
+     */
+    static constexpr size_t SIMULATION_SETTLE_LIMIT = 200;
+    /**
+     * Ребро иерархии: исходное ребро графа (идентификаторы совпадают)
+     * или сокращение, составленное из двух рёбер иерархии
+     */
+    struct Arc {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first = NO_ARC;
+        EdgeId second = NO_ARC;
+    };
+    /**
+     * Сосед сжимаемой вершины и кратчайшее ребро до него
+     */
+    struct Neighbor {
+        VertexId vertex;
+        Weight weight;
+        EdgeId arc;
+    };
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Heap = std::vector<QueueItem>;
+    /**
+     * Рабочая область поиска
+     */
+    struct Workspace {
+        SearchLabels<Weight> forward;
+        SearchLabels<Weight> backward;
+        SearchLabels<Weight> targets;
+        Heap forward_heap;
+        Heap backward_heap;
+    };
+    /**
+     * Состояние графа во время сжатия
+     */
+    struct ContractionState {
+        std::vector<std::vector<EdgeId>> out_arcs;
+        std::vector<std::vector<EdgeId>> in_arcs;
+        std::vector<char> contracted;
+        std::vector<char> in_batch;
+        std::vector<int64_t> edge_differences;
+        std::vector<char> stale;
+        std::vector<int64_t> deleted_neighbors;
+        std::vector<int64_t> levels;
+    };
+
+    static void PushHeap(Heap& heap, Weight weight, VertexId vertex) {
+        heap.emplace_back(weight, vertex);
+        std::push_heap(heap.begin(), heap.end(), std::greater<QueueItem>{});
+    }
+
+    static QueueItem PopHeap(Heap& heap) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<QueueItem>{});
+        const QueueItem item = heap.back();
+        heap.pop_back();
+        return item;
+    }
+    /**
+     * Вершина уже сжата или сжимается в текущем раунде
+     */
+    static bool IsRemoved(const ContractionState& state, VertexId vertex) {
+        return state.contracted[vertex] || state.in_batch[vertex];
+    }
+    /**
+     * Несжатые соседи вершины с кратчайшим ребром до каждого из них
+     */
+    std::vector<Neighbor> GetNeighbors(const ContractionState& state, VertexId vertex,
+                                       bool outgoing) const {
+        std::vector<Neighbor> neighbors;
+        for (const EdgeId arc_id : outgoing ? state.out_arcs[vertex] : state.in_arcs[vertex]) {
+            const Arc& arc = arcs_[arc_id];
+            const VertexId neighbor = outgoing ? arc.to : arc.from;
+            if (neighbor == vertex || state.contracted[neighbor]) {
+                continue;
+            }
+            neighbors.push_back({neighbor, arc.weight, arc_id});
+        }
+        std::sort(neighbors.begin(), neighbors.end(), [](const Neighbor& lhs, const Neighbor& rhs) {
+            return std::tie(lhs.vertex, lhs.weight, lhs.arc) < std::tie(rhs.vertex, rhs.weight, rhs.arc);
+        });
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end(),
+                                    [](const Neighbor& lhs, const Neighbor& rhs) {
+                                        return lhs.vertex == rhs.vertex;
+                                    }),
+                        neighbors.end());
+        return neighbors;
+    }
+    /**
+     * Оставить в списке рёбер вершины только кратчайшие рёбра до несжатых соседей
+     */
+    void PruneArcs(ContractionState& state, VertexId vertex, bool outgoing) const {
+        auto& arcs = outgoing ? state.out_arcs[vertex] : state.in_arcs[vertex];
+        const auto neighbors = GetNeighbors(state, vertex, outgoing);
+        arcs.clear();
+        for (const Neighbor& neighbor : neighbors) {
+            arcs.push_back(neighbor.arc);
+        }
+    }
+    /**
+     * Поиск свидетелей: кратчайшие пути из source в обход вершины excluded
+     * и уже сжатых вершин, не длиннее max_weight.
+     * Цели отмечены в workspace.targets весом ребра от excluded; цель считается
+     * закрытой, когда путь до неё не длиннее пути через excluded. Поиск завершается,
+     * когда закрыты или извлечены все target_count целей, либо извлечено settle_limit вершин.
+     */
+    void FindWitnesses(const ContractionState& state, VertexId source, VertexId excluded,
+                       Weight source_weight, Weight max_weight, size_t target_count,
+                       size_t settle_limit, Workspace& workspace) const {
+        auto& labels = workspace.forward;
+        auto& heap = workspace.forward_heap;
+        const auto& targets = workspace.targets;
+        const auto is_witnessed = [&](VertexId vertex, Weight weight) {
+            return !(source_weight + targets.GetWeight(vertex) < weight);
+        };
+        labels.Reset(vertex_count_);
+        heap.clear();
+        labels.Set(source, ZERO_WEIGHT, NO_ARC);
+        PushHeap(heap, ZERO_WEIGHT, source);
+        if (targets.IsReached(source)) {
+            --target_count;
+        }
+        size_t settled = 0;
+        while (!heap.empty() && settled < settle_limit && target_count > 0) {
+            const auto [weight, vertex] = PopHeap(heap);
+            if (labels.GetWeight(vertex) < weight) {
+                continue;
+            }
+            if (max_weight < weight) {
+                break;
+            }
+            ++settled;
+            if (vertex != source && targets.IsReached(vertex) && !is_witnessed(vertex, weight)) {
+                // путь до цели окончательный и длиннее пути через excluded
+                --target_count;
+            }
+            for (const EdgeId arc_id : state.out_arcs[vertex]) {
+                const Arc& arc = arcs_[arc_id];
+                if (arc.to == excluded || IsRemoved(state, arc.to)) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + arc.weight;
+                if (max_weight < candidate_weight) {
+                    continue;
+                }
+                const bool is_reached = labels.IsReached(arc.to);
+                if (!is_reached || candidate_weight < labels.GetWeight(arc.to)) {
+                    if (targets.IsReached(arc.to) && is_witnessed(arc.to, candidate_weight)
+                        && (!is_reached || !is_witnessed(arc.to, labels.GetWeight(arc.to)))) {
+                        --target_count;
+                    }
+                    labels.Set(arc.to, candidate_weight, arc_id);
+                    PushHeap(heap, candidate_weight, arc.to);
+                }
+            }
+        }
+    }
+    /**
+     * Сокращения, необходимые при сжатии вершины
+     */
+    std::vector<Arc> FindShortcuts(const ContractionState& state, VertexId vertex, size_t settle_limit,
+                                   Workspace& workspace) const {
+        std::vector<Arc> shortcuts;
+        const auto in_neighbors = GetNeighbors(state, vertex, false);
+        const auto out_neighbors = GetNeighbors(state, vertex, true);
+        if (in_neighbors.empty() || out_neighbors.empty()) {
+            return shortcuts;
+        }
+        Weight max_out_weight = ZERO_WEIGHT;
+        workspace.targets.Reset(vertex_count_);
+        for (const Neighbor& out : out_neighbors) {
+            max_out_weight = std::max(max_out_weight, out.weight);
+            workspace.targets.Set(out.vertex, out.weight, out.arc);
+        }
+        for (const Neighbor& in : in_neighbors) {
+            FindWitnesses(state, in.vertex, vertex, in.weight, in.weight + max_out_weight,
+                          out_neighbors.size(), settle_limit, workspace);
+            const auto& labels = workspace.forward;
+            for (const Neighbor& out : out_neighbors) {
+                if (out.vertex == in.vertex) {
+                    continue;
+                }
+                const Weight via_weight = in.weight + out.weight;
+                if (labels.IsReached(out.vertex) && !(via_weight < labels.GetWeight(out.vertex))) {
+                    continue;
+                }
+                shortcuts.push_back({in.vertex, out.vertex, via_weight, in.arc, out.arc});
+            }
+        }
+        return shortcuts;
+    }
+    /**
+     * Разность рёбер при сжатии вершины: количество сокращений минус количество
+     * удаляемых рёбер. Сокращения оцениваются поиском свидетелей, ограниченным
+     * SIMULATION_SETTLE_LIMIT извлечёнными вершинами.
+     */
+    int64_t ComputeEdgeDifference(const ContractionState& state, VertexId vertex, Workspace& workspace) const {
+        const int64_t shortcuts = static_cast<int64_t>(FindShortcuts(state, vertex, SIMULATION_SETTLE_LIMIT,
+                                                                     workspace).size());
+        const int64_t removed = static_cast<int64_t>(GetNeighbors(state, vertex, false).size()
+                                                     + GetNeighbors(state, vertex, true).size());
+        return shortcuts - removed;
+    }
+    /**
+     * Приоритет сжатия: удвоенная разность рёбер, количество уже сжатых соседей и уровень
+     * вершины — длина самой длинной цепочки сжатых вершин, ведущей к ней.
+     * Два последних слагаемых обновляются сразу при сжатии соседа, разность рёбер —
+     * лениво, когда вершина становится кандидатом на сжатие.
+     */
+    static int64_t GetPriority(const ContractionState& state, VertexId vertex) {
+        return 2 * state.edge_differences[vertex] + state.deleted_neighbors[vertex] + state.levels[vertex];
+    }
+    /**
+     * Вершина важнее соседа: сравнение по приоритету, затем по номеру
+     */
+    static bool IsLess(const ContractionState& state, VertexId lhs, VertexId rhs) {
+        return std::pair{GetPriority(state, lhs), lhs} < std::pair{GetPriority(state, rhs), rhs};
+    }
+    /**
+     * Вершина сжимается в текущем раунде, если она менее важна, чем все её несжатые соседи
+     */
+    bool IsLocalMinimum(const ContractionState& state, VertexId vertex) const {
+        for (const EdgeId arc_id : state.out_arcs[vertex]) {
+            const VertexId neighbor = arcs_[arc_id].to;
+            if (neighbor != vertex && !state.contracted[neighbor] && !IsLess(state, vertex, neighbor)) {
+                return false;
+            }
+        }
+        for (const EdgeId arc_id : state.in_arcs[vertex]) {
+            const VertexId neighbor = arcs_[arc_id].from;
+            if (neighbor != vertex && !state.contracted[neighbor] && !IsLess(state, vertex, neighbor)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * Выполнить func(vertex, workspace) для вершин параллельно, по частям
+     */
+    template <typename Func>
+    void ForEachParallel(parallel::ThreadPool& thread_pool, const std::vector<VertexId>& vertices,
+                         Func func) const {
+        const size_t chunk_count = std::min(vertices.size(), thread_pool.GetThreadCount() * 8);
+        thread_pool.ParallelFor(0, chunk_count, [&](size_t chunk) {
+            auto workspace = workspaces_.Acquire();
+            const size_t begin = vertices.size() * chunk / chunk_count;
+            const size_t end = vertices.size() * (chunk + 1) / chunk_count;
+            for (size_t i = begin; i < end; ++i) {
+                func(i, vertices[i], *workspace);
+            }
+        });
+    }
+
+    /**
+     * Полный поиск в одном направлении по рёбрам к более важным вершинам.
+     * visit(vertex, weight) вызывается для каждой извлечённой вершины.
+     */
+    template <typename Visit>
+    void SearchUpward(VertexId from, bool is_forward, Workspace& workspace, Visit visit) const {
+        auto& labels = workspace.forward;
+        auto& heap = workspace.forward_heap;
+        labels.Reset(vertex_count_);
+        heap.clear();
+        labels.Set(from, ZERO_WEIGHT, NO_ARC);
+        PushHeap(heap, ZERO_WEIGHT, from);
+        const auto& offsets = is_forward ? upward_offsets_ : downward_offsets_;
+        const auto& search_arcs = is_forward ? upward_arcs_ : downward_arcs_;
+        while (!heap.empty()) {
+            const auto [weight, vertex] = PopHeap(heap);
+            if (labels.GetWeight(vertex) < weight) {
+                continue;
+            }
+            visit(vertex, weight);
+            for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+                const EdgeId arc_id = search_arcs[i];
+                const Arc& arc = arcs_[arc_id];
+                const VertexId next = is_forward ? arc.to : arc.from;
+                const Weight candidate_weight = weight + arc.weight;
+                if (!labels.IsReached(next) || candidate_weight < labels.GetWeight(next)) {
+                    labels.Set(next, candidate_weight, arc_id);
+                    PushHeap(heap, candidate_weight, next);
+                }
+            }
+        }
+    }
+
+    /**
+     * Остановка по требованию (stall-on-demand): вершина, до которой есть более короткий
+     * путь через более важную вершину, не лежит на кратчайшем пути вверх по иерархии,
+     * и её рёбра не просматриваются. Такие пути — рёбра иерархии, ведущие в вершину
+     * из более важных вершин, то есть рёбра противоположного направления поиска.
+     */
+    template <typename Labels>
+    bool IsStalled(VertexId vertex, Weight weight, bool is_forward, const Labels& labels) const {
+        const auto& offsets = is_forward ? downward_offsets_ : upward_offsets_;
+        const auto& search_arcs = is_forward ? downward_arcs_ : upward_arcs_;
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const Arc& arc = arcs_[search_arcs[i]];
+            const VertexId higher = is_forward ? arc.from : arc.to;
+            if (labels.IsReached(higher) && labels.GetWeight(higher) + arc.weight < weight) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Contract(parallel::ThreadPool& thread_pool);
+
+    void BuildSearchGraph();
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const size_t vertex_count_;
+    const size_t witness_settle_limit_;
+    size_t shortcut_count_ = 0;
+    std::vector<Arc> arcs_;
+    std::vector<size_t> ranks_;
+    // рёбра к более важным вершинам, сгруппированные по началу ребра
+    std::vector<size_t> upward_offsets_;
+    std::vector<EdgeId> upward_arcs_;
+    // рёбра из более важных вершин, сгруппированные по концу ребра
+    std::vector<size_t> downward_offsets_;
+    std::vector<EdgeId> downward_arcs_;
+    WorkspacePool<Workspace> workspaces_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, parallel::ThreadPool& thread_pool,
+                                                   size_t witness_settle_limit)
+    : vertex_count_(graph.GetVertexCount())
+    , witness_settle_limit_(witness_settle_limit)
+    , ranks_(graph.GetVertexCount(), 0)
+{
+    arcs_.reserve(graph.GetEdgeCount());
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        arcs_.push_back({edge.from, edge.to, edge.weight});
+    }
+    Contract(thread_pool);
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract(parallel::ThreadPool& thread_pool) {
+    ContractionState state;
+    state.out_arcs.resize(vertex_count_);
+    state.in_arcs.resize(vertex_count_);
+    state.contracted.assign(vertex_count_, 0);
+    state.in_batch.assign(vertex_count_, 0);
+    state.edge_differences.assign(vertex_count_, 0);
+    state.stale.assign(vertex_count_, 0);
+    state.deleted_neighbors.assign(vertex_count_, 0);
+    state.levels.assign(vertex_count_, 0);
+    for (EdgeId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        state.out_arcs[arcs_[arc_id].from].push_back(arc_id);
+        state.in_arcs[arcs_[arc_id].to].push_back(arc_id);
+    }
+
+    std::vector<VertexId> remaining(vertex_count_);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        remaining[vertex] = vertex;
+    }
+    ForEachParallel(thread_pool, remaining, [this, &state](size_t, VertexId vertex, Workspace& workspace) {
+        state.edge_differences[vertex] = ComputeEdgeDifference(state, vertex, workspace);
+    });
+
+    size_t next_rank = 0;
+    std::vector<char> dirty(vertex_count_, 0);
+    while (!remaining.empty()) {
+        std::vector<VertexId> candidates;
+        for (const VertexId vertex : remaining) {
+            if (IsLocalMinimum(state, vertex)) {
+                candidates.push_back(vertex);
+            }
+        }
+        // ленивое обновление: устаревшая разность рёбер пересчитывается только у кандидатов,
+        // и кандидат, переставший быть локальным минимумом, ждёт следующего раунда
+        std::vector<VertexId> stale_candidates;
+        for (const VertexId vertex : candidates) {
+            if (state.stale[vertex]) {
+                stale_candidates.push_back(vertex);
+            }
+        }
+        ForEachParallel(thread_pool, stale_candidates, [this, &state](size_t, VertexId vertex,
+                                                                      Workspace& workspace) {
+            state.edge_differences[vertex] = ComputeEdgeDifference(state, vertex, workspace);
+        });
+        for (const VertexId vertex : stale_candidates) {
+            state.stale[vertex] = 0;
+        }
+        std::vector<VertexId> batch;
+        for (const VertexId vertex : candidates) {
+            if (IsLocalMinimum(state, vertex)) {
+                batch.push_back(vertex);
+                state.in_batch[vertex] = 1;
+            }
+        }
+        std::vector<std::vector<Arc>> shortcuts(batch.size());
+        ForEachParallel(thread_pool, batch, [this, &state, &shortcuts](size_t index, VertexId vertex,
+                                                                        Workspace& workspace) {
+            shortcuts[index] = FindShortcuts(state, vertex, witness_settle_limit_, workspace);
+        });
+
+        std::vector<VertexId> updated;
+        for (size_t index = 0; index < batch.size(); ++index) {
+            const VertexId vertex = batch[index];
+            for (const auto& neighbors : {GetNeighbors(state, vertex, false), GetNeighbors(state, vertex, true)}) {
+                for (const Neighbor& neighbor : neighbors) {
+                    if (!dirty[neighbor.vertex]) {
+                        dirty[neighbor.vertex] = 1;
+                        updated.push_back(neighbor.vertex);
+                    }
+                    ++state.deleted_neighbors[neighbor.vertex];
+                    state.levels[neighbor.vertex] = std::max(state.levels[neighbor.vertex], state.levels[vertex] + 1);
+                    state.stale[neighbor.vertex] = 1;
+                }
+            }
+            state.contracted[vertex] = 1;
+            state.in_batch[vertex] = 0;
+            ranks_[vertex] = next_rank++;
+            for (const Arc& shortcut : shortcuts[index]) {
+                const EdgeId arc_id = arcs_.size();
+                arcs_.push_back(shortcut);
+                state.out_arcs[shortcut.from].push_back(arc_id);
+                state.in_arcs[shortcut.to].push_back(arc_id);
+                ++shortcut_count_;
+            }
+            // рёбра сжатой вершины больше не нужны для поиска свидетелей
+            state.out_arcs[vertex].clear();
+            state.out_arcs[vertex].shrink_to_fit();
+            state.in_arcs[vertex].clear();
+            state.in_arcs[vertex].shrink_to_fit();
+        }
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&state](VertexId vertex) {
+            return state.contracted[vertex] != 0;
+        }), remaining.end());
+
+        ForEachParallel(thread_pool, updated, [this, &state](size_t, VertexId vertex, Workspace&) {
+            PruneArcs(state, vertex, true);
+            PruneArcs(state, vertex, false);
+        });
+        for (const VertexId vertex : updated) {
+            dirty[vertex] = 0;
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraph() {
+    upward_offsets_.assign(vertex_count_ + 1, 0);
+    downward_offsets_.assign(vertex_count_ + 1, 0);
+    for (const Arc& arc : arcs_) {
+        if (ranks_[arc.from] < ranks_[arc.to]) {
+            ++upward_offsets_[arc.from + 1];
+        }
+        else if (ranks_[arc.from] > ranks_[arc.to]) {
+            ++downward_offsets_[arc.to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        upward_offsets_[vertex + 1] += upward_offsets_[vertex];
+        downward_offsets_[vertex + 1] += downward_offsets_[vertex];
+    }
+    upward_arcs_.resize(upward_offsets_.back());
+    downward_arcs_.resize(downward_offsets_.back());
+    std::vector<size_t> upward_positions(upward_offsets_.begin(), std::prev(upward_offsets_.end()));
+    std::vector<size_t> downward_positions(downward_offsets_.begin(), std::prev(downward_offsets_.end()));
+    for (EdgeId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        const Arc& arc = arcs_[arc_id];
+        if (ranks_[arc.from] < ranks_[arc.to]) {
+            upward_arcs_[upward_positions[arc.from]++] = arc_id;
+        }
+        else if (ranks_[arc.from] > ranks_[arc.to]) {
+            downward_arcs_[downward_positions[arc.to]++] = arc_id;
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    auto workspace = workspaces_.Acquire();
+    auto& forward = workspace->forward;
+    auto& backward = workspace->backward;
+    forward.Reset(vertex_count_);
+    backward.Reset(vertex_count_);
+    workspace->forward_heap.clear();
+    workspace->backward_heap.clear();
+    forward.Set(from, ZERO_WEIGHT, NO_ARC);
+    backward.Set(to, ZERO_WEIGHT, NO_ARC);
+    PushHeap(workspace->forward_heap, ZERO_WEIGHT, from);
+    PushHeap(workspace->backward_heap, ZERO_WEIGHT, to);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = 0;
+    // каждое направление продолжается, пока его минимальный ключ меньше лучшего найденного пути
+    const auto is_active = [&best_weight](const Heap& heap) {
+        return !heap.empty() && (!best_weight || heap.front().first < *best_weight);
+    };
+    while (true) {
+        const bool forward_active = is_active(workspace->forward_heap);
+        const bool backward_active = is_active(workspace->backward_heap);
+        if (!forward_active && !backward_active) {
+            break;
+        }
+        const bool is_forward = forward_active
+                && (!backward_active
+                    || !(workspace->backward_heap.front().first < workspace->forward_heap.front().first));
+        auto& heap = is_forward ? workspace->forward_heap : workspace->backward_heap;
+        auto& labels = is_forward ? forward : backward;
+        const auto& other_labels = is_forward ? backward : forward;
+
+        const auto [weight, vertex] = PopHeap(heap);
+        if (labels.GetWeight(vertex) < weight) {
+            continue;
+        }
+        if (other_labels.IsReached(vertex)) {
+            const Weight candidate_weight = weight + other_labels.GetWeight(vertex);
+            if (!best_weight || candidate_weight < *best_weight) {
+                best_weight = candidate_weight;
+                meeting_vertex = vertex;
+            }
+        }
+        if (IsStalled(vertex, weight, is_forward, labels)) {
+            continue;
+        }
+        const auto& offsets = is_forward ? upward_offsets_ : downward_offsets_;
+        const auto& search_arcs = is_forward ? upward_arcs_ : downward_arcs_;
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const EdgeId arc_id = search_arcs[i];
+            const Arc& arc = arcs_[arc_id];
+            const VertexId next = is_forward ? arc.to : arc.from;
+            const Weight candidate_weight = weight + arc.weight;
+            if (!labels.IsReached(next) || candidate_weight < labels.GetWeight(next)) {
+                labels.Set(next, candidate_weight, arc_id);
+                PushHeap(heap, candidate_weight, next);
+            }
+        }
+    }
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> path_arcs;
+    for (EdgeId arc_id = forward.GetPrevEdge(meeting_vertex); arc_id != NO_ARC;
+         arc_id = forward.GetPrevEdge(arcs_[arc_id].from)) {
+        path_arcs.push_back(arc_id);
+    }
+    std::reverse(path_arcs.begin(), path_arcs.end());
+    for (EdgeId arc_id = backward.GetPrevEdge(meeting_vertex); arc_id != NO_ARC;
+         arc_id = backward.GetPrevEdge(arcs_[arc_id].to)) {
+        path_arcs.push_back(arc_id);
+    }
+    // раскрываем сокращения в исходные рёбра, сохраняя порядок следования
+    std::vector<EdgeId> edges;
+    std::vector<EdgeId> unpack_stack(path_arcs.rbegin(), path_arcs.rend());
+    while (!unpack_stack.empty()) {
+        const EdgeId arc_id = unpack_stack.back();
+        unpack_stack.pop_back();
+        const Arc& arc = arcs_[arc_id];
+        if (arc.first == NO_ARC) {
+            edges.push_back(arc_id);
+        }
+        else {
+            unpack_stack.push_back(arc.second);
+            unpack_stack.push_back(arc.first);
+        }
+    }
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::vector<std::vector<std::optional<Weight>>> ContractionHierarchy<Weight>::BuildWeightsTable(
+        const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+        parallel::ThreadPool& thread_pool) const {
+    for (const auto vertices : {&sources, &targets}) {
+        for (const VertexId vertex : *vertices) {
+            if (vertex >= vertex_count_) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+        }
+    }
+    // элемент корзины: столбец таблицы и вес пути от вершины корзины до вершины столбца
+    using BucketEntry = std::pair<size_t, Weight>;
+    std::vector<std::vector<std::pair<VertexId, Weight>>> backward_spaces(targets.size());
+    ForEachParallel(thread_pool, targets, [this, &backward_spaces](size_t column, VertexId to,
+                                                                   Workspace& workspace) {
+        SearchUpward(to, false, workspace, [&space = backward_spaces[column]](VertexId vertex, Weight weight) {
+            space.emplace_back(vertex, weight);
+        });
+    });
+    // корзины вершин в сжатых строках, столбцы в каждой корзине по возрастанию
+    std::vector<size_t> bucket_offsets(vertex_count_ + 1, 0);
+    for (const auto& space : backward_spaces) {
+        for (const auto& [vertex, weight] : space) {
+            ++bucket_offsets[vertex + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        bucket_offsets[vertex + 1] += bucket_offsets[vertex];
+    }
+    std::vector<BucketEntry> buckets(bucket_offsets.back());
+    {
+        std::vector<size_t> positions(bucket_offsets.begin(), std::prev(bucket_offsets.end()));
+        for (size_t column = 0; column < targets.size(); ++column) {
+            for (const auto& [vertex, weight] : backward_spaces[column]) {
+                buckets[positions[vertex]++] = {column, weight};
+            }
+        }
+    }
+    backward_spaces.clear();
+    backward_spaces.shrink_to_fit();
+
+    std::vector<std::vector<std::optional<Weight>>> table(sources.size());
+    ForEachParallel(thread_pool, sources, [&](size_t row, VertexId from, Workspace& workspace) {
+        auto& weights = table[row];
+        weights.assign(targets.size(), std::nullopt);
+        SearchUpward(from, true, workspace, [&](VertexId vertex, Weight weight) {
+            for (size_t i = bucket_offsets[vertex]; i < bucket_offsets[vertex + 1]; ++i) {
+                const auto& [column, bucket_weight] = buckets[i];
+                const Weight candidate_weight = weight + bucket_weight;
+                if (!weights[column] || candidate_weight < *weights[column]) {
+                    weights[column] = candidate_weight;
+                }
+            }
+        });
+    });
+    return table;
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::GetShortcutCount() const {
+    return shortcut_count_;
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::GetVertexCount() const {
+    return vertex_count_;
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::GetRank(VertexId vertex) const {
+    return ranks_.at(vertex);
+}
+
+}  // namespace graph
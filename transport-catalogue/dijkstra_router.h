@@ -0,0 +1,464 @@
+#pragma once
+
+#include "closures.h"
+#include "routing_engine.h"
+#include "search_queue.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+/**
+ * Дерево кратчайших путей из одной вершины, построенное алгоритмом Дейкстры
+ * с двоичной кучей. Если заданы целевые вершины, поиск останавливается, как только
+ * все они извлечены из очереди, и дерево содержит только часть графа.
+ * Если заданы закрытия, поиск обходит закрытые вершины и рёбра.
+ */
+template <typename Weight>
+class ShortestPathTree {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RoutingEngine<Weight>::RouteInfo;
+
+    ShortestPathTree(const Graph& graph, VertexId from,
+                     std::optional<VertexId> to = std::nullopt, const Closures* closures = nullptr);
+    /**
+     * Дерево до вершин targets; при пустом списке — полное дерево
+     */
+    ShortestPathTree(const Graph& graph, VertexId from, const std::vector<VertexId>& targets,
+                     const Closures* closures = nullptr);
+    /**
+     * Маршрут от корня дерева до вершины to
+     */
+    std::optional<RouteInfo> BuildRoute(const Graph& graph, VertexId to) const;
+    /**
+     * Вес кратчайшего пути от корня до вершины, если вершина достигнута
+     */
+    std::optional<Weight> GetWeight(VertexId vertex) const;
+    /**
+     * Веса кратчайших путей от корня до каждой из вершин
+     */
+    std::vector<std::optional<Weight>> GetWeights(const std::vector<VertexId>& vertices) const;
+    /**
+     * Последнее ребро кратчайшего пути от корня до вершины (нет для корня и недостигнутых вершин)
+     */
+    std::optional<EdgeId> GetPrevEdge(VertexId vertex) const;
+    /**
+     * Объём памяти, занимаемый деревом, в байтах
+     */
+    size_t GetMemoryUsage() const;
+    /**
+     * Количество вершин, извлечённых из очереди при построении
+     */
+    size_t GetSettledCount() const;
+
+private:
+    /**
+     * Элемент очереди с приоритетом: расстояние до вершины и сама вершина
+     */
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+    /**
+     * Поиск Дейкстры; is_last_target(vertex) вызывается для каждой извлечённой
+     * вершины и возвращает true, когда поиск можно остановить
+     */
+    template <typename IsLastTarget>
+    void Search(const Graph& graph, VertexId from, IsLastTarget is_last_target, const Closures* closures);
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    std::vector<std::optional<Weight>> weights_;
+    std::vector<EdgeId> prev_edges_;
+    size_t settled_count_ = 0;
+};
+/**
+ * Маршрутизация поиском Дейкстры на каждый запрос.
+ * Построение O(E), память O(V + E), запрос O((V + E) log V).
+ * Метки и очередь поиска берутся из пула рабочих областей, поэтому запрос
+ * не выделяет память O(V), а одновременные запросы из разных потоков
+ * используют разные области.
+ * Для беззнаковых целых весов (фиксированная точка) очередь — поразрядная куча
+ * (см. search_queue.h); переполнение веса пути вызывает std::overflow_error.
+ */
+template <typename Weight>
+class DijkstraRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    /**
+     * Один поиск из from, останавливающийся после извлечения всех вершин targets
+     */
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override;
+
+    std::optional<SearchStats> GetSearchStats() const override;
+    /**
+     * Поиск выполняется по текущему графу, поэтому обновление не требуется
+     */
+    bool UpdateGraph(const EdgeIdsRemap& remap) override;
+
+private:
+    /**
+     * Рабочая область одного запроса
+     */
+    struct Workspace {
+        SearchLabels<Weight> labels;
+        SearchQueue<Weight, VertexId> queue;
+        /**
+         * Отметки целевых вершин BuildWeights; после запроса снова нулевые
+         */
+        std::vector<char> is_target;
+    };
+    /**
+     * Поиск Дейкстры из from; is_last_target(vertex) вызывается для каждой
+     * извлечённой вершины и возвращает true, когда поиск можно остановить
+     */
+    template <typename IsLastTarget>
+    void Search(Workspace& workspace, VertexId from, IsLastTarget is_last_target) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+
+    const Graph& graph_;
+    WorkspacePool<Workspace> workspaces_;
+    SearchStatsCounter stats_;
+};
+/**
+ * Проверить, что веса всех рёбер графа неотрицательны
+ */
+template <typename Weight>
+void CheckNonNegativeWeights(const DirectedWeightedGraph<Weight>& graph) {
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdgeWeight(edge_id) < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+/**
+ * Вершины, достижимые из from путями веса не больше max_weight, с весами кратчайших
+ * путей в порядке их возрастания. Вершины дальше max_weight не попадают в очередь,
+ * поэтому поиск Дейкстры не выходит за эту границу. При reverse поиск идёт
+ * по входящим рёбрам и находит вершины, из которых from достижима за max_weight.
+ * Закрытые вершины и рёбра (closures) поиск обходит.
+ */
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> FindReachableVertices(const DirectedWeightedGraph<Weight>& graph,
+                                                               VertexId from, Weight max_weight,
+                                                               bool reverse = false,
+                                                               const Closures* closures = nullptr) {
+    if (from >= graph.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    std::vector<std::optional<Weight>> weights(graph.GetVertexCount());
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    const auto relax = [&](VertexId vertex, Weight candidate_weight) {
+        auto& weight = weights[vertex];
+        if (!(max_weight < candidate_weight) && (!weight || candidate_weight < *weight)) {
+            weight = candidate_weight;
+            queue.push({candidate_weight, vertex});
+        }
+    };
+    if (closures != nullptr && closures->IsVertexClosed(from)) {
+        return reachable;
+    }
+    relax(from, Weight{});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (*weights[vertex] < weight) {
+            continue;
+        }
+        reachable.emplace_back(vertex, weight);
+        if (reverse) {
+            for (const EdgeId edge_id : graph.GetIncomingEdges(vertex)) {
+                if (closures == nullptr || closures->IsEdgeOpen(graph, edge_id)) {
+                    relax(graph.GetEdgeSource(edge_id), weight + graph.GetEdgeWeight(edge_id));
+                }
+            }
+        }
+        else {
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                if (closures == nullptr || closures->IsEdgeOpen(graph, edge_id)) {
+                    relax(graph.GetEdgeTarget(edge_id), weight + graph.GetEdgeWeight(edge_id));
+                }
+            }
+        }
+    }
+    return reachable;
+}
+
+template <typename Weight>
+ShortestPathTree<Weight>::ShortestPathTree(const Graph& graph, VertexId from,
+                                           std::optional<VertexId> to, const Closures* closures)
+    : weights_(graph.GetVertexCount())
+    , prev_edges_(graph.GetVertexCount(), NO_EDGE)
+{
+    if (from >= graph.GetVertexCount() || (to && *to >= graph.GetVertexCount())) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    Search(graph, from, [to](VertexId vertex) {
+        return vertex == to;
+    }, closures);
+}
+
+template <typename Weight>
+ShortestPathTree<Weight>::ShortestPathTree(const Graph& graph, VertexId from,
+                                           const std::vector<VertexId>& targets, const Closures* closures)
+    : weights_(graph.GetVertexCount())
+    , prev_edges_(graph.GetVertexCount(), NO_EDGE)
+{
+    if (from >= graph.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (targets.empty()) {
+        Search(graph, from, [](VertexId) {
+            return false;
+        }, closures);
+        return;
+    }
+    std::vector<char> is_target(graph.GetVertexCount(), 0);
+    size_t remaining_targets = 0;
+    for (const VertexId to : targets) {
+        if (!is_target.at(to)) {
+            is_target[to] = 1;
+            ++remaining_targets;
+        }
+    }
+    Search(graph, from, [&is_target, &remaining_targets](VertexId vertex) {
+        return is_target[vertex] && --remaining_targets == 0;
+    }, closures);
+}
+
+template <typename Weight>
+template <typename IsLastTarget>
+void ShortestPathTree<Weight>::Search(const Graph& graph, VertexId from, IsLastTarget is_last_target,
+                                      const Closures* closures) {
+    if (closures != nullptr && closures->IsVertexClosed(from)) {
+        return;
+    }
+    Queue queue;
+    weights_[from] = ZERO_WEIGHT;
+    queue.push({ZERO_WEIGHT, from});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        // устаревшая запись: вершина уже извлечена с меньшим весом
+        if (*weights_[vertex] < weight) {
+            continue;
+        }
+        ++settled_count_;
+        if (is_last_target(vertex)) {
+            break;
+        }
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            if (closures != nullptr && !closures->IsEdgeOpen(graph, edge_id)) {
+                continue;
+            }
+            const VertexId edge_to = graph.GetEdgeTarget(edge_id);
+            const Weight candidate_weight = weight + graph.GetEdgeWeight(edge_id);
+            auto& weight_to = weights_[edge_to];
+            if (!weight_to || candidate_weight < *weight_to) {
+                weight_to = candidate_weight;
+                prev_edges_[edge_to] = edge_id;
+                queue.push({candidate_weight, edge_to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ShortestPathTree<Weight>::RouteInfo>
+ShortestPathTree<Weight>::BuildRoute(const Graph& graph, VertexId to) const {
+    if (!weights_.at(to)) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edges_[to]; edge_id != NO_EDGE;
+         edge_id = prev_edges_[graph.GetEdgeSource(edge_id)])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{*weights_[to], std::move(edges)};
+}
+
+template <typename Weight>
+size_t ShortestPathTree<Weight>::GetMemoryUsage() const {
+    return sizeof(*this)
+            + weights_.capacity() * sizeof(std::optional<Weight>)
+            + prev_edges_.capacity() * sizeof(EdgeId);
+}
+
+template <typename Weight>
+std::optional<Weight> ShortestPathTree<Weight>::GetWeight(VertexId vertex) const {
+    return weights_.at(vertex);
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> ShortestPathTree<Weight>::GetWeights(const std::vector<VertexId>& vertices) const {
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(vertices.size());
+    for (const VertexId vertex : vertices) {
+        weights.push_back(weights_.at(vertex));
+    }
+    return weights;
+}
+
+template <typename Weight>
+std::optional<EdgeId> ShortestPathTree<Weight>::GetPrevEdge(VertexId vertex) const {
+    if (prev_edges_.at(vertex) == NO_EDGE) {
+        return std::nullopt;
+    }
+    return prev_edges_[vertex];
+}
+
+template <typename Weight>
+size_t ShortestPathTree<Weight>::GetSettledCount() const {
+    return settled_count_;
+}
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    CheckNonNegativeWeights(graph);
+}
+
+template <typename Weight>
+template <typename IsLastTarget>
+void DijkstraRouter<Weight>::Search(Workspace& workspace, VertexId from, IsLastTarget is_last_target) const {
+    auto& labels = workspace.labels;
+    auto& queue = workspace.queue;
+    labels.Reset(graph_.GetVertexCount());
+    queue.Clear();
+    labels.Set(from, ZERO_WEIGHT, SearchLabels<Weight>::NO_EDGE);
+    queue.Push(ZERO_WEIGHT, from);
+    size_t settled_count = 0;
+    while (!queue.IsEmpty()) {
+        const auto [weight, vertex] = queue.Pop();
+        // устаревшая запись: вершина уже извлечена с меньшим весом
+        if (labels.GetWeight(vertex) < weight) {
+            continue;
+        }
+        ++settled_count;
+        if (is_last_target(vertex)) {
+            break;
+        }
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const VertexId edge_to = graph_.GetEdgeTarget(edge_id);
+            const Weight candidate_weight = weight + graph_.GetEdgeWeight(edge_id);
+            if constexpr (std::is_unsigned_v<Weight>) {
+                if (candidate_weight < weight) {
+                    throw std::overflow_error("Path weight overflow");
+                }
+            }
+            if (!labels.IsReached(edge_to) || candidate_weight < labels.GetWeight(edge_to)) {
+                labels.Set(edge_to, candidate_weight, edge_id);
+                queue.Push(candidate_weight, edge_to);
+            }
+        }
+    }
+    stats_.AddSearch(settled_count);
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    auto workspace = workspaces_.Acquire();
+    Search(*workspace, from, [to](VertexId vertex) {
+        return vertex == to;
+    });
+    const auto& labels = workspace->labels;
+    if (!labels.IsReached(to)) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = labels.GetPrevEdge(to); edge_id != SearchLabels<Weight>::NO_EDGE;
+         edge_id = labels.GetPrevEdge(graph_.GetEdgeSource(edge_id)))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return RouteInfo{labels.GetWeight(to), std::move(edges)};
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> DijkstraRouter<Weight>::BuildWeights(VertexId from,
+                                                                        const std::vector<VertexId>& targets) const {
+    if (from >= graph_.GetVertexCount()
+        || std::any_of(targets.begin(), targets.end(), [this](VertexId to) {
+               return to >= graph_.GetVertexCount();
+           })) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (targets.empty()) {
+        return {};
+    }
+    auto workspace = workspaces_.Acquire();
+    auto& is_target = workspace->is_target;
+    is_target.resize(graph_.GetVertexCount(), 0);
+    size_t remaining_targets = 0;
+    for (const VertexId to : targets) {
+        if (!is_target[to]) {
+            is_target[to] = 1;
+            ++remaining_targets;
+        }
+    }
+    try {
+        Search(*workspace, from, [&is_target, &remaining_targets](VertexId vertex) {
+            return is_target[vertex] && --remaining_targets == 0;
+        });
+    }
+    catch (...) {
+        // рабочая область возвращается в пул: метки целей должны быть сняты
+        for (const VertexId to : targets) {
+            is_target[to] = 0;
+        }
+        throw;
+    }
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    const auto& labels = workspace->labels;
+    for (const VertexId to : targets) {
+        is_target[to] = 0;
+        weights.push_back(labels.IsReached(to) ? std::optional<Weight>(labels.GetWeight(to)) : std::nullopt);
+    }
+    return weights;
+}
+
+template <typename Weight>
+std::optional<SearchStats> DijkstraRouter<Weight>::GetSearchStats() const {
+    return stats_.Get();
+}
+
+template <typename Weight>
+bool DijkstraRouter<Weight>::UpdateGraph(const EdgeIdsRemap& remap) {
+    (void)remap;
+    CheckNonNegativeWeights(graph_);
+    return true;
+}
+
+}  // namespace graph
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <set>
@@ -21,6 +22,10 @@ struct Stop {
      * Координаты остановки
      */
     geo::Coordinates coordinates;
+    /**
+     * Идентификатор в каталоге — порядковый номер добавления остановки, задаётся каталогом
+     */
+    uint32_t id = 0;
 };
 /**
  * Хэш остановки
@@ -50,6 +55,15 @@ struct Bus {
      * Кольцевой ли маршрут
      */
     bool is_roundtrip;
+    /**
+     * Время отправления рейсов от первой остановки, в минутах от начала суток.
+     * Пустой список — расписания нет, автобус ходит с постоянным интервалом.
+     */
+    std::vector<double> departures;
+    /**
+     * Идентификатор в каталоге — порядковый номер добавления маршрута, задаётся каталогом
+     */
+    uint32_t id = 0;
 };
 /**
  * Статистика по маршруту
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "graph.h"
+#include "routing_engine.h"
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+/**
+ * Маршрутизация по копии графа с весами в фиксированной точке.
+ * Вес ребра переводится в целое число единиц (units_per_weight единиц на единицу веса
+ * исходного графа) с округлением до ближайшего; идентификаторы рёбер совпадают
+ * с исходным графом. Поиск выполняет алгоритм над целыми весами, созданный фабрикой,
+ * а веса результатов переводятся обратно в double только на выходе.
+ *
+ * Целый вес вдвое короче double, сравнения весов целочисленные, а поиск Дейкстры
+ * использует поразрядную кучу (см. search_queue.h). Погрешность округления —
+ * до половины единицы на ребро, поэтому из почти равных по весу маршрутов может
+ * быть выбран другой.
+ *
+ * Копия не следует за заменой рёбер исходного графа: UpdateGraph возвращает false.
+ */
+template <typename FixedWeight>
+class FixedPointRouter final : public RoutingEngine<double> {
+    static_assert(std::is_integral_v<FixedWeight> && std::is_unsigned_v<FixedWeight>,
+                  "Fixed point weights should be unsigned integers");
+public:
+    using FixedGraph = DirectedWeightedGraph<FixedWeight>;
+    using Engine = RoutingEngine<FixedWeight>;
+    using EngineFactory = std::function<std::unique_ptr<Engine>(const FixedGraph&)>;
+
+    FixedPointRouter(const DirectedWeightedGraph<double>& graph, double units_per_weight,
+                     const EngineFactory& create_engine)
+        : units_per_weight_(units_per_weight)
+        , graph_(ToFixedPoint(graph, units_per_weight))
+        , engine_(create_engine(graph_)) {
+    }
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override {
+        auto route = engine_->BuildRoute(from, to);
+        if (!route) {
+            return std::nullopt;
+        }
+        return RouteInfo{ToWeight(route->weight), std::move(route->edges)};
+    }
+
+    std::vector<std::optional<double>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override {
+        return ToWeights(engine_->BuildWeights(from, targets));
+    }
+
+    std::vector<std::vector<std::optional<double>>> BuildWeightsTable(
+            const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+            parallel::ThreadPool& thread_pool) const override {
+        const auto fixed_table = engine_->BuildWeightsTable(sources, targets, thread_pool);
+        std::vector<std::vector<std::optional<double>>> table;
+        table.reserve(fixed_table.size());
+        for (const auto& row : fixed_table) {
+            table.push_back(ToWeights(row));
+        }
+        return table;
+    }
+
+    std::optional<SearchStats> GetSearchStats() const override {
+        return engine_->GetSearchStats();
+    }
+    /**
+     * Граф с весами в фиксированной точке
+     */
+    const FixedGraph& GetGraph() const {
+        return graph_;
+    }
+
+private:
+    /**
+     * Копия графа с целыми весами. Бросает std::domain_error для отрицательного веса
+     * и std::overflow_error, если вес не помещается в FixedWeight.
+     */
+    static FixedGraph ToFixedPoint(const DirectedWeightedGraph<double>& graph, double units_per_weight) {
+        FixedGraph fixed_graph(graph.GetVertexCount());
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph.GetEdge(edge_id);
+            const double units = std::round(edge.weight * units_per_weight);
+            if (units < 0.0) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (!(units <= static_cast<double>(std::numeric_limits<FixedWeight>::max()))) {
+                throw std::overflow_error("Edge weight does not fit fixed point weight");
+            }
+            fixed_graph.AddEdge({edge.title_id, edge.quantity, edge.from, edge.to,
+                                 static_cast<FixedWeight>(units)});
+        }
+        // рёбра исходного графа уже упорядочены по началу, идентификаторы сохраняются
+        fixed_graph.Freeze();
+        return fixed_graph;
+    }
+
+    double ToWeight(FixedWeight weight) const {
+        return static_cast<double>(weight) / units_per_weight_;
+    }
+
+    std::vector<std::optional<double>> ToWeights(const std::vector<std::optional<FixedWeight>>& fixed_weights) const {
+        std::vector<std::optional<double>> weights;
+        weights.reserve(fixed_weights.size());
+        for (const auto& weight : fixed_weights) {
+            weights.push_back(weight ? std::optional<double>(ToWeight(*weight)) : std::nullopt);
+        }
+        return weights;
+    }
+
+    double units_per_weight_;
+    FixedGraph graph_;
+    std::unique_ptr<Engine> engine_;
+};
+
+}  // namespace graph
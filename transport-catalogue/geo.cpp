@@ -27,5 +27,28 @@ double ComputeDistance(Coordinates from, Coordinates to) {
                 + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
         * 6371000;
 }
+/**
+ * Преобразовать географические координаты в декартовы
+ */
+CartesianPoint ToCartesian(Coordinates coordinates) {
+    using namespace std;
+    const double dr = M_PI / 180.0;
+    const double cos_lat = cos(coordinates.lat * dr);
+    return {
+        EARTH_RADIUS * cos_lat * cos(coordinates.lng * dr),
+        EARTH_RADIUS * cos_lat * sin(coordinates.lng * dr),
+        EARTH_RADIUS * sin(coordinates.lat * dr)
+    };
+}
+/**
+ * Вычислить длину хорды между точками.
+ * Не превышает расстояния по поверхности, вычисляется без тригонометрии.
+ */
+double ComputeChordDistance(const CartesianPoint& from, const CartesianPoint& to) {
+    const double dx = from.x - to.x;
+    const double dy = from.y - to.y;
+    const double dz = from.z - to.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
 
 }  // namespace geo
@@ -43,5 +43,23 @@ private:
  * Вычислить расстояние между двумя точками с географическими координатами
  */
 double ComputeDistance(Coordinates from, Coordinates to);
+/**
+ * Точка на сфере радиуса Земли в декартовых координатах.
+ * Синусы и косинусы широты и долготы вычисляются один раз при преобразовании.
+ */
+struct CartesianPoint {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+};
+/**
+ * Преобразовать географические координаты в декартовы
+ */
+CartesianPoint ToCartesian(Coordinates coordinates);
+/**
+ * Вычислить длину хорды между точками.
+ * Не превышает расстояния по поверхности, вычисляется без тригонометрии.
+ */
+double ComputeChordDistance(const CartesianPoint& from, const CartesianPoint& to);
 
 }
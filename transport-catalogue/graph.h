@@ -3,6 +3,11 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace graph {
@@ -12,65 +17,502 @@ using EdgeId = size_t;
 
 template <typename Weight>
 struct Edge {
-    std::string title;
+    /**
+     * Идентификатор названия ребра в справочнике владельца графа
+     */
+    size_t title_id;
     size_t quantity;
     VertexId from;
     VertexId to;
     Weight weight;
 };
-
+/**
+ * Соответствие идентификаторов рёбер до и после DirectedWeightedGraph::ReplaceEdges
+ */
+struct EdgeIdsRemap {
+    static constexpr EdgeId REMOVED = std::numeric_limits<EdgeId>::max();
+    /**
+     * Новый идентификатор по прежнему идентификатору ребра; REMOVED — ребро удалено
+     */
+    std::vector<EdgeId> kept;
+    /**
+     * Идентификаторы добавленных рёбер в порядке их передачи
+     */
+    std::vector<EdgeId> added;
+};
+/**
+ * Ориентированный взвешенный граф.
+ * Рёбра добавляются методом AddEdge, после чего граф замораживается методом Freeze:
+ * рёбра упорядочиваются по вершине начала (с сохранением порядка добавления),
+ * и рёбра вершины v получают идентификаторы из [offsets_[v], offsets_[v + 1]).
+ * Идентификатор ребра назначается только при заморозке, поэтому AddEdge его не возвращает;
+ * у рёбер, добавленных в порядке вершин начала, он совпадает с порядковым номером добавления.
+ *
+ * Рёбра хранятся по столбцам: начала, концы и веса, нужные при обходе графа, —
+ * в отдельных плотных массивах, описания (название, количество) — в холодном массиве,
+ * к которому обращаются только при выводе маршрута. GetEdge собирает ребро из столбцов.
+ * Для обхода в обратном направлении строятся списки входящих рёбер вершин.
+ * Обход смежных рёбер доступен только для замороженного графа.
+ *
+ * Замороженный граф может читать столбцы из внешней памяти (FromColumns), например
+ * из отображённого в память файла, без копирования. Такой граф копирует столбцы
+ * в собственные массивы при первом изменении.
+ */
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<ranges::CountingIterator<EdgeId>>;
+    using IncomingEdgesRange = ranges::Range<const EdgeId*>;
 
 public:
+    /**
+     * Холодная часть описания ребра
+     */
+    struct EdgeLabel {
+        size_t title_id;
+        size_t quantity;
+    };
+    /**
+     * Столбцы замороженного графа: offsets и incoming_offsets — по vertex_count + 1
+     * элементов, остальные — по edge_count
+     */
+    struct Columns {
+        const EdgeId* offsets = nullptr;
+        const VertexId* sources = nullptr;
+        const VertexId* targets = nullptr;
+        const Weight* weights = nullptr;
+        const EdgeLabel* labels = nullptr;
+        const EdgeId* incoming_offsets = nullptr;
+        const EdgeId* incoming_edges = nullptr;
+    };
+
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
-    EdgeId AddEdge(const Edge<Weight>& edge);
+    DirectedWeightedGraph(const DirectedWeightedGraph& other);
+    DirectedWeightedGraph(DirectedWeightedGraph&& other) noexcept;
+    DirectedWeightedGraph& operator=(const DirectedWeightedGraph& other);
+    DirectedWeightedGraph& operator=(DirectedWeightedGraph&& other) noexcept;
+    /**
+     * Замороженный граф над столбцами во внешней памяти. Данные не копируются
+     * и должны жить дольше графа и его копий. Возвращает nullopt, если столбцы
+     * несогласованы: смещения не возрастают, рёбра не упорядочены по началу,
+     * вершины или идентификаторы рёбер вне диапазона. Проверка линейна
+     * по размеру графа и не выделяет памяти.
+     */
+    static std::optional<DirectedWeightedGraph> FromColumns(size_t vertex_count, size_t edge_count,
+                                                            const Columns& columns);
+    /**
+     * Столбцы замороженного графа, например для записи в файл
+     */
+    const Columns& GetColumns() const;
+    /**
+     * Добавить ребро. Размораживает граф; идентификатор ребра станет известен после Freeze.
+     */
+    void AddEdge(const Edge<Weight>& edge);
+    /**
+     * Заморозить граф: упорядочить рёбра по вершине начала и построить сжатые строки смежности
+     */
+    void Freeze();
+    bool IsFrozen() const;
+    /**
+     * Удалить рёбра, для которых remove(edge) истинно, добавить new_edges и заморозить граф.
+     * Граф должен быть заморожен. Возвращает соответствие прежних и новых идентификаторов.
+     */
+    template <typename Predicate>
+    EdgeIdsRemap ReplaceEdges(Predicate remove, std::vector<Edge<Weight>> new_edges);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
-    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    /**
+     * Полное описание ребра, собранное из горячих и холодных массивов
+     */
+    Edge<Weight> GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    /**
+     * Рёбра, входящие в вершину
+     */
+    IncomingEdgesRange GetIncomingEdges(VertexId vertex) const;
+    /**
+     * Конец ребра, без проверки границ
+     */
+    VertexId GetEdgeTarget(EdgeId edge_id) const;
+    /**
+     * Начало ребра, без проверки границ
+     */
+    VertexId GetEdgeSource(EdgeId edge_id) const;
+    /**
+     * Вес ребра, без проверки границ
+     */
+    Weight GetEdgeWeight(EdgeId edge_id) const;
 
 private:
-    std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_;
+    /**
+     * Проверить концы и дописать ребро в столбцы
+     */
+    void PushEdge(const Edge<Weight>& edge);
+    /**
+     * Скопировать внешние столбцы в собственные массивы перед изменением графа
+     */
+    void CopyExternalColumns();
+    /**
+     * Направить столбцы на собственные массивы
+     */
+    void BindColumns();
+    /**
+     * Устойчиво упорядочить рёбра по вершине начала и построить сжатые строки.
+     * Возвращает новый идентификатор для каждого ребра по его прежней позиции.
+     */
+    std::vector<EdgeId> SortEdgesBySource();
+
+    size_t vertex_count_ = 0;
+    size_t edge_count_ = 0;
+    bool frozen_ = true;
+    /**
+     * Столбцы во внешней памяти, а не в собственных массивах
+     */
+    bool is_external_ = false;
+    /**
+     * Столбцы, по которым читается граф: собственные массивы или внешняя память
+     */
+    Columns columns_;
+    /**
+     * Рёбра вершины v — идентификаторы из [offsets_[v], offsets_[v + 1])
+     */
+    std::vector<EdgeId> offsets_;
+    std::vector<VertexId> sources_;
+    std::vector<VertexId> targets_;
+    std::vector<Weight> weights_;
+    std::vector<EdgeLabel> labels_;
+    /**
+     * Рёбра, входящие в вершину v — incoming_edges_[incoming_offsets_[v] .. incoming_offsets_[v + 1])
+     */
+    std::vector<EdgeId> incoming_offsets_;
+    std::vector<EdgeId> incoming_edges_;
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : vertex_count_(vertex_count)
+    , offsets_(vertex_count + 1, 0)
+    , incoming_offsets_(vertex_count + 1, 0) {
+    BindColumns();
 }
 
 template <typename Weight>
-EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
-    edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
-    return id;
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(const DirectedWeightedGraph& other)
+    : vertex_count_(other.vertex_count_)
+    , edge_count_(other.edge_count_)
+    , frozen_(other.frozen_)
+    , is_external_(other.is_external_)
+    , columns_(other.columns_)
+    , offsets_(other.offsets_)
+    , sources_(other.sources_)
+    , targets_(other.targets_)
+    , weights_(other.weights_)
+    , labels_(other.labels_)
+    , incoming_offsets_(other.incoming_offsets_)
+    , incoming_edges_(other.incoming_edges_) {
+    if (!is_external_) {
+        BindColumns();
+    }
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(DirectedWeightedGraph&& other) noexcept
+    : vertex_count_(other.vertex_count_)
+    , edge_count_(other.edge_count_)
+    , frozen_(other.frozen_)
+    , is_external_(other.is_external_)
+    , columns_(other.columns_)
+    , offsets_(std::move(other.offsets_))
+    , sources_(std::move(other.sources_))
+    , targets_(std::move(other.targets_))
+    , weights_(std::move(other.weights_))
+    , labels_(std::move(other.labels_))
+    , incoming_offsets_(std::move(other.incoming_offsets_))
+    , incoming_edges_(std::move(other.incoming_edges_)) {
+    if (!is_external_) {
+        BindColumns();
+    }
+    other.vertex_count_ = 0;
+    other.is_external_ = false;
+    other.BindColumns();
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>& DirectedWeightedGraph<Weight>::operator=(const DirectedWeightedGraph& other) {
+    if (this != &other) {
+        *this = DirectedWeightedGraph(other);
+    }
+    return *this;
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>& DirectedWeightedGraph<Weight>::operator=(DirectedWeightedGraph&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    vertex_count_ = std::exchange(other.vertex_count_, 0);
+    edge_count_ = std::exchange(other.edge_count_, 0);
+    frozen_ = std::exchange(other.frozen_, true);
+    is_external_ = std::exchange(other.is_external_, false);
+    columns_ = std::exchange(other.columns_, Columns{});
+    offsets_ = std::move(other.offsets_);
+    sources_ = std::move(other.sources_);
+    targets_ = std::move(other.targets_);
+    weights_ = std::move(other.weights_);
+    labels_ = std::move(other.labels_);
+    incoming_offsets_ = std::move(other.incoming_offsets_);
+    incoming_edges_ = std::move(other.incoming_edges_);
+    if (!is_external_) {
+        BindColumns();
+    }
+    other.BindColumns();
+    return *this;
+}
+
+template <typename Weight>
+std::optional<DirectedWeightedGraph<Weight>> DirectedWeightedGraph<Weight>::FromColumns(
+        size_t vertex_count, size_t edge_count, const Columns& columns) {
+    const auto is_valid_offsets = [vertex_count, edge_count](const EdgeId* offsets) {
+        if (offsets[0] != 0 || offsets[vertex_count] != edge_count) {
+            return false;
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            if (offsets[vertex] > offsets[vertex + 1]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!is_valid_offsets(columns.offsets) || !is_valid_offsets(columns.incoming_offsets)) {
+        return std::nullopt;
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (EdgeId edge_id = columns.offsets[vertex]; edge_id < columns.offsets[vertex + 1]; ++edge_id) {
+            if (columns.sources[edge_id] != vertex || columns.targets[edge_id] >= vertex_count) {
+                return std::nullopt;
+            }
+        }
+        for (EdgeId i = columns.incoming_offsets[vertex]; i < columns.incoming_offsets[vertex + 1]; ++i) {
+            const EdgeId edge_id = columns.incoming_edges[i];
+            if (edge_id >= edge_count || columns.targets[edge_id] != vertex) {
+                return std::nullopt;
+            }
+        }
+    }
+    DirectedWeightedGraph graph;
+    graph.vertex_count_ = vertex_count;
+    graph.edge_count_ = edge_count;
+    graph.is_external_ = true;
+    graph.columns_ = columns;
+    return graph;
+}
+
+template <typename Weight>
+const typename DirectedWeightedGraph<Weight>::Columns& DirectedWeightedGraph<Weight>::GetColumns() const {
+    if (!frozen_) {
+        throw std::logic_error("Graph should be frozen before reading columns");
+    }
+    return columns_;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::CopyExternalColumns() {
+    if (!is_external_) {
+        return;
+    }
+    offsets_.assign(columns_.offsets, columns_.offsets + vertex_count_ + 1);
+    sources_.assign(columns_.sources, columns_.sources + edge_count_);
+    targets_.assign(columns_.targets, columns_.targets + edge_count_);
+    weights_.assign(columns_.weights, columns_.weights + edge_count_);
+    labels_.assign(columns_.labels, columns_.labels + edge_count_);
+    incoming_offsets_.assign(columns_.incoming_offsets, columns_.incoming_offsets + vertex_count_ + 1);
+    incoming_edges_.assign(columns_.incoming_edges, columns_.incoming_edges + edge_count_);
+    is_external_ = false;
+    BindColumns();
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::BindColumns() {
+    edge_count_ = targets_.size();
+    columns_ = {offsets_.data(), sources_.data(), targets_.data(), weights_.data(), labels_.data(),
+                incoming_offsets_.data(), incoming_edges_.data()};
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    CopyExternalColumns();
+    PushEdge(edge);
+    frozen_ = false;
+    BindColumns();
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::PushEdge(const Edge<Weight>& edge) {
+    if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    sources_.push_back(edge.from);
+    targets_.push_back(edge.to);
+    weights_.push_back(edge.weight);
+    labels_.push_back({edge.title_id, edge.quantity});
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (!frozen_) {
+        SortEdgesBySource();
+    }
+}
+
+template <typename Weight>
+template <typename Predicate>
+EdgeIdsRemap DirectedWeightedGraph<Weight>::ReplaceEdges(Predicate remove, std::vector<Edge<Weight>> new_edges) {
+    if (!frozen_) {
+        throw std::logic_error("Graph should be frozen before replacing edges");
+    }
+    CopyExternalColumns();
+    EdgeIdsRemap remap;
+    const size_t edge_count = GetEdgeCount();
+    remap.kept.assign(edge_count, EdgeIdsRemap::REMOVED);
+    size_t kept_count = 0;
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (!remove(std::as_const(*this).GetEdge(edge_id))) {
+            remap.kept[edge_id] = kept_count;
+            sources_[kept_count] = sources_[edge_id];
+            targets_[kept_count] = targets_[edge_id];
+            weights_[kept_count] = weights_[edge_id];
+            labels_[kept_count] = labels_[edge_id];
+            ++kept_count;
+        }
+    }
+    sources_.resize(kept_count);
+    targets_.resize(kept_count);
+    weights_.resize(kept_count);
+    labels_.resize(kept_count);
+    for (const auto& edge : new_edges) {
+        PushEdge(edge);
+    }
+
+    const std::vector<EdgeId> sorted_ids = SortEdgesBySource();
+    for (auto& edge_id : remap.kept) {
+        if (edge_id != EdgeIdsRemap::REMOVED) {
+            edge_id = sorted_ids[edge_id];
+        }
+    }
+    remap.added.assign(sorted_ids.begin() + kept_count, sorted_ids.end());
+    return remap;
+}
+
+template <typename Weight>
+std::vector<EdgeId> DirectedWeightedGraph<Weight>::SortEdgesBySource() {
+    const size_t edge_count = targets_.size();
+    // устойчивая сортировка подсчётом по вершине начала ребра
+    offsets_.assign(vertex_count_ + 1, 0);
+    for (const VertexId source : sources_) {
+        ++offsets_[source + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        offsets_[vertex + 1] += offsets_[vertex];
+    }
+    std::vector<EdgeId> positions(offsets_.begin(), offsets_.end() - 1);
+    std::vector<EdgeId> sorted_ids(edge_count);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        sorted_ids[edge_id] = positions[sources_[edge_id]]++;
+    }
+    const auto permute = [&sorted_ids](auto& column) {
+        std::remove_reference_t<decltype(column)> sorted(column.size());
+        for (EdgeId edge_id = 0; edge_id < column.size(); ++edge_id) {
+            sorted[sorted_ids[edge_id]] = std::move(column[edge_id]);
+        }
+        column = std::move(sorted);
+    };
+    permute(sources_);
+    permute(targets_);
+    permute(weights_);
+    permute(labels_);
+
+    incoming_offsets_.assign(vertex_count_ + 1, 0);
+    for (const VertexId target : targets_) {
+        ++incoming_offsets_[target + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        incoming_offsets_[vertex + 1] += incoming_offsets_[vertex];
+    }
+    incoming_edges_.resize(edge_count);
+    positions.assign(incoming_offsets_.begin(), incoming_offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        incoming_edges_[positions[targets_[edge_id]]++] = edge_id;
+    }
+    frozen_ = true;
+    BindColumns();
+    return sorted_ids;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return frozen_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-    return edges_.size();
+    return edge_count_;
 }
 
 template <typename Weight>
-const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    if (edge_id >= edge_count_) {
+        throw std::out_of_range("Edge id is out of range");
+    }
+    const EdgeLabel& label = columns_.labels[edge_id];
+    return {label.title_id, label.quantity, columns_.sources[edge_id], columns_.targets[edge_id],
+            columns_.weights[edge_id]};
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    if (!frozen_) {
+        throw std::logic_error("Graph should be frozen before traversal");
+    }
+    if (vertex >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    return {ranges::CountingIterator<EdgeId>(columns_.offsets[vertex]),
+            ranges::CountingIterator<EdgeId>(columns_.offsets[vertex + 1])};
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncomingEdgesRange
+DirectedWeightedGraph<Weight>::GetIncomingEdges(VertexId vertex) const {
+    if (!frozen_) {
+        throw std::logic_error("Graph should be frozen before traversal");
+    }
+    if (vertex >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    return {columns_.incoming_edges + columns_.incoming_offsets[vertex],
+            columns_.incoming_edges + columns_.incoming_offsets[vertex + 1]};
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetEdgeTarget(EdgeId edge_id) const {
+    return columns_.targets[edge_id];
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetEdgeSource(EdgeId edge_id) const {
+    return columns_.sources[edge_id];
+}
+
+template <typename Weight>
+Weight DirectedWeightedGraph<Weight>::GetEdgeWeight(EdgeId edge_id) const {
+    return columns_.weights[edge_id];
 }
 }  // namespace graph
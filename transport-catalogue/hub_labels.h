@@ -0,0 +1,401 @@
+#pragma once
+
+#include "routing_engine.h"
+#include "bidirectional_dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+/**
+ * Индекс меток-хабов (hub labeling) для запросов веса кратчайшего пути.
+ * Каждой вершине v сопоставлены прямая метка — хабы h с весом пути v → h —
+ * и обратная метка — хабы h с весом пути h → v. Вес кратчайшего пути from → to —
+ * минимум суммы весов по общим хабам прямой метки from и обратной метки to,
+ * поэтому запрос — линейное слияние двух коротких массивов без поиска по графу.
+ *
+ * Метки строятся по иерархии сжатия: хабами вершины становятся вершины пространства
+ * поиска вверх по иерархии; записи, вес которых покрывается более коротким путём
+ * через уже построенные метки, отбрасываются. Метки вершин строятся от самых важных
+ * к менее важным уровнями: вершины уровня зависят только от меток вершин выше,
+ * поэтому вершины одного уровня обрабатываются параллельно.
+ *
+ * Хабы обозначаются номером вершины в порядке сжатия (32 бита), метки хранятся
+ * в сжатых строках: общие массивы номеров хабов по возрастанию и весов, смещения
+ * метки каждой вершины.
+ */
+template <typename Weight>
+class HubLabels {
+public:
+    HubLabels(const ContractionHierarchy<Weight>& hierarchy, parallel::ThreadPool& thread_pool);
+    /**
+     * Вес кратчайшего пути между вершинами (nullopt — пути нет)
+     */
+    std::optional<Weight> GetWeight(VertexId from, VertexId to) const;
+
+    size_t GetVertexCount() const;
+    /**
+     * Суммарное количество записей прямых и обратных меток
+     */
+    size_t GetEntryCount() const;
+
+    size_t GetMemoryUsage() const;
+    /**
+     * Записать индекс в поток. key — ключ исходных данных, проверяемый при загрузке.
+     * Числа записываются в порядке байт машины.
+     */
+    void Save(std::ostream& output, uint64_t key) const;
+    /**
+     * Загрузить индекс из потока.
+     * Возвращает nullopt, если данные повреждены, записаны для другого типа веса или с другим ключом.
+     */
+    static std::optional<HubLabels> Load(std::istream& input, uint64_t key);
+
+private:
+    HubLabels() = default;
+    /**
+     * Запись метки на время построения: номер хаба и вес пути
+     */
+    using LabelEntry = std::pair<uint32_t, Weight>;
+    /**
+     * Метки всех вершин в одном направлении, в сжатых строках:
+     * метка вершины v — позиции [offsets[v], offsets[v + 1])
+     */
+    struct Labels {
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> hubs;
+        std::vector<Weight> weights;
+    };
+    /**
+     * Заголовок сохранённого индекса; за ним следуют массивы прямых,
+     * затем обратных меток: смещения, хабы, веса
+     */
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t weight_size;
+        uint64_t key;
+        uint64_t vertex_count;
+        uint64_t forward_entry_count;
+        uint64_t backward_entry_count;
+    };
+
+    static constexpr char FILE_MAGIC[8] = {'T', 'C', 'H', 'U', 'B', 'L', 'B', 'L'};
+    static constexpr uint32_t FILE_VERSION = 1;
+    static constexpr Weight ZERO_WEIGHT{};
+
+    /**
+     * Минимум суммы весов по общим хабам двух упорядоченных по хабам последовательностей
+     */
+    template <typename LhsHub, typename LhsWeight, typename RhsHub, typename RhsWeight>
+    static std::optional<Weight> MergeLabels(size_t lhs_size, LhsHub lhs_hub, LhsWeight lhs_weight,
+                                             size_t rhs_size, RhsHub rhs_hub, RhsWeight rhs_weight) {
+        std::optional<Weight> best_weight;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < lhs_size && j < rhs_size) {
+            const uint32_t lhs = lhs_hub(i);
+            const uint32_t rhs = rhs_hub(j);
+            if (lhs < rhs) {
+                ++i;
+            }
+            else if (rhs < lhs) {
+                ++j;
+            }
+            else {
+                const Weight weight = lhs_weight(i) + rhs_weight(j);
+                if (!best_weight || weight < *best_weight) {
+                    best_weight = weight;
+                }
+                ++i;
+                ++j;
+            }
+        }
+        return best_weight;
+    }
+    /**
+     * Построить метку вершины в одном направлении по уже построенным меткам
+     * более важных соседей и отбросить записи, покрытые более коротким путём
+     */
+    static std::vector<LabelEntry> BuildLabel(const ContractionHierarchy<Weight>& hierarchy, VertexId vertex,
+                                              bool is_forward, const std::vector<VertexId>& rank_vertices,
+                                              const std::vector<std::vector<LabelEntry>>& labels,
+                                              const std::vector<std::vector<LabelEntry>>& opposite_labels);
+    /**
+     * Сжать метки в общие массивы
+     */
+    static Labels Flatten(std::vector<std::vector<LabelEntry>>& labels);
+
+    static bool WriteLabels(std::ostream& output, const Labels& labels);
+
+    static bool ReadLabels(std::istream& input, size_t vertex_count, size_t entry_count, Labels& labels);
+
+    size_t vertex_count_ = 0;
+    Labels forward_;
+    Labels backward_;
+};
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const ContractionHierarchy<Weight>& hierarchy, parallel::ThreadPool& thread_pool)
+    : vertex_count_(hierarchy.GetVertexCount())
+{
+    if (vertex_count_ >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Vertex count does not fit hub labels");
+    }
+    std::vector<VertexId> rank_vertices(vertex_count_);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        rank_vertices[hierarchy.GetRank(vertex)] = vertex;
+    }
+    // уровень вершины — длина самой длинной цепочки рёбер вверх по иерархии
+    std::vector<size_t> levels(vertex_count_, 0);
+    std::vector<std::vector<VertexId>> level_vertices;
+    for (size_t rank = vertex_count_; rank-- > 0;) {
+        const VertexId vertex = rank_vertices[rank];
+        size_t level = 0;
+        for (const bool is_forward : {true, false}) {
+            hierarchy.ForEachUpwardArc(vertex, is_forward, [&](VertexId neighbor, Weight) {
+                level = std::max(level, levels[neighbor] + 1);
+            });
+        }
+        levels[vertex] = level;
+        if (level_vertices.size() <= level) {
+            level_vertices.resize(level + 1);
+        }
+        level_vertices[level].push_back(vertex);
+    }
+
+    std::vector<std::vector<LabelEntry>> forward_labels(vertex_count_);
+    std::vector<std::vector<LabelEntry>> backward_labels(vertex_count_);
+    for (const auto& vertices : level_vertices) {
+        thread_pool.ParallelFor(0, vertices.size(), [&](size_t i) {
+            const VertexId vertex = vertices[i];
+            forward_labels[vertex] = BuildLabel(hierarchy, vertex, true, rank_vertices,
+                                                forward_labels, backward_labels);
+            backward_labels[vertex] = BuildLabel(hierarchy, vertex, false, rank_vertices,
+                                                 backward_labels, forward_labels);
+        });
+    }
+    forward_ = Flatten(forward_labels);
+    backward_ = Flatten(backward_labels);
+}
+
+template <typename Weight>
+std::vector<typename HubLabels<Weight>::LabelEntry> HubLabels<Weight>::BuildLabel(
+        const ContractionHierarchy<Weight>& hierarchy, VertexId vertex, bool is_forward,
+        const std::vector<VertexId>& rank_vertices, const std::vector<std::vector<LabelEntry>>& labels,
+        const std::vector<std::vector<LabelEntry>>& opposite_labels) {
+    const auto own_hub = static_cast<uint32_t>(hierarchy.GetRank(vertex));
+    std::vector<LabelEntry> candidates = {{own_hub, ZERO_WEIGHT}};
+    hierarchy.ForEachUpwardArc(vertex, is_forward, [&](VertexId neighbor, Weight weight) {
+        for (const auto& [hub, hub_weight] : labels[neighbor]) {
+            candidates.emplace_back(hub, weight + hub_weight);
+        }
+    });
+    // для каждого хаба остаётся кратчайший путь
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                 [](const LabelEntry& lhs, const LabelEntry& rhs) {
+                                     return lhs.first == rhs.first;
+                                 }),
+                     candidates.end());
+
+    std::vector<LabelEntry> label;
+    label.reserve(candidates.size());
+    for (const auto& [hub, weight] : candidates) {
+        if (hub != own_hub) {
+            // запись не нужна, если до хаба есть более короткий путь через другой хаб
+            const auto& hub_label = opposite_labels[rank_vertices[hub]];
+            const auto covered_weight = MergeLabels(
+                    candidates.size(), [&](size_t i) { return candidates[i].first; },
+                    [&](size_t i) { return candidates[i].second; },
+                    hub_label.size(), [&](size_t i) { return hub_label[i].first; },
+                    [&](size_t i) { return hub_label[i].second; });
+            if (covered_weight && *covered_weight < weight) {
+                continue;
+            }
+        }
+        label.emplace_back(hub, weight);
+    }
+    label.shrink_to_fit();
+    return label;
+}
+
+template <typename Weight>
+typename HubLabels<Weight>::Labels HubLabels<Weight>::Flatten(std::vector<std::vector<LabelEntry>>& labels) {
+    Labels result;
+    result.offsets.reserve(labels.size() + 1);
+    result.offsets.push_back(0);
+    for (const auto& label : labels) {
+        result.offsets.push_back(result.offsets.back() + label.size());
+    }
+    result.hubs.reserve(result.offsets.back());
+    result.weights.reserve(result.offsets.back());
+    for (auto& label : labels) {
+        for (const auto& [hub, weight] : label) {
+            result.hubs.push_back(hub);
+            result.weights.push_back(weight);
+        }
+        label.clear();
+        label.shrink_to_fit();
+    }
+    return result;
+}
+
+template <typename Weight>
+std::optional<Weight> HubLabels<Weight>::GetWeight(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const size_t forward_begin = forward_.offsets[from];
+    const size_t backward_begin = backward_.offsets[to];
+    return MergeLabels(
+            forward_.offsets[from + 1] - forward_begin,
+            [&](size_t i) { return forward_.hubs[forward_begin + i]; },
+            [&](size_t i) { return forward_.weights[forward_begin + i]; },
+            backward_.offsets[to + 1] - backward_begin,
+            [&](size_t i) { return backward_.hubs[backward_begin + i]; },
+            [&](size_t i) { return backward_.weights[backward_begin + i]; });
+}
+
+template <typename Weight>
+size_t HubLabels<Weight>::GetVertexCount() const {
+    return vertex_count_;
+}
+
+template <typename Weight>
+size_t HubLabels<Weight>::GetEntryCount() const {
+    return forward_.hubs.size() + backward_.hubs.size();
+}
+
+template <typename Weight>
+size_t HubLabels<Weight>::GetMemoryUsage() const {
+    size_t usage = 0;
+    for (const Labels* labels : {&forward_, &backward_}) {
+        usage += labels->offsets.capacity() * sizeof(uint64_t) + labels->hubs.capacity() * sizeof(uint32_t)
+                + labels->weights.capacity() * sizeof(Weight);
+    }
+    return usage;
+}
+
+template <typename Weight>
+bool HubLabels<Weight>::WriteLabels(std::ostream& output, const Labels& labels) {
+    output.write(reinterpret_cast<const char*>(labels.offsets.data()), labels.offsets.size() * sizeof(uint64_t));
+    output.write(reinterpret_cast<const char*>(labels.hubs.data()), labels.hubs.size() * sizeof(uint32_t));
+    output.write(reinterpret_cast<const char*>(labels.weights.data()), labels.weights.size() * sizeof(Weight));
+    return output.good();
+}
+
+template <typename Weight>
+void HubLabels<Weight>::Save(std::ostream& output, uint64_t key) const {
+    static_assert(std::is_trivially_copyable_v<Weight>, "Weights are stored as is");
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.weight_size = sizeof(Weight);
+    header.key = key;
+    header.vertex_count = vertex_count_;
+    header.forward_entry_count = forward_.hubs.size();
+    header.backward_entry_count = backward_.hubs.size();
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteLabels(output, forward_);
+    WriteLabels(output, backward_);
+}
+
+template <typename Weight>
+bool HubLabels<Weight>::ReadLabels(std::istream& input, size_t vertex_count, size_t entry_count, Labels& labels) {
+    labels.offsets.resize(vertex_count + 1);
+    labels.hubs.resize(entry_count);
+    labels.weights.resize(entry_count);
+    input.read(reinterpret_cast<char*>(labels.offsets.data()), labels.offsets.size() * sizeof(uint64_t));
+    input.read(reinterpret_cast<char*>(labels.hubs.data()), labels.hubs.size() * sizeof(uint32_t));
+    input.read(reinterpret_cast<char*>(labels.weights.data()), labels.weights.size() * sizeof(Weight));
+    if (!input || labels.offsets.front() != 0 || labels.offsets.back() != entry_count
+        || !std::is_sorted(labels.offsets.begin(), labels.offsets.end())) {
+        return false;
+    }
+    return std::all_of(labels.hubs.begin(), labels.hubs.end(), [vertex_count](uint32_t hub) {
+        return hub < vertex_count;
+    });
+}
+
+template <typename Weight>
+std::optional<HubLabels<Weight>> HubLabels<Weight>::Load(std::istream& input, uint64_t key) {
+    FileHeader header;
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0
+        || header.version != FILE_VERSION
+        || header.weight_size != sizeof(Weight)
+        || header.key != key
+        || header.vertex_count >= std::numeric_limits<uint32_t>::max()) {
+        return std::nullopt;
+    }
+    HubLabels labels;
+    labels.vertex_count_ = header.vertex_count;
+    if (!ReadLabels(input, header.vertex_count, header.forward_entry_count, labels.forward_)
+        || !ReadLabels(input, header.vertex_count, header.backward_entry_count, labels.backward_)) {
+        return std::nullopt;
+    }
+    return labels;
+}
+/**
+ * Маршрутизация с индексом меток-хабов: веса путей (BuildWeights, BuildWeightsTable)
+ * вычисляются слиянием меток, маршруты с рёбрами строятся двунаправленным
+ * поиском Дейкстры по графу.
+ */
+template <typename Weight>
+class HubLabelRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    HubLabelRouter(const Graph& graph, HubLabels<Weight> labels)
+        : labels_(std::move(labels))
+        , route_router_(graph) {
+        if (labels_.GetVertexCount() != graph.GetVertexCount()) {
+            throw std::invalid_argument("Hub labels are built for another graph");
+        }
+    }
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override {
+        return route_router_.BuildRoute(from, to);
+    }
+
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(targets.size());
+        for (const VertexId to : targets) {
+            weights.push_back(labels_.GetWeight(from, to));
+        }
+        return weights;
+    }
+    /**
+     * Статистика поисков при построении маршрутов; запросы весов поиска не выполняют
+     */
+    std::optional<SearchStats> GetSearchStats() const override {
+        return route_router_.GetSearchStats();
+    }
+
+    const HubLabels<Weight>& GetLabels() const {
+        return labels_;
+    }
+
+private:
+    HubLabels<Weight> labels_;
+    BidirectionalDijkstraRouter<Weight> route_router_;
+};
+
+}  // namespace graph
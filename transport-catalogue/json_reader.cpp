@@ -1,5 +1,7 @@
 #include "json_reader.h"
 #include "json_builder.h"
+#include <algorithm>
+#include <cstdint>
 #include <sstream>
 /*
  * Здесь можно разместить код наполнения транспортного справочника данными из JSON,
@@ -9,6 +11,10 @@
  * Ключ запросов - Массив с описанием автобусных маршрутов и остановок
  */
 const char* JsonReader::KEY_BASE_REQUESTS = "base_requests";
+/**
+ * Ключ запросов - Массив с изменениями маршрутов и расстояний после наполнения справочника
+ */
+const char* JsonReader::KEY_UPDATE_REQUESTS = "update_requests";
 /**
  * Ключ запросов - Массив с запросами к транспортному справочнику
  */
@@ -94,6 +100,175 @@ svg::Point PointFromNode(const json::Node& node) {
     }
     throw std::logic_error("Missing node type for point parsing"s);
 }
+/**
+ * Парсинг алгоритма маршрутизации из ноды
+ */
+transport::RoutingAlgorithm RoutingAlgorithmFromNode(const json::Node& node) {
+    using namespace std::literals;
+    const auto& algorithm = node.AsString();
+    if (algorithm == "floyd_warshall"s) {
+        return transport::RoutingAlgorithm::FLOYD_WARSHALL;
+    }
+    if (algorithm == "floyd_warshall_parallel"s) {
+        return transport::RoutingAlgorithm::FLOYD_WARSHALL_PARALLEL;
+    }
+    if (algorithm == "dijkstra"s) {
+        return transport::RoutingAlgorithm::DIJKSTRA;
+    }
+    if (algorithm == "dijkstra_cached"s) {
+        return transport::RoutingAlgorithm::DIJKSTRA_CACHED;
+    }
+    if (algorithm == "contraction_hierarchies"s) {
+        return transport::RoutingAlgorithm::CONTRACTION_HIERARCHIES;
+    }
+    if (algorithm == "a_star"s) {
+        return transport::RoutingAlgorithm::A_STAR;
+    }
+    if (algorithm == "raptor"s) {
+        return transport::RoutingAlgorithm::RAPTOR;
+    }
+    if (algorithm == "bidirectional_dijkstra"s) {
+        return transport::RoutingAlgorithm::BIDIRECTIONAL_DIJKSTRA;
+    }
+    if (algorithm == "hub_labels"s) {
+        return transport::RoutingAlgorithm::HUB_LABELS;
+    }
+    throw std::logic_error("Unknown routing algorithm: "s + algorithm);
+}
+/**
+ * Хэш FNV-1a текстового представления нод, не зависящий от запуска программы
+ */
+uint64_t HashNodes(const std::vector<const json::Node*>& nodes) {
+    std::ostringstream text;
+    for (const json::Node* node : nodes) {
+        if (node != nullptr) {
+            json::Print(json::Document{*node}, text);
+        }
+        text << '\n';
+    }
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : text.str()) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+/**
+ * Парсинг расписания маршрута из ноды: время отправления рейсов в минутах
+ */
+std::vector<double> DeparturesFromNode(const json::Node& node) {
+    const auto& departures_array = node.AsArray();
+    std::vector<double> departures;
+    departures.reserve(departures_array.size());
+    for (const auto& departure : departures_array) {
+        departures.push_back(departure.AsDouble());
+    }
+    return departures;
+}
+/**
+ * Время отправления из запроса; по умолчанию — начало суток
+ */
+double DepartureTimeFromRequest(const json::Dict& request) {
+    using namespace std::literals;
+    const auto it = request.find("departure_time"s);
+    return it != request.end() ? it->second.AsDouble() : 0.0;
+}
+/**
+ * Элементы маршрута: ожидания и поездки
+ */
+json::Array RouteItemsToNode(const transport::RouterResponse& router_response) {
+    using namespace std::literals;
+    json::Array items;
+    items.reserve(router_response.route.size());
+    for (const auto& route : router_response.route) {
+        if (std::holds_alternative<transport::RouterResponse::Departure>(route)) {
+            const auto& departure = std::get<transport::RouterResponse::Departure>(route);
+            items.emplace_back(json::Node(json::Builder{}
+                                          .StartDict()
+                                          .Key("stop_name"s).Value(departure.stop_name)
+                                          .Key("time"s).Value(departure.time)
+                                          .Key("type"s).Value("Wait"s)
+                                          .EndDict()
+                                          .Build()));
+        }
+        else if (std::holds_alternative<transport::RouterResponse::Route>(route)) {
+            const auto& bus_route = std::get<transport::RouterResponse::Route>(route);
+            items.emplace_back(json::Node(json::Builder{}
+                                          .StartDict()
+                                          .Key("bus"s).Value(bus_route.bus)
+                                          .Key("span_count"s).Value(static_cast<int>(bus_route.span_count))
+                                          .Key("time"s).Value(bus_route.time)
+                                          .Key("type"s).Value("Bus"s)
+                                          .EndDict()
+                                          .Build()));
+        }
+    }
+    return items;
+}
+/**
+ * Количество маршрутов из запроса Route ("k"), включая оптимальный; по умолчанию — 1
+ */
+int RouteCountFromRequest(const json::Dict& request) {
+    using namespace std::literals;
+    const auto it = request.find("k"s);
+    return it != request.end() ? it->second.AsInt() : 1;
+}
+/**
+ * Ответ на запрос Route: оптимальный маршрут и, при with_alternatives, остальные маршруты
+ */
+json::Node RouterResponsesToNode(int request_id, const std::vector<transport::RouterResponse>& router_responses,
+                                 bool with_alternatives) {
+    using namespace std::literals;
+    if (router_responses.empty()) {
+        return json::Builder{}
+        .StartDict()
+        .Key("request_id"s).Value(request_id)
+        .Key("error_message"s).Value("not found"s)
+        .EndDict()
+        .Build();
+    }
+    const auto& router_response = router_responses.front();
+    if (!with_alternatives) {
+        return json::Builder{}
+        .StartDict()
+        .Key("request_id"s).Value(request_id)
+        .Key("total_time"s).Value(router_response.total_time)
+        .Key("items"s).Value(RouteItemsToNode(router_response))
+        .EndDict()
+        .Build();
+    }
+    json::Array alternatives;
+    for (size_t i = 1; i < router_responses.size(); ++i) {
+        alternatives.emplace_back(json::Builder{}
+                                  .StartDict()
+                                  .Key("total_time"s).Value(router_responses[i].total_time)
+                                  .Key("items"s).Value(RouteItemsToNode(router_responses[i]))
+                                  .EndDict()
+                                  .Build());
+    }
+    return json::Builder{}
+    .StartDict()
+    .Key("request_id"s).Value(request_id)
+    .Key("total_time"s).Value(router_response.total_time)
+    .Key("items"s).Value(RouteItemsToNode(router_response))
+    .Key("alternatives"s).Value(std::move(alternatives))
+    .EndDict()
+    .Build();
+}
+/**
+ * Парсинг модели графа маршрутизации из ноды
+ */
+transport::TransitGraphModel TransitGraphModelFromNode(const json::Node& node) {
+    using namespace std::literals;
+    const auto& graph_model = node.AsString();
+    if (graph_model == "span_edges"s) {
+        return transport::TransitGraphModel::SPAN_EDGES;
+    }
+    if (graph_model == "linear"s) {
+        return transport::TransitGraphModel::LINEAR;
+    }
+    throw std::logic_error("Unknown transit graph model: "s + graph_model);
+}
 
 }
 /**
@@ -134,10 +309,35 @@ void JsonReader::UploadData(RequestHandler& handler) {
         bool circular_route = command->at("is_roundtrip"s).AsBool();
         const auto& stops = RouteFromNode(command->at("stops"s), circular_route);
         handler.AddRoute(bus_number, stops, circular_route);
+        if (command->count("departures"s)) {
+            handler.SetDepartures(bus_number, DeparturesFromNode(command->at("departures"s)));
+        }
     }
     // обновляем данные в инструментах
     handler.UpdateInternalData();
 }
+/**
+ * Применяет изменения: Stop задаёт новые расстояния от существующей остановки,
+ * Bus заменяет маршрут или добавляет новый. Изменения с неизвестными остановками пропускаются.
+ */
+void JsonReader::ApplyUpdates(RequestHandler& handler) {
+    using namespace std::literals;
+    const json::Node* requests = GetRequests(KEY_UPDATE_REQUESTS);
+    if (requests == nullptr) return;
+    for (const auto& command : CommandsFromNode(requests, "Stop"s)) {
+        if (command->count("road_distances"s) == 0) continue;
+        const auto& stop_from = command->at("name"s).AsString();
+        for (const auto& [stop_to, distance] : command->at("road_distances"s).AsMap()) {
+            handler.UpdateDistance(stop_from, stop_to, distance.AsInt());
+        }
+    }
+    for (const auto& command : CommandsFromNode(requests, "Bus"s)) {
+        bool circular_route = command->at("is_roundtrip"s).AsBool();
+        handler.UpdateRoute(command->at("name"s).AsString(),
+                            RouteFromNode(command->at("stops"s), circular_route), circular_route);
+    }
+    handler.ApplyUpdates();
+}
 /**
  * Возвращает статистику в соответствии с запросами
  */
@@ -145,6 +345,9 @@ void JsonReader::PrintResponses(RequestHandler& handler, std::ostream &output) {
     using namespace std::literals;
     const json::Node* requests = GetRequests(KEY_STAT_REQUESTS);
     if (requests == nullptr) return;
+    // запросы Route без альтернатив выполняются одним пакетом параллельно
+    auto routing_responses = PrintRoutingBatch(requests->AsArray(), handler);
+    size_t next_routing_response = 0;
     json::Array responses;
     for (auto& request : requests->AsArray()) {
         const auto& type = request.AsMap().at("type"s).AsString();
@@ -158,7 +361,21 @@ void JsonReader::PrintResponses(RequestHandler& handler, std::ostream &output) {
             responses.emplace_back(PrintMap(request, handler).AsMap());
         }
         else if (type == "Route"s) {
-            responses.emplace_back(PrintRouting(request, handler).AsMap());
+            if (RouteCountFromRequest(request.AsMap()) > 1) {
+                responses.emplace_back(PrintRouting(request, handler).AsMap());
+            }
+            else {
+                responses.emplace_back(routing_responses[next_routing_response++].AsMap());
+            }
+        }
+        else if (type == "Matrix"s) {
+            responses.emplace_back(PrintMatrix(request, handler).AsMap());
+        }
+        else if (type == "Isochrone"s) {
+            responses.emplace_back(PrintIsochrone(request, handler).AsMap());
+        }
+        else if (type == "Pareto"s) {
+            responses.emplace_back(PrintPareto(request, handler).AsMap());
         }
     }
     json::Print(json::Document{ responses }, output);
@@ -202,6 +419,31 @@ transport::RoutingSettings JsonReader::GetRoutingSettings() {
     transport::RoutingSettings routing_settings;
     routing_settings.bus_wait_time = settings_map.at("bus_wait_time").AsInt();
     routing_settings.bus_velocity = settings_map.at("bus_velocity").AsDouble();
+    if (settings_map.count("algorithm")) {
+        routing_settings.algorithm = RoutingAlgorithmFromNode(settings_map.at("algorithm"));
+    }
+    if (settings_map.count("thread_count")) {
+        routing_settings.thread_count = static_cast<size_t>(settings_map.at("thread_count").AsInt());
+    }
+    if (settings_map.count("compact_routes_storage")) {
+        routing_settings.compact_routes_storage = settings_map.at("compact_routes_storage").AsBool();
+    }
+    if (settings_map.count("trees_cache_budget_mb")) {
+        routing_settings.trees_cache_budget_mb = static_cast<size_t>(settings_map.at("trees_cache_budget_mb").AsInt());
+    }
+    if (settings_map.count("graph_model")) {
+        routing_settings.graph_model = TransitGraphModelFromNode(settings_map.at("graph_model"));
+    }
+    if (settings_map.count("prune_parallel_edges")) {
+        routing_settings.prune_parallel_edges = settings_map.at("prune_parallel_edges").AsBool();
+    }
+    if (settings_map.count("fixed_point_weights")) {
+        routing_settings.fixed_point_weights = settings_map.at("fixed_point_weights").AsBool();
+    }
+    if (settings_map.count("cache_file")) {
+        routing_settings.cache_file = settings_map.at("cache_file").AsString();
+        routing_settings.cache_key = HashNodes({GetRequests(KEY_BASE_REQUESTS), settings});
+    }
     return routing_settings;
 }
 /**
@@ -280,13 +522,106 @@ const json::Node JsonReader::PrintMap(const json::Node& request_map, RequestHand
 }
 
 const json::Node JsonReader::PrintRouting(const json::Node& request_map, RequestHandler& handler) {
+    using namespace std::literals;
+    const auto& request = request_map.AsMap();
+    const int request_id = request.at("id"s).AsInt();
+    const std::string_view stop_from = request.at("from"s).AsString();
+    const std::string_view stop_to = request.at("to"s).AsString();
+    const double departure_time = DepartureTimeFromRequest(request);
+    const int k = RouteCountFromRequest(request);
+    std::vector<transport::RouterResponse> router_responses;
+    if (k > 1) {
+        router_responses = handler.GetOptimalRoutes(stop_from, stop_to, static_cast<size_t>(k), departure_time);
+    }
+    else if (auto router_response = handler.GetOptimalRoute(stop_from, stop_to, departure_time)) {
+        router_responses.push_back(std::move(*router_response));
+    }
+    return RouterResponsesToNode(request_id, router_responses, k > 1);
+}
+/**
+ * Вывод оптимальных маршрутов для всех запросов Route без альтернатив, в порядке запросов
+ */
+std::vector<json::Node> JsonReader::PrintRoutingBatch(const json::Array& requests, RequestHandler& handler) {
+    using namespace std::literals;
+    std::vector<int> request_ids;
+    std::vector<RouteQuery> queries;
+    for (const auto& request_node : requests) {
+        const auto& request = request_node.AsMap();
+        if (request.at("type"s).AsString() != "Route"s || RouteCountFromRequest(request) > 1) {
+            continue;
+        }
+        request_ids.push_back(request.at("id"s).AsInt());
+        queries.push_back({request.at("from"s).AsString(), request.at("to"s).AsString(),
+                           DepartureTimeFromRequest(request)});
+    }
+    auto router_responses = handler.GetOptimalRoutesBatch(queries);
+    std::vector<json::Node> responses;
+    responses.reserve(router_responses.size());
+    for (size_t i = 0; i < router_responses.size(); ++i) {
+        std::vector<transport::RouterResponse> route;
+        if (router_responses[i]) {
+            route.push_back(std::move(*router_responses[i]));
+        }
+        responses.push_back(RouterResponsesToNode(request_ids[i], route, false));
+    }
+    return responses;
+}
+/**
+ * Вывод матрицы времени поездки.
+ * Строка на каждую остановку "from", столбец на каждую остановку "to";
+ * null — маршрута нет или остановка неизвестна.
+ */
+const json::Node JsonReader::PrintMatrix(const json::Node& request_map, RequestHandler& handler) {
     using namespace std::literals;
     const int request_id = request_map.AsMap().at("id"s).AsInt();
-    const std::string_view stop_from = request_map.AsMap().at("from"s).AsString();
-    const std::string_view stop_to = request_map.AsMap().at("to"s).AsString();
-    const auto& router_response = handler.GetOptimalRoute(stop_from, stop_to);
+    const auto stop_names = [&request_map](const std::string& key) {
+        const auto& stops_array = request_map.AsMap().at(key).AsArray();
+        std::vector<std::string_view> stops;
+        stops.reserve(stops_array.size());
+        for (const auto& stop : stops_array) {
+            stops.push_back(stop.AsString());
+        }
+        return stops;
+    };
+    const auto times = handler.GetTravelTimes(stop_names("from"s), stop_names("to"s),
+                                              DepartureTimeFromRequest(request_map.AsMap()));
 
-    if (!router_response) {
+    json::Array rows;
+    rows.reserve(times.size());
+    for (const auto& row_times : times) {
+        json::Array row;
+        row.reserve(row_times.size());
+        for (const auto& time : row_times) {
+            if (time) {
+                row.emplace_back(*time);
+            }
+            else {
+                row.emplace_back(nullptr);
+            }
+        }
+        rows.emplace_back(std::move(row));
+    }
+    return json::Builder{}
+    .StartDict()
+    .Key("request_id"s).Value(request_id)
+    .Key("total_times"s).Value(std::move(rows))
+    .EndDict()
+    .Build();
+}
+/**
+ * Вывод остановок, достижимых за ограниченное время.
+ * "stop" — исходная остановка, "max_time" — предельное время в минутах;
+ * при "reverse": true выводятся остановки, из которых достижима исходная.
+ */
+const json::Node JsonReader::PrintIsochrone(const json::Node& request_map, RequestHandler& handler) {
+    using namespace std::literals;
+    const auto& request = request_map.AsMap();
+    const int request_id = request.at("id"s).AsInt();
+    const bool reverse = request.count("reverse"s) != 0 && request.at("reverse"s).AsBool();
+    const auto reachable = handler.GetReachableStops(request.at("stop"s).AsString(),
+                                                     request.at("max_time"s).AsDouble(), reverse,
+                                                     DepartureTimeFromRequest(request));
+    if (!reachable) {
         return json::Builder{}
         .StartDict()
         .Key("request_id"s).Value(request_id)
@@ -295,35 +630,59 @@ const json::Node JsonReader::PrintRouting(const json::Node& request_map, Request
         .Build();
     }
     json::Array items;
-    items.reserve(router_response->route.size());
-    for (const auto& route : router_response->route) {
-        if (std::holds_alternative<transport::RouterResponse::Departure>(route)) {
-            const auto& departure = std::get<transport::RouterResponse::Departure>(route);
-            items.emplace_back(json::Node(json::Builder{}
-                                          .StartDict()
-                                          .Key("stop_name"s).Value(departure.stop_name)
-                                          .Key("time"s).Value(departure.time)
-                                          .Key("type"s).Value("Wait"s)
-                                          .EndDict()
-                                          .Build()));
-        }
-        else if (std::holds_alternative<transport::RouterResponse::Route>(route)) {
-            const auto& bus_route = std::get<transport::RouterResponse::Route>(route);
-            items.emplace_back(json::Node(json::Builder{}
-                                          .StartDict()
-                                          .Key("bus"s).Value(bus_route.bus)
-                                          .Key("span_count"s).Value(static_cast<int>(bus_route.span_count))
-                                          .Key("time"s).Value(bus_route.time)
-                                          .Key("type"s).Value("Bus"s)
-                                          .EndDict()
-                                          .Build()));
-        }
+    items.reserve(reachable->size());
+    for (const auto& [stop, time] : *reachable) {
+        items.emplace_back(json::Builder{}
+                           .StartDict()
+                           .Key("stop_name"s).Value(stop->name)
+                           .Key("time"s).Value(time)
+                           .EndDict()
+                           .Build());
+    }
+    return json::Builder{}
+    .StartDict()
+    .Key("request_id"s).Value(request_id)
+    .Key("items"s).Value(std::move(items))
+    .EndDict()
+    .Build();
+}
+/**
+ * Вывод маршрутов, оптимальных по Парето по времени и числу пересадок.
+ * "from", "to" — остановки; "max_transfers" — необязательное ограничение числа пересадок.
+ */
+const json::Node JsonReader::PrintPareto(const json::Node& request_map, RequestHandler& handler) {
+    using namespace std::literals;
+    const auto& request = request_map.AsMap();
+    const int request_id = request.at("id"s).AsInt();
+    std::optional<size_t> max_transfers;
+    if (const auto it = request.find("max_transfers"s); it != request.end()) {
+        max_transfers = static_cast<size_t>(std::max(it->second.AsInt(), 0));
+    }
+    const auto pareto_routes = handler.GetParetoRoutes(request.at("from"s).AsString(), request.at("to"s).AsString(),
+                                                       max_transfers, DepartureTimeFromRequest(request));
+    if (pareto_routes.empty()) {
+        return json::Builder{}
+        .StartDict()
+        .Key("request_id"s).Value(request_id)
+        .Key("error_message"s).Value("not found"s)
+        .EndDict()
+        .Build();
+    }
+    json::Array routes;
+    routes.reserve(pareto_routes.size());
+    for (const auto& [transfers, router_response] : pareto_routes) {
+        routes.emplace_back(json::Builder{}
+                            .StartDict()
+                            .Key("total_time"s).Value(router_response.total_time)
+                            .Key("transfers"s).Value(static_cast<int>(transfers))
+                            .Key("items"s).Value(RouteItemsToNode(router_response))
+                            .EndDict()
+                            .Build());
     }
     return json::Builder{}
     .StartDict()
     .Key("request_id"s).Value(request_id)
-    .Key("total_time"s).Value(router_response->total_time)
-    .Key("items"s).Value(items)
+    .Key("routes"s).Value(std::move(routes))
     .EndDict()
     .Build();
 }
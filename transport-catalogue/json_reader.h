@@ -9,6 +9,10 @@ class JsonReader {
      * Ключ запросов - Массив с описанием автобусных маршрутов и остановок
      */
     static const char* KEY_BASE_REQUESTS;
+    /**
+     * Ключ запросов - Массив с изменениями маршрутов и расстояний после наполнения справочника
+     */
+    static const char* KEY_UPDATE_REQUESTS;
     /**
      * Ключ запросов - Массив с запросами к транспортному справочнику
      */
@@ -30,6 +34,10 @@ public:
      * Наполняет данными транспортный справочник в соответствии с запросами
      */
     void UploadData(RequestHandler& handler);
+    /**
+     * Применяет изменения маршрутов и расстояний без полной пересборки маршрутизатора
+     */
+    void ApplyUpdates(RequestHandler& handler);
     /**
      * Вывод информации в соответствии со считанными запросами.
      */
@@ -60,9 +68,26 @@ private:
      */
     static const json::Node PrintMap(const json::Node& request_map, RequestHandler& handler);
     /**
-     * Вывод оптимального маршрута
+     * Вывод оптимального маршрута; при заданном "k" — и альтернативных маршрутов
      */
     static const json::Node PrintRouting(const json::Node& request_map, RequestHandler& handler);
+    /**
+     * Вывод оптимальных маршрутов для всех запросов Route без альтернатив пакетом,
+     * с параллельным поиском; ответы в порядке запросов
+     */
+    static std::vector<json::Node> PrintRoutingBatch(const json::Array& requests, RequestHandler& handler);
+    /**
+     * Вывод матрицы времени поездки
+     */
+    static const json::Node PrintMatrix(const json::Node& request_map, RequestHandler& handler);
+    /**
+     * Вывод остановок, достижимых за ограниченное время
+     */
+    static const json::Node PrintIsochrone(const json::Node& request_map, RequestHandler& handler);
+    /**
+     * Вывод маршрутов, оптимальных по времени и числу пересадок
+     */
+    static const json::Node PrintPareto(const json::Node& request_map, RequestHandler& handler);
 private:
     /**
      * Считанные запросы
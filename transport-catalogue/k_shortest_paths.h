@@ -0,0 +1,252 @@
+#pragma once
+
+#include "closures.h"
+#include "routing_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+/**
+ * Поиск k кратчайших простых (без повторения вершин) путей алгоритмом Йена.
+ * Каждый следующий путь — лучший из кандидатов, полученных отклонением от уже
+ * найденных путей: корень найденного пути сохраняется, а продолжение ищется из вершины
+ * отклонения без вершин корня и без рёбер, по которым из этого корня уже уходили.
+ *
+ * Работа между кандидатами разделяется через одно дерево кратчайших путей до цели,
+ * построенное обратным поиском Дейкстры. Если путь по дереву из вершины отклонения
+ * не задевает запреты, он и есть продолжение; иначе выполняется поиск A*
+ * с точными расстояниями дерева в качестве оценки, которая остаётся допустимой
+ * при любых запретах.
+ *
+ * Закрытые вершины и рёбра (closures) не входят ни в дерево, ни в найденные пути.
+ */
+template <typename Weight>
+class KShortestPaths {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RoutingEngine<Weight>::RouteInfo;
+
+    KShortestPaths(const Graph& graph, VertexId to, const Closures* closures = nullptr);
+    /**
+     * До k путей из from в цель по возрастанию веса
+     */
+    std::vector<RouteInfo> Find(VertexId from, size_t k) const;
+
+private:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+    /**
+     * Запреты при поиске продолжения из вершины отклонения
+     */
+    struct Restrictions {
+        std::vector<char> blocked_vertices;
+        std::vector<char> blocked_edges;
+    };
+    /**
+     * Путь из vertex в цель по дереву, если он не задевает запретов
+     */
+    std::optional<std::vector<EdgeId>> GetTreePath(VertexId vertex, const Restrictions& restrictions) const;
+    /**
+     * Кратчайший путь из vertex в цель с учётом запретов
+     */
+    std::optional<std::vector<EdgeId>> SearchPath(VertexId vertex, const Restrictions& restrictions) const;
+
+    Weight GetPathWeight(const std::vector<EdgeId>& edges) const;
+
+    const Graph& graph_;
+    VertexId to_;
+    const Closures* closures_;
+    /**
+     * Расстояние от каждой вершины до цели и первое ребро кратчайшего пути к ней
+     */
+    std::vector<std::optional<Weight>> distances_;
+    std::vector<EdgeId> next_edges_;
+};
+
+template <typename Weight>
+KShortestPaths<Weight>::KShortestPaths(const Graph& graph, VertexId to, const Closures* closures)
+    : graph_(graph)
+    , to_(to)
+    , closures_(closures)
+    , distances_(graph.GetVertexCount())
+    , next_edges_(graph.GetVertexCount(), NO_EDGE)
+{
+    if (to >= graph.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    if (closures != nullptr && closures->IsVertexClosed(to)) {
+        return;
+    }
+    distances_[to] = ZERO_WEIGHT;
+    queue.push({ZERO_WEIGHT, to});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (*distances_[vertex] < weight) {
+            continue;
+        }
+        for (const EdgeId edge_id : graph.GetIncomingEdges(vertex)) {
+            if (closures != nullptr && !closures->IsEdgeOpen(graph, edge_id)) {
+                continue;
+            }
+            const VertexId edge_from = graph.GetEdgeSource(edge_id);
+            const Weight candidate_weight = weight + graph.GetEdgeWeight(edge_id);
+            auto& distance = distances_[edge_from];
+            if (!distance || candidate_weight < *distance) {
+                distance = candidate_weight;
+                next_edges_[edge_from] = edge_id;
+                queue.push({candidate_weight, edge_from});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<typename KShortestPaths<Weight>::RouteInfo> KShortestPaths<Weight>::Find(VertexId from, size_t k) const {
+    if (from >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    std::vector<RouteInfo> paths;
+    Restrictions restrictions{std::vector<char>(graph_.GetVertexCount(), 0),
+                              std::vector<char>(graph_.GetEdgeCount(), 0)};
+    auto first_path = k > 0 && distances_[from] ? GetTreePath(from, restrictions) : std::nullopt;
+    if (!first_path) {
+        return paths;
+    }
+    paths.push_back({GetPathWeight(*first_path), std::move(*first_path)});
+
+    // кандидаты упорядочены по весу; найденные и отложенные пути не повторяются
+    std::set<std::pair<Weight, std::vector<EdgeId>>> candidates;
+    std::set<std::vector<EdgeId>> known_paths = {paths.back().edges};
+    while (paths.size() < k) {
+        const std::vector<EdgeId> last_path = paths.back().edges;
+        VertexId spur_vertex = from;
+        for (size_t spur_index = 0; spur_index < last_path.size(); ++spur_index) {
+            // рёбра, которыми найденные пути с тем же корнем уходят из вершины отклонения
+            std::vector<EdgeId> blocked_edges;
+            for (const auto& path : paths) {
+                if (path.edges.size() > spur_index
+                    && std::equal(last_path.begin(), last_path.begin() + spur_index, path.edges.begin())) {
+                    blocked_edges.push_back(path.edges[spur_index]);
+                }
+            }
+            for (const EdgeId edge_id : blocked_edges) {
+                restrictions.blocked_edges[edge_id] = 1;
+            }
+            auto spur_path = GetTreePath(spur_vertex, restrictions);
+            if (!spur_path) {
+                spur_path = SearchPath(spur_vertex, restrictions);
+            }
+            for (const EdgeId edge_id : blocked_edges) {
+                restrictions.blocked_edges[edge_id] = 0;
+            }
+            if (spur_path) {
+                std::vector<EdgeId> candidate(last_path.begin(), last_path.begin() + spur_index);
+                candidate.insert(candidate.end(), spur_path->begin(), spur_path->end());
+                if (known_paths.insert(candidate).second) {
+                    const Weight weight = GetPathWeight(candidate);
+                    candidates.emplace(weight, std::move(candidate));
+                }
+            }
+            // вершины корня следующих отклонений запрещены, чтобы путь оставался простым
+            restrictions.blocked_vertices[spur_vertex] = 1;
+            spur_vertex = graph_.GetEdgeTarget(last_path[spur_index]);
+        }
+        for (const EdgeId edge_id : last_path) {
+            restrictions.blocked_vertices[graph_.GetEdgeSource(edge_id)] = 0;
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        auto best = candidates.extract(candidates.begin());
+        paths.push_back({best.value().first, std::move(best.value().second)});
+    }
+    return paths;
+}
+
+template <typename Weight>
+std::optional<std::vector<EdgeId>> KShortestPaths<Weight>::GetTreePath(VertexId vertex,
+                                                                       const Restrictions& restrictions) const {
+    if (!distances_[vertex]) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (; vertex != to_; vertex = graph_.GetEdgeTarget(edges.back())) {
+        const EdgeId edge_id = next_edges_[vertex];
+        if (restrictions.blocked_edges[edge_id] || restrictions.blocked_vertices[graph_.GetEdgeTarget(edge_id)]) {
+            return std::nullopt;
+        }
+        edges.push_back(edge_id);
+    }
+    return edges;
+}
+
+template <typename Weight>
+std::optional<std::vector<EdgeId>> KShortestPaths<Weight>::SearchPath(VertexId vertex,
+                                                                      const Restrictions& restrictions) const {
+    if (!distances_[vertex]) {
+        return std::nullopt;
+    }
+    // очередь по оценке полного пути; расстояние по дереву — нижняя граница при любых запретах
+    using QueueItem = std::tuple<Weight, Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    std::vector<std::optional<Weight>> weights(graph_.GetVertexCount());
+    std::vector<EdgeId> prev_edges(graph_.GetVertexCount(), NO_EDGE);
+    weights[vertex] = ZERO_WEIGHT;
+    queue.push({*distances_[vertex], ZERO_WEIGHT, vertex});
+    while (!queue.empty()) {
+        const auto [estimate, weight, current] = queue.top();
+        queue.pop();
+        if (*weights[current] < weight) {
+            continue;
+        }
+        if (current == to_) {
+            std::vector<EdgeId> edges;
+            for (EdgeId edge_id = prev_edges[to_]; edge_id != NO_EDGE;
+                 edge_id = prev_edges[graph_.GetEdgeSource(edge_id)]) {
+                edges.push_back(edge_id);
+            }
+            std::reverse(edges.begin(), edges.end());
+            return edges;
+        }
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(current)) {
+            const VertexId edge_to = graph_.GetEdgeTarget(edge_id);
+            if (restrictions.blocked_edges[edge_id] || restrictions.blocked_vertices[edge_to]
+                || !distances_[edge_to] || edge_to == vertex
+                || (closures_ != nullptr && !closures_->IsEdgeOpen(graph_, edge_id))) {
+                continue;
+            }
+            const Weight candidate_weight = weight + graph_.GetEdgeWeight(edge_id);
+            if (!weights[edge_to] || candidate_weight < *weights[edge_to]) {
+                weights[edge_to] = candidate_weight;
+                prev_edges[edge_to] = edge_id;
+                queue.push({candidate_weight + *distances_[edge_to], candidate_weight, edge_to});
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename Weight>
+Weight KShortestPaths<Weight>::GetPathWeight(const std::vector<EdgeId>& edges) const {
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdgeWeight(edge_id);
+    }
+    return weight;
+}
+
+}  // namespace graph
@@ -18,6 +18,8 @@ int main() {
     RequestHandler handler(renderer, router);
     // загружаем данные в каталог
     json_doc.UploadData(handler);
+    // применяем изменения маршрутов и расстояний
+    json_doc.ApplyUpdates(handler);
     // обрабатываем запросы
 //    std::ofstream of("out.json");
     json_doc.PrintResponses(handler, std::cout);
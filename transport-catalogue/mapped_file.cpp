@@ -0,0 +1,92 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IO_HAS_MMAP 1
+#endif
+/**
+ * Средства ввода-вывода
+ */
+namespace io {
+/**
+ * Отобразить файл в память.
+ * Возвращает nullopt, если файл не существует, пуст или отображение не поддерживается.
+ */
+std::optional<MappedFile> MappedFile::Open(const std::string& path) {
+#ifdef IO_HAS_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    const size_t size = static_cast<size_t>(file_stat.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // отображение остаётся действительным после закрытия дескриптора
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+    return MappedFile(static_cast<const char*>(data), size);
+#else
+    (void)path;
+    return std::nullopt;
+#endif
+}
+
+MappedFile::MappedFile(const char* data, size_t size)
+    : data_(data)
+    , size_(size) {
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+/**
+ * Начало содержимого файла
+ */
+const char* MappedFile::GetData() const {
+    return data_;
+}
+/**
+ * Размер файла в байтах
+ */
+size_t MappedFile::GetSize() const {
+    return size_;
+}
+/**
+ * Снять отображение
+ */
+void MappedFile::Unmap() {
+#ifdef IO_HAS_MMAP
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+}  // namespace io
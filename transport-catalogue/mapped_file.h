@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+/**
+ * Средства ввода-вывода
+ */
+namespace io {
+/**
+ * Файл, отображённый в память только для чтения.
+ * Отображение снимается при уничтожении объекта.
+ */
+class MappedFile {
+public:
+    /**
+     * Отобразить файл в память.
+     * Возвращает nullopt, если файл не существует, пуст или отображение не поддерживается.
+     */
+    static std::optional<MappedFile> Open(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+    /**
+     * Начало содержимого файла
+     */
+    const char* GetData() const;
+    /**
+     * Размер файла в байтах
+     */
+    size_t GetSize() const;
+private:
+    MappedFile(const char* data, size_t size);
+    /**
+     * Снять отображение
+     */
+    void Unmap();
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace io
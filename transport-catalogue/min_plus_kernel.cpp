@@ -0,0 +1,158 @@
+#include "min_plus_kernel.h"
+
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MIN_PLUS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace {
+
+using RelaxRowFunction = void (*)(float, uint32_t, const float*, const uint32_t*, float*, uint32_t*, size_t);
+
+void RelaxRowScalar(float weight_from, uint32_t prev_edge_from,
+                    const float* weights_through, const uint32_t* prev_edges_through,
+                    float* weights, uint32_t* prev_edges, size_t count) {
+    RelaxMinPlusRow<float>(weight_from, prev_edge_from, weights_through, prev_edges_through,
+                           weights, prev_edges, count);
+}
+
+#ifdef MIN_PLUS_X86
+/**
+ * Ядра собираются с атрибутом target, поэтому остальной код не требует флагов
+ * компилятора для AVX и работает на процессорах без них
+ */
+__attribute__((target("avx2")))
+void RelaxRowAvx2(float weight_from, uint32_t prev_edge_from,
+                  const float* weights_through, const uint32_t* prev_edges_through,
+                  float* weights, uint32_t* prev_edges, size_t count) {
+    const __m256 weight_from_lanes = _mm256_set1_ps(weight_from);
+    const __m256i prev_edge_from_lanes = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m256i no_edge_lanes = _mm256_set1_epi32(-1);
+    size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+        const __m256 candidate = _mm256_add_ps(weight_from_lanes, _mm256_loadu_ps(weights_through + j));
+        const __m256 current = _mm256_loadu_ps(weights + j);
+        const __m256 improved = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+        // в большинстве блоков улучшений нет, и запись пропускается
+        if (_mm256_testz_ps(improved, improved)) {
+            continue;
+        }
+        _mm256_storeu_ps(weights + j, _mm256_blendv_ps(current, candidate, improved));
+        const auto prev_edges_through_lanes = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(prev_edges_through + j));
+        const __m256i new_prev_edges = _mm256_blendv_epi8(
+                prev_edges_through_lanes, prev_edge_from_lanes,
+                _mm256_cmpeq_epi32(prev_edges_through_lanes, no_edge_lanes));
+        auto* prev_edges_lanes = reinterpret_cast<__m256i*>(prev_edges + j);
+        _mm256_storeu_si256(prev_edges_lanes, _mm256_blendv_epi8(_mm256_loadu_si256(prev_edges_lanes),
+                                                                 new_prev_edges,
+                                                                 _mm256_castps_si256(improved)));
+    }
+    RelaxMinPlusRow<float>(weight_from, prev_edge_from, weights_through + j, prev_edges_through + j,
+                           weights + j, prev_edges + j, count - j);
+}
+
+__attribute__((target("avx512f")))
+void RelaxRowAvx512(float weight_from, uint32_t prev_edge_from,
+                    const float* weights_through, const uint32_t* prev_edges_through,
+                    float* weights, uint32_t* prev_edges, size_t count) {
+    const __m512 weight_from_lanes = _mm512_set1_ps(weight_from);
+    const __m512i prev_edge_from_lanes = _mm512_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m512i no_edge_lanes = _mm512_set1_epi32(-1);
+    for (size_t j = 0; j < count; j += 16) {
+        // хвост строки обрабатывается той же итерацией с маской загрузки
+        const bool is_full = count - j >= 16;
+        const __mmask16 lanes = is_full ? static_cast<__mmask16>(0xFFFF)
+                                        : static_cast<__mmask16>((1u << (count - j)) - 1);
+        const __m512 weights_through_lanes = is_full ? _mm512_loadu_ps(weights_through + j)
+                                                     : _mm512_maskz_loadu_ps(lanes, weights_through + j);
+        const __m512 current = is_full ? _mm512_loadu_ps(weights + j) : _mm512_maskz_loadu_ps(lanes, weights + j);
+        const __m512 candidate = _mm512_add_ps(weight_from_lanes, weights_through_lanes);
+        const __mmask16 improved = _mm512_mask_cmp_ps_mask(lanes, candidate, current, _CMP_LT_OQ);
+        if (improved == 0) {
+            continue;
+        }
+        _mm512_mask_storeu_ps(weights + j, improved, candidate);
+        const __m512i prev_edges_through_lanes = _mm512_maskz_loadu_epi32(improved, prev_edges_through + j);
+        const __m512i new_prev_edges = _mm512_mask_blend_epi32(
+                _mm512_cmpeq_epi32_mask(prev_edges_through_lanes, no_edge_lanes),
+                prev_edges_through_lanes, prev_edge_from_lanes);
+        _mm512_mask_storeu_epi32(prev_edges + j, improved, new_prev_edges);
+    }
+}
+#endif
+
+RelaxRowFunction GetKernelFunction(MinPlusKernel kernel) {
+#ifdef MIN_PLUS_X86
+    switch (kernel) {
+    case MinPlusKernel::AVX512:
+        return RelaxRowAvx512;
+    case MinPlusKernel::AVX2:
+        return RelaxRowAvx2;
+    case MinPlusKernel::SCALAR:
+        break;
+    }
+#else
+    (void)kernel;
+#endif
+    return RelaxRowScalar;
+}
+
+MinPlusKernel DetectKernel() {
+    if (IsMinPlusKernelSupported(MinPlusKernel::AVX512)) {
+        return MinPlusKernel::AVX512;
+    }
+    if (IsMinPlusKernelSupported(MinPlusKernel::AVX2)) {
+        return MinPlusKernel::AVX2;
+    }
+    return MinPlusKernel::SCALAR;
+}
+/**
+ * Выбранное ядро; определяется при первом обращении
+ */
+std::atomic<MinPlusKernel>& GetSelectedKernel() {
+    static std::atomic<MinPlusKernel> kernel{DetectKernel()};
+    return kernel;
+}
+
+}  // namespace
+
+void RelaxMinPlusRow(float weight_from, uint32_t prev_edge_from,
+                     const float* weights_through, const uint32_t* prev_edges_through,
+                     float* weights, uint32_t* prev_edges, size_t count) {
+    GetKernelFunction(GetSelectedKernel().load(std::memory_order_relaxed))(
+            weight_from, prev_edge_from, weights_through, prev_edges_through, weights, prev_edges, count);
+}
+
+MinPlusKernel GetMinPlusKernel() {
+    return GetSelectedKernel().load();
+}
+
+bool IsMinPlusKernelSupported(MinPlusKernel kernel) {
+    switch (kernel) {
+    case MinPlusKernel::SCALAR:
+        return true;
+#ifdef MIN_PLUS_X86
+    case MinPlusKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case MinPlusKernel::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+bool SetMinPlusKernel(MinPlusKernel kernel) {
+    if (!IsMinPlusKernelSupported(kernel)) {
+        return false;
+    }
+    GetSelectedKernel().store(kernel);
+    return true;
+}
+
+}  // namespace graph
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace graph {
+/**
+ * Набор инструкций ядра релаксации строки min-plus
+ */
+enum class MinPlusKernel {
+    /**
+     * Скалярный цикл
+     */
+    SCALAR = 0,
+    /**
+     * AVX2: 8 весов float за итерацию
+     */
+    AVX2,
+    /**
+     * AVX-512: 16 весов float за итерацию, обновление по маске
+     */
+    AVX512
+};
+/**
+ * Релаксация строки таблицы маршрутов через вершину:
+ * weights[j] = min(weights[j], weight_from + weights_through[j]).
+ * Если вес улучшен, последним ребром становится prev_edges_through[j],
+ * а при его отсутствии (no_edge) — prev_edge_from.
+ * Отсутствующий маршрут имеет бесконечный вес, поэтому проверки не нужны.
+ * Скалярный вариант для любых типов весов.
+ */
+template <typename StoredWeight>
+void RelaxMinPlusRow(StoredWeight weight_from, uint32_t prev_edge_from,
+                     const StoredWeight* weights_through, const uint32_t* prev_edges_through,
+                     StoredWeight* weights, uint32_t* prev_edges, size_t count) {
+    constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+    for (size_t j = 0; j < count; ++j) {
+        const StoredWeight candidate_weight = weight_from + weights_through[j];
+        if (candidate_weight < weights[j]) {
+            weights[j] = candidate_weight;
+            prev_edges[j] = prev_edges_through[j] != NO_EDGE ? prev_edges_through[j] : prev_edge_from;
+        }
+    }
+}
+/**
+ * Релаксация строки весов float векторным ядром, выбранным по возможностям процессора
+ * при первом вызове (AVX-512, AVX2 или скалярный цикл).
+ * Отсутствие последнего ребра кодируется значением uint32_t(-1).
+ */
+void RelaxMinPlusRow(float weight_from, uint32_t prev_edge_from,
+                     const float* weights_through, const uint32_t* prev_edges_through,
+                     float* weights, uint32_t* prev_edges, size_t count);
+/**
+ * Используемое ядро релаксации строк float
+ */
+MinPlusKernel GetMinPlusKernel();
+/**
+ * Поддерживается ли ядро процессором
+ */
+bool IsMinPlusKernelSupported(MinPlusKernel kernel);
+/**
+ * Выбрать ядро релаксации строк float (например, для сравнения производительности).
+ * Возвращает false, если ядро не поддерживается процессором.
+ */
+bool SetMinPlusKernel(MinPlusKernel kernel);
+
+}  // namespace graph
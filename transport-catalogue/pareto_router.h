@@ -0,0 +1,201 @@
+#pragma once
+
+#include "closures.h"
+#include "graph.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace graph {
+/**
+ * Поиск множества Парето путей по двум критериям: весу и количеству
+ * учитываемых рёбер (например, посадок). Путь входит в множество, если нет пути
+ * не тяжелее и не более чем с тем же количеством учитываемых рёбер, лучшего хотя бы
+ * по одному критерию.
+ *
+ * Поиск с постоянными метками: метки извлекаются из очереди по возрастанию веса,
+ * а при равном весе — по возрастанию количества, поэтому извлечённая метка
+ * недоминируема тогда и только тогда, когда её количество меньше, чем у всех
+ * ранее извлечённых меток той же вершины. Для отсечения достаточно хранить
+ * минимальное количество на вершину; новые метки отсекаются и по нему,
+ * и по меткам целевой вершины.
+ *
+ * Метки хранятся в общем массиве рабочей области и ссылаются на родителя индексом,
+ * поэтому второй критерий не добавляет выделений памяти на вершину.
+ */
+template <typename Weight>
+class ParetoRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    /**
+     * Путь из множества Парето
+     */
+    struct ParetoRoute {
+        Weight weight;
+        /**
+         * Количество учитываемых рёбер пути
+         */
+        size_t count;
+        std::vector<EdgeId> edges;
+    };
+
+    explicit ParetoRouter(const Graph& graph)
+        : graph_(graph) {
+    }
+    /**
+     * Множество Парето путей из from в to по возрастанию веса (и убыванию количества).
+     * is_counted(edge_id) — учитывается ли ребро во втором критерии;
+     * max_count ограничивает количество учитываемых рёбер пути;
+     * закрытые вершины и рёбра (closures) поиск обходит.
+     */
+    template <typename IsCountedEdge>
+    std::vector<ParetoRoute> BuildRoutes(VertexId from, VertexId to, IsCountedEdge is_counted,
+                                         std::optional<size_t> max_count = std::nullopt,
+                                         const Closures* closures = nullptr) const;
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr uint32_t NO_LABEL = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NO_COUNT = std::numeric_limits<uint32_t>::max();
+    /**
+     * Метка пути до вершины
+     */
+    struct Label {
+        Weight weight;
+        uint32_t count;
+        /**
+         * Метка пути до предыдущей вершины и ребро из неё
+         */
+        uint32_t parent;
+        VertexId vertex;
+        EdgeId edge;
+    };
+    /**
+     * Элемент очереди: вес, количество и индекс метки
+     */
+    using QueueItem = std::tuple<Weight, uint32_t, uint32_t>;
+    /**
+     * Рабочая область одного запроса
+     */
+    struct Workspace {
+        std::vector<Label> labels;
+        /**
+         * Двоичная куча с минимумом в начале
+         */
+        std::vector<QueueItem> queue;
+        /**
+         * Минимальное количество среди извлечённых меток вершины
+         */
+        std::vector<uint32_t> min_counts;
+        std::vector<uint32_t> generations;
+        uint32_t generation = 0;
+
+        void Reset(size_t vertex_count) {
+            labels.clear();
+            queue.clear();
+            if (generations.size() != vertex_count) {
+                min_counts.assign(vertex_count, NO_COUNT);
+                generations.assign(vertex_count, 0);
+                generation = 0;
+            }
+            if (++generation == 0) {
+                std::fill(generations.begin(), generations.end(), 0);
+                generation = 1;
+            }
+        }
+
+        uint32_t GetMinCount(VertexId vertex) const {
+            return generations[vertex] == generation ? min_counts[vertex] : NO_COUNT;
+        }
+
+        void SetMinCount(VertexId vertex, uint32_t count) {
+            min_counts[vertex] = count;
+            generations[vertex] = generation;
+        }
+    };
+
+    const Graph& graph_;
+    WorkspacePool<Workspace> workspaces_;
+};
+
+template <typename Weight>
+template <typename IsCountedEdge>
+std::vector<typename ParetoRouter<Weight>::ParetoRoute> ParetoRouter<Weight>::BuildRoutes(
+        VertexId from, VertexId to, IsCountedEdge is_counted, std::optional<size_t> max_count,
+        const Closures* closures) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const uint32_t count_limit = max_count ? static_cast<uint32_t>(std::min<size_t>(*max_count, NO_COUNT - 1))
+                                           : NO_COUNT - 1;
+    auto workspace = workspaces_.Acquire();
+    workspace->Reset(graph_.GetVertexCount());
+    auto& labels = workspace->labels;
+    auto& queue = workspace->queue;
+    const auto push = [&labels, &queue](Weight weight, uint32_t count, uint32_t parent, VertexId vertex,
+                                        EdgeId edge) {
+        labels.push_back({weight, count, parent, vertex, edge});
+        queue.emplace_back(weight, count, static_cast<uint32_t>(labels.size() - 1));
+        std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>());
+    };
+
+    std::vector<uint32_t> target_labels;
+    if (closures != nullptr && (closures->IsVertexClosed(from) || closures->IsVertexClosed(to))) {
+        return {};
+    }
+    push(ZERO_WEIGHT, 0, NO_LABEL, from, 0);
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>());
+        const auto [weight, count, label_index] = queue.back();
+        queue.pop_back();
+        const VertexId vertex = labels[label_index].vertex;
+        // у извлечённых раньше меток вес не больше
+        if (count >= workspace->GetMinCount(vertex)) {
+            continue;
+        }
+        workspace->SetMinCount(vertex, count);
+        if (vertex == to) {
+            target_labels.push_back(label_index);
+            if (count == 0) {
+                break;
+            }
+            continue;
+        }
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            if (closures != nullptr && !closures->IsEdgeOpen(graph_, edge_id)) {
+                continue;
+            }
+            const VertexId edge_to = graph_.GetEdgeTarget(edge_id);
+            const uint32_t next_count = count + (is_counted(edge_id) ? 1 : 0);
+            if (next_count > count_limit || next_count >= workspace->GetMinCount(edge_to)
+                || next_count >= workspace->GetMinCount(to)) {
+                continue;
+            }
+            push(weight + graph_.GetEdgeWeight(edge_id), next_count, label_index, edge_to, edge_id);
+        }
+    }
+
+    std::vector<ParetoRoute> routes;
+    routes.reserve(target_labels.size());
+    for (const uint32_t label_index : target_labels) {
+        const Label& target_label = labels[label_index];
+        ParetoRoute route{target_label.weight, target_label.count, {}};
+        for (uint32_t index = label_index; labels[index].parent != NO_LABEL; index = labels[index].parent) {
+            route.edges.push_back(labels[index].edge);
+        }
+        std::reverse(route.edges.begin(), route.edges.end());
+        routes.push_back(std::move(route));
+    }
+    return routes;
+}
+
+}  // namespace graph
@@ -0,0 +1,228 @@
+#include "raptor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace transit {
+
+RaptorRouter::RaptorRouter(size_t stop_count, const std::vector<TransitRoute>& routes, double frequency_wait_time)
+    : stop_count_(stop_count)
+    , frequency_wait_time_(frequency_wait_time)
+    , stop_route_offsets_(stop_count + 1, 0)
+{
+    route_offsets_.reserve(routes.size() + 1);
+    departure_offsets_.reserve(routes.size() + 1);
+    route_offsets_.push_back(0);
+    departure_offsets_.push_back(0);
+    for (const auto& route : routes) {
+        if (route.ride_times.size() != route.stops.size()) {
+            throw std::invalid_argument("Ride times should be given for every stop of a route");
+        }
+        for (const StopIndex stop : route.stops) {
+            if (stop >= stop_count_) {
+                throw std::out_of_range("Stop index is out of range");
+            }
+            ++stop_route_offsets_[stop + 1];
+        }
+        route_stops_.insert(route_stops_.end(), route.stops.begin(), route.stops.end());
+        ride_times_.insert(ride_times_.end(), route.ride_times.begin(), route.ride_times.end());
+        route_offsets_.push_back(route_stops_.size());
+        const auto first_departure = departures_.insert(departures_.end(), route.departures.begin(),
+                                                        route.departures.end());
+        std::sort(first_departure, departures_.end());
+        departure_offsets_.push_back(departures_.size());
+    }
+    for (StopIndex stop = 0; stop < stop_count_; ++stop) {
+        stop_route_offsets_[stop + 1] += stop_route_offsets_[stop];
+    }
+    stop_routes_.resize(stop_route_offsets_.back());
+    std::vector<size_t> positions(stop_route_offsets_.begin(), std::prev(stop_route_offsets_.end()));
+    for (size_t route = 0; route < routes.size(); ++route) {
+        for (size_t position = 0; position < routes[route].stops.size(); ++position) {
+            stop_routes_[positions[routes[route].stops[position]]++] = {route, position};
+        }
+    }
+}
+
+std::optional<RaptorRouter::Journey> RaptorRouter::BuildJourney(StopIndex from, StopIndex to,
+                                                                double departure_time) const {
+    if (to >= stop_count_) {
+        throw std::out_of_range("Stop index is out of range");
+    }
+    auto workspace = workspaces_.Acquire();
+    const size_t last_round = Search(*workspace, from, to, departure_time);
+    const Label& label = workspace->rounds[last_round][to];
+    if (label.arrival_time == NO_TIME) {
+        return std::nullopt;
+    }
+    return MakeJourney(*workspace, label);
+}
+
+std::vector<RaptorRouter::Journey> RaptorRouter::BuildParetoJourneys(StopIndex from, StopIndex to,
+                                                                     double departure_time) const {
+    if (to >= stop_count_) {
+        throw std::out_of_range("Stop index is out of range");
+    }
+    auto workspace = workspaces_.Acquire();
+    const size_t last_round = Search(*workspace, from, to, departure_time);
+    // метки раундов копируются в следующие раунды, поэтому метка раунда k —
+    // лучшее прибытие не более чем с k поездками
+    std::vector<Journey> journeys;
+    double best_arrival = NO_TIME;
+    for (size_t round = 0; round <= last_round; ++round) {
+        const Label& label = workspace->rounds[round][to];
+        if (label.arrival_time < best_arrival) {
+            best_arrival = label.arrival_time;
+            journeys.push_back(MakeJourney(*workspace, label));
+        }
+    }
+    std::reverse(journeys.begin(), journeys.end());
+    return journeys;
+}
+
+std::vector<std::optional<double>> RaptorRouter::BuildArrivalTimes(StopIndex from, double departure_time) const {
+    auto workspace = workspaces_.Acquire();
+    Search(*workspace, from, std::nullopt, departure_time);
+    std::vector<std::optional<double>> arrival_times(stop_count_);
+    for (StopIndex stop = 0; stop < stop_count_; ++stop) {
+        if (workspace->best_arrivals[stop] != NO_TIME) {
+            arrival_times[stop] = workspace->best_arrivals[stop];
+        }
+    }
+    return arrival_times;
+}
+
+StopIndex RaptorRouter::GetStop(size_t route, size_t position) const {
+    return route_stops_[route_offsets_[route] + position];
+}
+
+RaptorRouter::Journey RaptorRouter::MakeJourney(const Workspace& workspace, const Label& target_label) const {
+    const Label* label = &target_label;
+    Journey journey{label->arrival_time, {}};
+    // метка остановки посадки берётся из раунда, предшествующего поездке
+    while (label->route != NO_ROUTE) {
+        const StopIndex board_stop = GetStop(label->route, label->board_position);
+        const Label& board_label = workspace.rounds[label->round - 1][board_stop];
+        journey.legs.push_back({label->route, label->board_position, label->alight_position,
+                                label->board_time - board_label.arrival_time,
+                                label->board_time, label->arrival_time});
+        label = &board_label;
+    }
+    std::reverse(journey.legs.begin(), journey.legs.end());
+    return journey;
+}
+
+size_t RaptorRouter::Search(Workspace& workspace, StopIndex from, std::optional<StopIndex> to,
+                            double departure_time) const {
+    if (from >= stop_count_) {
+        throw std::out_of_range("Stop index is out of range");
+    }
+    const size_t route_count = route_offsets_.size() - 1;
+    workspace.best_arrivals.assign(stop_count_, NO_TIME);
+    workspace.marked.assign(stop_count_, 0);
+    workspace.marked_stops.clear();
+    workspace.queued_positions.assign(route_count, NO_ROUTE);
+    workspace.queued_routes.clear();
+    if (workspace.rounds.empty()) {
+        workspace.rounds.emplace_back();
+    }
+    workspace.rounds[0].assign(stop_count_, Label{});
+    workspace.rounds[0][from].arrival_time = departure_time;
+    workspace.best_arrivals[from] = departure_time;
+    workspace.marked[from] = 1;
+    workspace.marked_stops.push_back(from);
+
+    size_t round = 0;
+    while (!workspace.marked_stops.empty()) {
+        ++round;
+        if (workspace.rounds.size() <= round) {
+            workspace.rounds.emplace_back();
+        }
+        workspace.rounds[round] = workspace.rounds[round - 1];
+        // в очередь попадают маршруты улучшенных остановок с самой ранней их позицией
+        for (const StopIndex stop : workspace.marked_stops) {
+            workspace.marked[stop] = 0;
+            for (size_t i = stop_route_offsets_[stop]; i < stop_route_offsets_[stop + 1]; ++i) {
+                const auto [route, position] = stop_routes_[i];
+                auto& queued_position = workspace.queued_positions[route];
+                if (queued_position == NO_ROUTE) {
+                    workspace.queued_routes.push_back(route);
+                    queued_position = position;
+                }
+                else {
+                    queued_position = std::min(queued_position, position);
+                }
+            }
+        }
+        workspace.marked_stops.clear();
+        for (const size_t route : workspace.queued_routes) {
+            ScanRoute(workspace, route, workspace.queued_positions[route], round, to);
+            workspace.queued_positions[route] = NO_ROUTE;
+        }
+        workspace.queued_routes.clear();
+    }
+    return round;
+}
+
+void RaptorRouter::ScanRoute(Workspace& workspace, size_t route, size_t first_position, size_t round,
+                             std::optional<StopIndex> to) const {
+    const auto& previous_labels = workspace.rounds[round - 1];
+    auto& labels = workspace.rounds[round];
+    auto& best_arrivals = workspace.best_arrivals;
+    const size_t route_begin = route_offsets_[route];
+    const size_t route_end = route_offsets_[route + 1];
+    const auto departures_begin = departures_.begin() + departure_offsets_[route];
+    const auto departures_end = departures_.begin() + departure_offsets_[route + 1];
+    const bool has_timetable = departures_begin != departures_end;
+
+    // рейс, на котором едет пассажир: время его отправления от первой остановки
+    double trip_departure = NO_TIME;
+    size_t board_position = 0;
+    double board_time = NO_TIME;
+    for (size_t index = route_begin + first_position; index < route_end; ++index) {
+        const StopIndex stop = route_stops_[index];
+        const double ride_time = ride_times_[index];
+        if (trip_departure != NO_TIME) {
+            // время от отправления рейса, а не от посадки: прибытие одного рейса не зависит от остановки посадки
+            const double arrival_time = trip_departure + ride_time;
+            const double bound = to ? std::min(best_arrivals[stop], best_arrivals[*to]) : best_arrivals[stop];
+            if (arrival_time < bound) {
+                labels[stop] = {arrival_time, round, route, board_position, index - route_begin, board_time};
+                best_arrivals[stop] = arrival_time;
+                if (!workspace.marked[stop]) {
+                    workspace.marked[stop] = 1;
+                    workspace.marked_stops.push_back(stop);
+                }
+            }
+        }
+        // можно ли здесь сесть на более ранний рейс
+        const double stop_arrival = previous_labels[stop].arrival_time;
+        if (stop_arrival == NO_TIME) {
+            continue;
+        }
+        double candidate_departure;
+        double candidate_board_time;
+        if (has_timetable) {
+            const auto departure = std::partition_point(departures_begin, departures_end,
+                                                        [ride_time, stop_arrival](double trip) {
+                                                            return trip + ride_time < stop_arrival;
+                                                        });
+            if (departure == departures_end) {
+                continue;
+            }
+            candidate_departure = *departure;
+            candidate_board_time = *departure + ride_time;
+        }
+        else {
+            candidate_board_time = stop_arrival + frequency_wait_time_;
+            candidate_departure = candidate_board_time - ride_time;
+        }
+        if (candidate_departure < trip_departure) {
+            trip_departure = candidate_departure;
+            board_position = index - route_begin;
+            board_time = candidate_board_time;
+        }
+    }
+}
+
+}  // namespace transit
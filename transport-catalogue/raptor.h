@@ -0,0 +1,168 @@
+#pragma once
+
+#include "search_workspace.h"
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+/**
+ * Маршрутизация по расписанию
+ */
+namespace transit {
+
+using StopIndex = size_t;
+/**
+ * Маршрут общественного транспорта для RAPTOR
+ */
+struct TransitRoute {
+    /**
+     * Остановки в порядке следования
+     */
+    std::vector<StopIndex> stops;
+    /**
+     * Время в пути от первой остановки до каждой остановки маршрута, в минутах
+     */
+    std::vector<double> ride_times;
+    /**
+     * Время отправления рейсов от первой остановки, в минутах от начала суток.
+     * Пустой список — маршрут без расписания: автобус приходит через
+     * фиксированное время ожидания после прибытия пассажира на остановку.
+     */
+    std::vector<double> departures;
+};
+/**
+ * Поиск маршрута с самым ранним прибытием алгоритмом RAPTOR (Round-bAsed Public
+ * Transit Optimized Router). Раунд k находит лучшие времена прибытия не более чем
+ * с k поездками: каждый маршрут, проходящий через остановку, улучшенную в прошлом
+ * раунде, просматривается линейно с самой ранней такой остановки, с посадкой
+ * на самый ранний успевающий рейс. Данные маршрутов хранятся в плотных массивах,
+ * очередь с приоритетом не используется.
+ * Запрос O(раунды * суммарная длина просматриваемых маршрутов).
+ */
+class RaptorRouter {
+public:
+    /**
+     * Поездка на одном маршруте
+     */
+    struct Leg {
+        size_t route;
+        size_t board_position;
+        size_t alight_position;
+        /**
+         * Время ожидания на остановке посадки
+         */
+        double wait_time;
+        /**
+         * Время отправления с остановки посадки
+         */
+        double board_time;
+        /**
+         * Время прибытия на остановку высадки
+         */
+        double arrival_time;
+    };
+    /**
+     * Найденный путь: время прибытия и поездки в порядке следования
+     */
+    struct Journey {
+        double arrival_time;
+        std::vector<Leg> legs;
+    };
+    /**
+     * Конструктор.
+     * frequency_wait_time — время ожидания на маршрутах без расписания.
+     */
+    RaptorRouter(size_t stop_count, const std::vector<TransitRoute>& routes, double frequency_wait_time);
+    /**
+     * Путь с самым ранним прибытием из from в to при отправлении в departure_time
+     */
+    std::optional<Journey> BuildJourney(StopIndex from, StopIndex to, double departure_time) const;
+    /**
+     * Пути, оптимальные по Парето по времени прибытия и количеству поездок:
+     * по возрастанию времени прибытия и убыванию количества поездок
+     */
+    std::vector<Journey> BuildParetoJourneys(StopIndex from, StopIndex to, double departure_time) const;
+    /**
+     * Самые ранние времена прибытия на все остановки (nullopt — недостижима)
+     */
+    std::vector<std::optional<double>> BuildArrivalTimes(StopIndex from, double departure_time) const;
+    /**
+     * Остановка маршрута в заданной позиции
+     */
+    StopIndex GetStop(size_t route, size_t position) const;
+
+private:
+    static constexpr double NO_TIME = std::numeric_limits<double>::infinity();
+    static constexpr size_t NO_ROUTE = std::numeric_limits<size_t>::max();
+    /**
+     * Лучшее прибытие на остановку не более чем за заданное число поездок
+     */
+    struct Label {
+        double arrival_time = NO_TIME;
+        /**
+         * Раунд, в котором найдено прибытие; 0 — остановка отправления
+         */
+        size_t round = 0;
+        size_t route = NO_ROUTE;
+        size_t board_position = 0;
+        size_t alight_position = 0;
+        double board_time = NO_TIME;
+    };
+    /**
+     * Рабочая область одного запроса
+     */
+    struct Workspace {
+        /**
+         * Метки остановок по раундам
+         */
+        std::vector<std::vector<Label>> rounds;
+        std::vector<double> best_arrivals;
+        std::vector<char> marked;
+        std::vector<StopIndex> marked_stops;
+        /**
+         * Самая ранняя позиция улучшенной остановки для каждого маршрута в очереди
+         */
+        std::vector<size_t> queued_positions;
+        std::vector<size_t> queued_routes;
+    };
+    /**
+     * Выполнить раунды поиска; to ограничивает поиск временем прибытия на остановку.
+     * Возвращает количество выполненных раундов.
+     */
+    size_t Search(Workspace& workspace, StopIndex from, std::optional<StopIndex> to, double departure_time) const;
+    /**
+     * Восстановить путь до метки по меткам предыдущих раундов
+     */
+    Journey MakeJourney(const Workspace& workspace, const Label& target_label) const;
+    /**
+     * Просмотреть маршрут с позиции first_position в раунде round
+     */
+    void ScanRoute(Workspace& workspace, size_t route, size_t first_position, size_t round,
+                   std::optional<StopIndex> to) const;
+
+    size_t stop_count_;
+    double frequency_wait_time_;
+    /**
+     * Остановки и время в пути всех маршрутов подряд; маршрут r занимает
+     * позиции [route_offsets_[r], route_offsets_[r + 1])
+     */
+    std::vector<size_t> route_offsets_;
+    std::vector<StopIndex> route_stops_;
+    std::vector<double> ride_times_;
+    /**
+     * Отправления всех маршрутов подряд по возрастанию; маршрут r занимает
+     * позиции [departure_offsets_[r], departure_offsets_[r + 1])
+     */
+    std::vector<size_t> departure_offsets_;
+    std::vector<double> departures_;
+    /**
+     * Маршруты остановки и позиции остановки на них в сжатых строках
+     */
+    std::vector<size_t> stop_route_offsets_;
+    std::vector<std::pair<size_t, size_t>> stop_routes_;
+    graph::WorkspacePool<Workspace> workspaces_;
+};
+
+}  // namespace transit
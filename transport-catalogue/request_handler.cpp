@@ -28,6 +28,12 @@ void RequestHandler::AddRoute(std::string_view bus_number,
     }
     db_.AddRoute(bus_number, std::move(route_stops), is_roundtrip);
 }
+/**
+ * Задать расписание маршрута
+ */
+void RequestHandler::SetDepartures(std::string_view bus_number, std::vector<double> departures) {
+    db_.SetDepartures(bus_number, std::move(departures));
+}
 /**
  * Установить расстояние между двумя остановками
  */
@@ -90,13 +96,115 @@ void RequestHandler::RenderMap(std::ostream& output) const {
 /**
  * Получить информацию об оптимальном маршруте между остановками
  */
-const std::optional<transport::RouterResponse> RequestHandler::GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to) const {
+const std::optional<transport::RouterResponse> RequestHandler::GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to,
+                                                                               double departure_time) const {
+    const auto from = db_.FindStop(stop_from);
+    const auto to = db_.FindStop(stop_to);
+    if (to == nullptr || from == nullptr) {
+        return std::nullopt;
+    }
+    return router_.GetOptimalRoute(from, to, departure_time);
+}
+/**
+ * Получить оптимальные маршруты для пакета запросов
+ */
+std::vector<std::optional<transport::RouterResponse>>
+RequestHandler::GetOptimalRoutesBatch(const std::vector<RouteQuery>& queries) const {
+    // маршрутизатору передаются только запросы между известными остановками
+    std::vector<transport::RouteRequest> requests;
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto from = db_.FindStop(queries[i].stop_from);
+        const auto to = db_.FindStop(queries[i].stop_to);
+        if (from != nullptr && to != nullptr) {
+            requests.push_back({from, to, queries[i].departure_time});
+            positions.push_back(i);
+        }
+    }
+    auto responses = router_.GetOptimalRoutesBatch(requests);
+    std::vector<std::optional<transport::RouterResponse>> results(queries.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[positions[i]] = std::move(responses[i]);
+    }
+    return results;
+}
+/**
+ * Получить до k альтернативных маршрутов между остановками
+ */
+std::vector<transport::RouterResponse>
+RequestHandler::GetOptimalRoutes(const std::string_view stop_from, const std::string_view stop_to, size_t k,
+                                 double departure_time) const {
+    const auto from = db_.FindStop(stop_from);
+    const auto to = db_.FindStop(stop_to);
+    if (to == nullptr || from == nullptr) {
+        return {};
+    }
+    return router_.GetOptimalRoutes(from, to, k, departure_time);
+}
+/**
+ * Получить маршруты, оптимальные по Парето по времени и числу пересадок
+ */
+std::vector<transport::ParetoRouterResponse>
+RequestHandler::GetParetoRoutes(const std::string_view stop_from, const std::string_view stop_to,
+                                std::optional<size_t> max_transfers, double departure_time) const {
     const auto from = db_.FindStop(stop_from);
     const auto to = db_.FindStop(stop_to);
     if (to == nullptr || from == nullptr) {
+        return {};
+    }
+    return router_.GetParetoRoutes(from, to, max_transfers, departure_time);
+}
+/**
+ * Получить матрицу времени поездки между остановками
+ */
+std::vector<std::vector<std::optional<double>>>
+RequestHandler::GetTravelTimes(const std::vector<std::string_view>& stops_from,
+                               const std::vector<std::string_view>& stops_to,
+                               double departure_time) const {
+    // в маршрутизатор передаются только известные остановки,
+    // positions — их позиции в исходных списках
+    const auto find_stops = [this](const std::vector<std::string_view>& stop_names,
+                                   std::vector<const transport::Stop*>& stops,
+                                   std::vector<size_t>& positions) {
+        for (size_t i = 0; i < stop_names.size(); ++i) {
+            if (const transport::Stop* stop = db_.FindStop(stop_names[i])) {
+                stops.push_back(stop);
+                positions.push_back(i);
+            }
+        }
+    };
+    std::vector<const transport::Stop*> from, to;
+    std::vector<size_t> rows, columns;
+    find_stops(stops_from, from, rows);
+    find_stops(stops_to, to, columns);
+    auto known_times = router_.GetTravelTimes(from, to, departure_time);
+
+    std::vector<std::vector<std::optional<double>>> times(stops_from.size());
+    for (auto& row_times : times) {
+        row_times.resize(stops_to.size());
+    }
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (columns.size() == stops_to.size()) {
+            times[rows[i]] = std::move(known_times[i]);
+            continue;
+        }
+        for (size_t j = 0; j < columns.size(); ++j) {
+            times[rows[i]][columns[j]] = known_times[i][j];
+        }
+    }
+    return times;
+}
+/**
+ * Получить остановки, достижимые за ограниченное время
+ */
+std::optional<std::vector<transport::ReachableStop>>
+RequestHandler::GetReachableStops(std::string_view stop_name, double max_time, bool reverse,
+                                  double departure_time) const {
+    const transport::Stop* stop = db_.FindStop(stop_name);
+    if (stop == nullptr) {
         return std::nullopt;
     }
-    return router_.GetOptimalRoute(from, to);
+    return router_.GetReachableStops(stop, max_time, reverse, departure_time);
 }
 /**
  * Обновить данные агрегированных объектов
@@ -108,3 +216,51 @@ void RequestHandler::UpdateInternalData() {
     renderer_.SetBuses(sorted_buses).SetStops(sorted_stops);
     router_.Build(db_);
 }
+/**
+ * Заменить маршрут в каталоге или добавить новый.
+ * Маршрутизатор обновляется при вызове ApplyUpdates.
+ */
+bool RequestHandler::UpdateRoute(std::string_view bus_number,
+                                 const std::vector<std::string_view>& stop_names,
+                                 bool is_roundtrip) {
+    if (bus_number.empty() || stop_names.empty()) return false;
+    std::vector<const transport::Stop*> route_stops;
+    route_stops.reserve(stop_names.size());
+    for (const auto stop_name : stop_names) {
+        const transport::Stop* stop = db_.FindStop(stop_name);
+        // без неизвестной остановки маршрут соединил бы несоседние остановки
+        if (stop == nullptr) return false;
+        route_stops.push_back(stop);
+    }
+    db_.UpdateRoute(bus_number, route_stops, is_roundtrip);
+    pending_update_.buses.push_back(db_.FindRoute(bus_number));
+    return true;
+}
+/**
+ * Изменить расстояние между двумя остановками.
+ * Маршрутизатор обновляется при вызове ApplyUpdates.
+ */
+bool RequestHandler::UpdateDistance(std::string_view from,
+                                    std::string_view to,
+                                    int distance) {
+    auto stop_from = db_.FindStop(from);
+    auto stop_to = db_.FindStop(to);
+    if (stop_from == nullptr || stop_to == nullptr) return false;
+    db_.SetDistance(stop_from, stop_to, distance);
+    pending_update_.distances.emplace_back(stop_from, stop_to);
+    return true;
+}
+/**
+ * Применить накопленные изменения каталога без полной пересборки маршрутизатора
+ */
+void RequestHandler::ApplyUpdates() {
+    renderer_.SetBuses(db_.GetBuses()).SetStops(db_.GetStops());
+    router_.Update(db_, pending_update_);
+    pending_update_ = {};
+}
+/**
+ * Транспортный справочник
+ */
+const transport::Catalogue& RequestHandler::GetCatalogue() const {
+    return db_;
+}
@@ -5,6 +5,14 @@
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+/**
+ * Запрос оптимального маршрута между остановками по названиям
+ */
+struct RouteQuery {
+    std::string_view stop_from;
+    std::string_view stop_to;
+    double departure_time = 0.0;
+};
 /**
  * Класс-фасад, упрощающий взаимодействие JSON reader-а
  * с другими подсистемами приложения.
@@ -26,6 +34,10 @@ public:
     void AddRoute(std::string_view bus_number,
                   const std::vector<std::string_view>& stop_names,
                   bool is_roundtrip);
+    /**
+     * Задать расписание маршрута: время отправления рейсов от первой остановки, в минутах
+     */
+    void SetDepartures(std::string_view bus_number, std::vector<double> departures);
     /**
      * Установить расстояние между двумя остановками
      */
@@ -45,18 +57,82 @@ public:
      */
     void RenderMap(std::ostream &output) const;
     /**
-     * Получить информацию об оптимальном маршруте между остановками
+     * Получить информацию об оптимальном маршруте между остановками.
+     * Время отправления учитывается при маршрутизации по расписанию.
      */
     const std::optional<transport::RouterResponse>
-    GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to) const;
+    GetOptimalRoute(const std::string_view stop_from, const std::string_view stop_to,
+                    double departure_time = 0.0) const;
+    /**
+     * Получить оптимальные маршруты для пакета запросов, в порядке запросов.
+     * Запросы выполняются параллельно; для неизвестных остановок маршрута нет.
+     */
+    std::vector<std::optional<transport::RouterResponse>>
+    GetOptimalRoutesBatch(const std::vector<RouteQuery>& queries) const;
+    /**
+     * Получить до k альтернативных маршрутов между остановками по возрастанию времени
+     */
+    std::vector<transport::RouterResponse>
+    GetOptimalRoutes(const std::string_view stop_from, const std::string_view stop_to, size_t k,
+                     double departure_time = 0.0) const;
+    /**
+     * Получить маршруты, оптимальные по Парето по времени и числу пересадок
+     */
+    std::vector<transport::ParetoRouterResponse>
+    GetParetoRoutes(const std::string_view stop_from, const std::string_view stop_to,
+                    std::optional<size_t> max_transfers = std::nullopt, double departure_time = 0.0) const;
+    /**
+     * Получить матрицу времени поездки между остановками.
+     * Для неизвестных остановок и пар без маршрута значение отсутствует.
+     */
+    std::vector<std::vector<std::optional<double>>>
+    GetTravelTimes(const std::vector<std::string_view>& stops_from,
+                   const std::vector<std::string_view>& stops_to,
+                   double departure_time = 0.0) const;
+    /**
+     * Получить остановки, достижимые из остановки (при reverse — из которых достижима
+     * остановка) не более чем за max_time минут. nullopt — остановка неизвестна.
+     */
+    std::optional<std::vector<transport::ReachableStop>>
+    GetReachableStops(std::string_view stop_name, double max_time, bool reverse,
+                      double departure_time = 0.0) const;
     /**
      * Обновить данные агрегированных объектов
      */
     void UpdateInternalData();
+    /**
+     * Заменить маршрут в каталоге или добавить новый.
+     * Маршрутизатор обновляется при вызове ApplyUpdates.
+     * Возвращает false и не меняет каталог, если номер или список остановок пуст
+     * или хотя бы одна остановка неизвестна.
+     */
+    bool UpdateRoute(std::string_view bus_number,
+                     const std::vector<std::string_view>& stop_names,
+                     bool is_roundtrip);
+    /**
+     * Изменить расстояние между двумя остановками.
+     * Маршрутизатор обновляется при вызове ApplyUpdates.
+     * Возвращает false и не меняет каталог, если остановка неизвестна.
+     */
+    bool UpdateDistance(std::string_view from,
+                        std::string_view to,
+                        int distance);
+    /**
+     * Применить накопленные изменения каталога без полной пересборки маршрутизатора
+     */
+    void ApplyUpdates();
+    /**
+     * Транспортный справочник
+     */
+    const transport::Catalogue& GetCatalogue() const;
 private:
     // RequestHandler использует агрегацию объектов "Транспортный Справочник" и "Визуализатор Карты"
     transport::Catalogue db_;
     renderer::MapRenderer& renderer_;
     transport::Router& router_;
+    /**
+     * Изменения каталога, ещё не переданные маршрутизатору
+     */
+    transport::RouterUpdate pending_update_;
 };
 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "graph.h"
+#include "routing_engine.h"
+#include "routes_storage.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
@@ -13,78 +16,140 @@
 #include <vector>
 
 namespace graph {
-
-template <typename Weight>
-class Router {
+/**
+ * Маршрутизация с предрасчётом кратчайших путей между всеми парами вершин (Флойд–Уоршелл).
+ * Построение O(V^3), память O(V^2), запрос O(длины маршрута).
+ * Способ хранения таблицы маршрутов задаётся политикой Storage (см. routes_storage.h).
+ */
+template <typename Weight, typename Storage = OptionalRoutesStorage<Weight>>
+class Router final : public RoutingEngine<Weight> {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    using typename RoutingEngine<Weight>::RouteInfo;
 
-    struct RouteInfo {
-        Weight weight;
-        std::vector<EdgeId> edges;
-    };
+    /**
+     * Размер стороны блока матрицы маршрутов для блочного алгоритма
+     */
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64;
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    explicit Router(const Graph& graph);
+    /**
+     * Блочный (tiled) вариант Флойда–Уоршелла.
+     * Фазы каждого раунда (диагональный блок, блоки его строки и столбца, остальные блоки)
+     * выполняются параллельно на пуле потоков.
+     */
+    Router(const Graph& graph, parallel::ThreadPool& thread_pool,
+           size_t block_size = DEFAULT_BLOCK_SIZE);
+    /**
+     * Таблица предрассчитанных маршрутов
+     */
+    const Storage& GetRoutesStorage() const {
+        return routes_internal_data_;
+    }
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    /**
+     * Веса читаются из таблицы маршрутов
+     */
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override;
 
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
-
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+            routes_internal_data_.SetRoute(vertex, vertex, ZERO_WEIGHT, std::nullopt);
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
+                const VertexId edge_to = graph.GetEdgeTarget(edge_id);
+                const Weight edge_weight = graph.GetEdgeWeight(edge_id);
+                if (edge_weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                if (!routes_internal_data_.HasRoute(vertex, edge_to)
+                    || routes_internal_data_.GetWeight(vertex, edge_to) > edge_weight) {
+                    routes_internal_data_.SetRoute(vertex, edge_to, edge_weight, edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            routes_internal_data_.RelaxRowThroughVertex(vertex_from, vertex_through, 0, vertex_count);
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    /**
+     * Релаксация маршрутов блока [rows_begin, rows_end) x [cols_begin, cols_end)
+     * через вершины [through_begin, through_end)
+     */
+    void RelaxBlockThroughVertices(VertexId rows_begin, VertexId rows_end,
+                                   VertexId cols_begin, VertexId cols_end,
+                                   VertexId through_begin, VertexId through_end) {
+        for (VertexId vertex_through = through_begin; vertex_through < through_end; ++vertex_through) {
+            for (VertexId vertex_from = rows_begin; vertex_from < rows_end; ++vertex_from) {
+                routes_internal_data_.RelaxRowThroughVertex(vertex_from, vertex_through,
+                                                            cols_begin, cols_end);
+            }
+        }
+    }
+    void RelaxRoutesInternalDataBlocked(size_t vertex_count, parallel::ThreadPool& thread_pool,
+                                        size_t block_size) {
+        const size_t block_count = (vertex_count + block_size - 1) / block_size;
+        const auto block_begin = [block_size](size_t block) {
+            return block * block_size;
+        };
+        const auto block_end = [block_size, vertex_count](size_t block) {
+            return std::min(vertex_count, (block + 1) * block_size);
+        };
+        for (size_t round = 0; round < block_count; ++round) {
+            const VertexId through_begin = block_begin(round);
+            const VertexId through_end = block_end(round);
+            // фаза 1: диагональный блок зависит только от себя
+            RelaxBlockThroughVertices(through_begin, through_end, through_begin, through_end,
+                                      through_begin, through_end);
+            // фаза 2: блоки строки и столбца раунда зависят от себя и диагонального блока
+            thread_pool.ParallelFor(0, 2 * block_count, [&](size_t task) {
+                const size_t block = task / 2;
+                if (block == round) {
+                    return;
+                }
+                if (task % 2 == 0) {
+                    RelaxBlockThroughVertices(through_begin, through_end, block_begin(block), block_end(block),
+                                              through_begin, through_end);
+                }
+                else {
+                    RelaxBlockThroughVertices(block_begin(block), block_end(block), through_begin, through_end,
+                                              through_begin, through_end);
+                }
+            });
+            // фаза 3: остальные блоки читают только блоки фазы 2, строки блоков независимы
+            thread_pool.ParallelFor(0, block_count, [&](size_t row_block) {
+                if (row_block == round) {
+                    return;
+                }
+                for (size_t col_block = 0; col_block < block_count; ++col_block) {
+                    if (col_block == round) {
+                        continue;
                     }
+                    RelaxBlockThroughVertices(block_begin(row_block), block_end(row_block),
+                                              block_begin(col_block), block_end(col_block),
+                                              through_begin, through_end);
                 }
-            }
+            });
         }
     }
 
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    Storage routes_internal_data_;
 };
 
-template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+template <typename Weight, typename Storage>
+Router<Weight, Storage>::Router(const Graph& graph)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , routes_internal_data_(graph.GetVertexCount())
 {
     InitializeRoutesInternalData(graph);
 
@@ -94,18 +159,33 @@ Router<Weight>::Router(const Graph& graph)
     }
 }
 
-template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+template <typename Weight, typename Storage>
+Router<Weight, Storage>::Router(const Graph& graph, parallel::ThreadPool& thread_pool,
+                                size_t block_size)
+    : graph_(graph)
+    , routes_internal_data_(graph.GetVertexCount())
+{
+    if (block_size == 0) {
+        throw std::invalid_argument("Block size should be positive");
+    }
+    InitializeRoutesInternalData(graph);
+    RelaxRoutesInternalDataBlocked(graph.GetVertexCount(), thread_pool, block_size);
+}
+
+template <typename Weight, typename Storage>
+std::optional<typename Router<Weight, Storage>::RouteInfo>
+Router<Weight, Storage>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (!routes_internal_data_.HasRoute(from, to)) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
+    const Weight weight = routes_internal_data_.GetWeight(from, to);
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
+    for (std::optional<EdgeId> edge_id = routes_internal_data_.GetPrevEdge(from, to);
          edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+         edge_id = routes_internal_data_.GetPrevEdge(from, graph_.GetEdgeSource(*edge_id)))
     {
         edges.push_back(*edge_id);
     }
@@ -114,4 +194,24 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     return RouteInfo{weight, std::move(edges)};
 }
 
+template <typename Weight, typename Storage>
+std::vector<std::optional<Weight>> Router<Weight, Storage>::BuildWeights(VertexId from,
+                                                                         const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        weights.push_back(routes_internal_data_.HasRoute(from, to)
+                          ? std::optional<Weight>(routes_internal_data_.GetWeight(from, to))
+                          : std::nullopt);
+    }
+    return weights;
+}
+
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "graph.h"
+#include "min_plus_kernel.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace graph {
+/**
+ * Хранилище предрассчитанных маршрутов между всеми парами вершин.
+ * Каждая ячейка — необязательные вес маршрута и последнее ребро маршрута,
+ * строки таблицы хранятся в отдельных векторах.
+ *
+ * Политика хранения для graph::Router должна предоставлять те же методы:
+ * HasRoute, GetWeight, GetPrevEdge, SetRoute и RelaxRowThroughVertex.
+ */
+template <typename Weight>
+class OptionalRoutesStorage {
+public:
+    explicit OptionalRoutesStorage(size_t vertex_count)
+        : routes_internal_data_(vertex_count,
+                                std::vector<std::optional<RouteInternalData>>(vertex_count)) {
+    }
+
+    bool HasRoute(VertexId from, VertexId to) const {
+        return routes_internal_data_[from][to].has_value();
+    }
+
+    Weight GetWeight(VertexId from, VertexId to) const {
+        return routes_internal_data_[from][to]->weight;
+    }
+
+    std::optional<EdgeId> GetPrevEdge(VertexId from, VertexId to) const {
+        return routes_internal_data_[from][to]->prev_edge;
+    }
+
+    void SetRoute(VertexId from, VertexId to, Weight weight, std::optional<EdgeId> prev_edge) {
+        routes_internal_data_[from][to] = RouteInternalData{weight, prev_edge};
+    }
+    /**
+     * Релаксация маршрутов (from, to) для to из [to_begin, to_end) через вершину through
+     */
+    void RelaxRowThroughVertex(VertexId from, VertexId through, VertexId to_begin, VertexId to_end) {
+        const auto& route_from = routes_internal_data_[from][through];
+        if (!route_from) {
+            return;
+        }
+        const auto& routes_through = routes_internal_data_[through];
+        auto& routes_from = routes_internal_data_[from];
+        for (VertexId to = to_begin; to < to_end; ++to) {
+            if (const auto& route_to = routes_through[to]) {
+                auto& route_relaxing = routes_from[to];
+                const Weight candidate_weight = route_from->weight + route_to->weight;
+                if (!route_relaxing || candidate_weight < route_relaxing->weight) {
+                    route_relaxing = {candidate_weight,
+                                      route_to->prev_edge ? route_to->prev_edge : route_from->prev_edge};
+                }
+            }
+        }
+    }
+
+private:
+    struct RouteInternalData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    RoutesInternalData routes_internal_data_;
+};
+/**
+ * Компактное хранилище предрассчитанных маршрутов.
+ * Плоские построчные массивы весов (StoredWeight, по умолчанию float) и 32-битных
+ * идентификаторов последних рёбер; отсутствие маршрута и ребра кодируется
+ * значениями-стражами вместо std::optional. Ячейка занимает 8 байт вместо 32.
+ */
+template <typename Weight, typename StoredWeight = float>
+class CompactRoutesStorage {
+    static_assert(std::is_floating_point_v<StoredWeight>,
+                  "Stored weight should be a floating point type");
+public:
+    explicit CompactRoutesStorage(size_t vertex_count)
+        : vertex_count_(vertex_count)
+        , weights_(vertex_count * vertex_count, NO_ROUTE)
+        , prev_edges_(vertex_count * vertex_count, NO_EDGE) {
+    }
+
+    bool HasRoute(VertexId from, VertexId to) const {
+        return weights_[Index(from, to)] != NO_ROUTE;
+    }
+
+    Weight GetWeight(VertexId from, VertexId to) const {
+        return static_cast<Weight>(weights_[Index(from, to)]);
+    }
+
+    std::optional<EdgeId> GetPrevEdge(VertexId from, VertexId to) const {
+        const uint32_t prev_edge = prev_edges_[Index(from, to)];
+        if (prev_edge == NO_EDGE) {
+            return std::nullopt;
+        }
+        return prev_edge;
+    }
+
+    void SetRoute(VertexId from, VertexId to, Weight weight, std::optional<EdgeId> prev_edge) {
+        if (prev_edge && *prev_edge >= NO_EDGE) {
+            throw std::length_error("Edge id does not fit compact routes storage");
+        }
+        weights_[Index(from, to)] = static_cast<StoredWeight>(weight);
+        prev_edges_[Index(from, to)] = prev_edge ? static_cast<uint32_t>(*prev_edge) : NO_EDGE;
+    }
+    /**
+     * Релаксация маршрутов (from, to) для to из [to_begin, to_end) через вершину through.
+     * Отсутствующий маршрут имеет бесконечный вес, поэтому строка обновляется
+     * без ветвлений векторным ядром min-plus (см. min_plus_kernel.h).
+     */
+    void RelaxRowThroughVertex(VertexId from, VertexId through, VertexId to_begin, VertexId to_end) {
+        const StoredWeight weight_from = weights_[Index(from, through)];
+        if (weight_from == NO_ROUTE) {
+            return;
+        }
+        RelaxMinPlusRow(weight_from, prev_edges_[Index(from, through)],
+                        &weights_[Index(through, to_begin)], &prev_edges_[Index(through, to_begin)],
+                        &weights_[Index(from, to_begin)], &prev_edges_[Index(from, to_begin)],
+                        to_end - to_begin);
+    }
+
+private:
+    static constexpr StoredWeight NO_ROUTE = std::numeric_limits<StoredWeight>::infinity();
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+    size_t Index(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
+    }
+
+    size_t vertex_count_;
+    std::vector<StoredWeight> weights_;
+    std::vector<uint32_t> prev_edges_;
+};
+
+}  // namespace graph
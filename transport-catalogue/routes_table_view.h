@@ -0,0 +1,89 @@
+#pragma once
+
+#include "graph.h"
+#include "routing_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+/**
+ * Маршрутизация по готовой таблице маршрутов всех пар во внешней памяти
+ * (например, в отображённом в память файле); данные не копируются.
+ * Таблица имеет формат CompactRoutesStorage: построчные массивы весов
+ * (бесконечность — маршрута нет) и 32-битных идентификаторов последних рёбер.
+ * Таблица не проверяется при создании: идентификаторы последних рёбер проверяются
+ * при восстановлении маршрута, и повреждённая таблица даёт исключение, а не выход
+ * за границы. Веса не проверяются.
+ */
+template <typename Weight, typename StoredWeight>
+class RoutesTableView final : public RoutingEngine<Weight> {
+public:
+    using typename RoutingEngine<Weight>::RouteInfo;
+
+    static constexpr StoredWeight NO_ROUTE = std::numeric_limits<StoredWeight>::infinity();
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+    RoutesTableView(const DirectedWeightedGraph<Weight>& graph, const StoredWeight* weights,
+                    const uint32_t* prev_edges)
+        : graph_(graph)
+        , vertex_count_(graph.GetVertexCount())
+        , weights_(weights)
+        , prev_edges_(prev_edges) {
+    }
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override {
+        if (from >= vertex_count_ || to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const StoredWeight weight = weights_[from * vertex_count_ + to];
+        if (weight == NO_ROUTE) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        VertexId vertex = to;
+        for (uint32_t edge_id = prev_edges_[from * vertex_count_ + to]; edge_id != NO_EDGE;
+             edge_id = prev_edges_[from * vertex_count_ + vertex])
+        {
+            // последнее ребро ведёт в текущую вершину, а в простом пути рёбер меньше,
+            // чем вершин; иначе таблица повреждена или зациклена
+            if (edge_id >= graph_.GetEdgeCount() || graph_.GetEdgeTarget(edge_id) != vertex
+                || edges.size() >= vertex_count_) {
+                throw std::runtime_error("Routes table is corrupted");
+            }
+            edges.push_back(edge_id);
+            vertex = graph_.GetEdgeSource(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{static_cast<Weight>(weight), std::move(edges)};
+    }
+
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                    const std::vector<VertexId>& targets) const override {
+        if (from >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(targets.size());
+        for (const VertexId to : targets) {
+            if (to >= vertex_count_) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            const StoredWeight weight = weights_[from * vertex_count_ + to];
+            weights.push_back(weight == NO_ROUTE ? std::nullopt : std::optional<Weight>(weight));
+        }
+        return weights;
+    }
+
+private:
+    const DirectedWeightedGraph<Weight>& graph_;
+    size_t vertex_count_;
+    const StoredWeight* weights_;
+    const uint32_t* prev_edges_;
+};
+
+}  // namespace graph
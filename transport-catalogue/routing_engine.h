@@ -0,0 +1,112 @@
+#pragma once
+
+#include "graph.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace graph {
+/**
+ * Статистика поисков по графу
+ */
+struct SearchStats {
+    /**
+     * Количество выполненных поисков
+     */
+    size_t searches = 0;
+    /**
+     * Суммарное количество извлечённых из очереди (окончательно обработанных) вершин
+     */
+    size_t settled_vertices = 0;
+};
+/**
+ * Потокобезопасный накопитель статистики поисков
+ */
+class SearchStatsCounter {
+public:
+    void AddSearch(size_t settled_vertices) const {
+        ++searches_;
+        settled_vertices_ += settled_vertices;
+    }
+
+    SearchStats Get() const {
+        return {searches_.load(), settled_vertices_.load()};
+    }
+
+private:
+    mutable std::atomic<size_t> searches_{0};
+    mutable std::atomic<size_t> settled_vertices_{0};
+};
+/**
+ * Общий интерфейс алгоритмов поиска кратчайшего пути по графу.
+ * Константные методы реентерабельны и могут вызываться одновременно из разных
+ * потоков: временные данные поиска каждый запрос берёт из пула рабочих областей
+ * (WorkspacePool), общие изменяемые данные защищены мьютексом или атомарны.
+ * Неконстантные методы требуют монопольного доступа.
+ */
+template <typename Weight>
+class RoutingEngine {
+public:
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    virtual ~RoutingEngine() = default;
+    /**
+     * Построить кратчайший маршрут между вершинами.
+     * Рёбра маршрута возвращаются в порядке следования.
+     */
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+    /**
+     * Веса кратчайших путей из вершины from до каждой из вершин targets
+     * (nullopt — пути нет), без восстановления рёбер маршрутов.
+     * По умолчанию маршрут строится до каждой вершины отдельно.
+     */
+    virtual std::vector<std::optional<Weight>> BuildWeights(VertexId from,
+                                                            const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(targets.size());
+        for (const VertexId to : targets) {
+            const auto route = BuildRoute(from, to);
+            weights.push_back(route ? std::optional<Weight>(route->weight) : std::nullopt);
+        }
+        return weights;
+    }
+    /**
+     * Таблица весов кратчайших путей: строка на каждую вершину sources, столбец
+     * на каждую вершину targets. По умолчанию строки вычисляются параллельно
+     * вызовами BuildWeights.
+     */
+    virtual std::vector<std::vector<std::optional<Weight>>> BuildWeightsTable(
+            const std::vector<VertexId>& sources, const std::vector<VertexId>& targets,
+            parallel::ThreadPool& thread_pool) const {
+        std::vector<std::vector<std::optional<Weight>>> table(sources.size());
+        thread_pool.ParallelFor(0, sources.size(), [&](size_t row) {
+            table[row] = BuildWeights(sources[row], targets);
+        });
+        return table;
+    }
+    /**
+     * Статистика поисков по графу, если алгоритм выполняет поиск на каждый запрос
+     */
+    virtual std::optional<SearchStats> GetSearchStats() const {
+        return std::nullopt;
+    }
+    /**
+     * Учесть замену рёбер графа (см. DirectedWeightedGraph::ReplaceEdges) без полного
+     * перестроения. Ответы после этого должны совпадать с ответами алгоритма, созданного
+     * заново. Возвращает false, если алгоритм нужно создать заново: так поступают
+     * алгоритмы с предрасчётом, у которых частичное восстановление может выбрать
+     * другой из равных по весу путей.
+     */
+    virtual bool UpdateGraph(const EdgeIdsRemap& remap) {
+        (void)remap;
+        return false;
+    }
+};
+
+}  // namespace graph
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+/**
+ * Очередь с приоритетом для поиска Дейкстры на двоичной куче
+ */
+template <typename Key, typename Value>
+class BinaryHeap {
+public:
+    using Item = std::pair<Key, Value>;
+
+    void Clear() {
+        items_.clear();
+    }
+
+    bool IsEmpty() const {
+        return items_.empty();
+    }
+
+    void Push(Key key, Value value) {
+        items_.emplace_back(key, value);
+        std::push_heap(items_.begin(), items_.end(), std::greater<Item>{});
+    }
+    /**
+     * Извлечь элемент с минимальным ключом
+     */
+    Item Pop() {
+        std::pop_heap(items_.begin(), items_.end(), std::greater<Item>{});
+        const Item item = items_.back();
+        items_.pop_back();
+        return item;
+    }
+
+private:
+    std::vector<Item> items_;
+};
+/**
+ * Монотонная поразрядная куча (radix heap) для беззнаковых целых ключей.
+ * Ключ добавляемого элемента должен быть не меньше ключа последнего извлечённого —
+ * так и происходит в поиске Дейкстры с неотрицательными весами.
+ *
+ * Элемент лежит в корзине с номером старшего бита, в котором его ключ отличается
+ * от последнего извлечённого минимума (в нулевой — ключи, равные ему). Если нулевая
+ * корзина пуста, первая непустая корзина раскладывается относительно своего минимума,
+ * и все её элементы попадают в корзины с меньшими номерами. Поэтому каждый элемент
+ * перекладывается не больше разрядности ключа раз, а сравнения ключей между собой
+ * нужны только при поиске минимума корзины.
+ */
+template <typename Key, typename Value>
+class RadixHeap {
+    static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key>,
+                  "Radix heap keys should be unsigned integers");
+public:
+    using Item = std::pair<Key, Value>;
+
+    void Clear() {
+        for (auto& bucket : buckets_) {
+            bucket.clear();
+        }
+        size_ = 0;
+        last_key_ = 0;
+    }
+
+    bool IsEmpty() const {
+        return size_ == 0;
+    }
+
+    void Push(Key key, Value value) {
+        assert(!(key < last_key_));
+        buckets_[GetBucketIndex(key)].emplace_back(key, value);
+        ++size_;
+    }
+    /**
+     * Извлечь элемент с минимальным ключом
+     */
+    Item Pop() {
+        if (buckets_[0].empty()) {
+            size_t index = 1;
+            while (buckets_[index].empty()) {
+                ++index;
+            }
+            auto& bucket = buckets_[index];
+            last_key_ = std::min_element(bucket.begin(), bucket.end(), [](const Item& lhs, const Item& rhs) {
+                return lhs.first < rhs.first;
+            })->first;
+            for (const Item& item : bucket) {
+                buckets_[GetBucketIndex(item.first)].push_back(item);
+            }
+            bucket.clear();
+        }
+        const Item item = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        return item;
+    }
+
+private:
+    static constexpr size_t KEY_BITS = std::numeric_limits<Key>::digits;
+
+    size_t GetBucketIndex(Key key) const {
+        return key == last_key_ ? 0 : GetBitWidth(key ^ last_key_);
+    }
+    /**
+     * Номер старшего единичного бита, считая с единицы
+     */
+    static size_t GetBitWidth(Key value) {
+#if defined(__GNUC__)
+        return std::numeric_limits<unsigned long long>::digits
+                - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(value)));
+#else
+        size_t width = 0;
+        for (; value != 0; value >>= 1) {
+            ++width;
+        }
+        return width;
+#endif
+    }
+
+    std::array<std::vector<Item>, KEY_BITS + 1> buckets_;
+    size_t size_ = 0;
+    Key last_key_ = 0;
+};
+/**
+ * Очередь поиска по весам Key: поразрядная куча для беззнаковых целых весов
+ * (веса в фиксированной точке), двоичная куча для остальных
+ */
+template <typename Key, typename Value>
+using SearchQueue = std::conditional_t<std::is_integral_v<Key> && std::is_unsigned_v<Key>,
+                                       RadixHeap<Key, Value>, BinaryHeap<Key, Value>>;
+
+}  // namespace graph
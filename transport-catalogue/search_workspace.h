@@ -0,0 +1,123 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace graph {
+/**
+ * Метки поиска по графу: вес пути и последнее ребро пути для каждой вершины.
+ * Сброс выполняется за O(1) сменой поколения, а не очисткой массивов,
+ * поэтому один набор меток можно переиспользовать между запросами.
+ */
+template <typename Weight>
+class SearchLabels {
+public:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    /**
+     * Сбросить все метки графа из vertex_count вершин
+     */
+    void Reset(size_t vertex_count) {
+        if (generations_.size() != vertex_count) {
+            weights_.assign(vertex_count, Weight{});
+            prev_edges_.assign(vertex_count, NO_EDGE);
+            generations_.assign(vertex_count, 0);
+            generation_ = 0;
+        }
+        if (++generation_ == 0) {
+            std::fill(generations_.begin(), generations_.end(), 0);
+            generation_ = 1;
+        }
+    }
+
+    bool IsReached(VertexId vertex) const {
+        return generations_[vertex] == generation_;
+    }
+
+    Weight GetWeight(VertexId vertex) const {
+        return weights_[vertex];
+    }
+
+    EdgeId GetPrevEdge(VertexId vertex) const {
+        return prev_edges_[vertex];
+    }
+
+    void Set(VertexId vertex, Weight weight, EdgeId prev_edge) {
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+        generations_[vertex] = generation_;
+    }
+
+private:
+    std::vector<Weight> weights_;
+    std::vector<EdgeId> prev_edges_;
+    std::vector<uint32_t> generations_;
+    uint32_t generation_ = 0;
+};
+/**
+ * Пул рабочих областей поиска.
+ * Каждый запрос берёт свою область на время выполнения, поэтому константные
+ * методы маршрутизаторов остаются реентерабельными без повторного выделения памяти.
+ * Областей создаётся не больше, чем запросов выполнялось одновременно, то есть
+ * не больше числа потоков, обращающихся к маршрутизатору; мьютекс удерживается
+ * только на время взятия и возврата области.
+ */
+template <typename Workspace>
+class WorkspacePool {
+public:
+    /**
+     * Рабочая область, взятая из пула; при уничтожении возвращается в пул
+     */
+    class Lease {
+    public:
+        Lease(const WorkspacePool& pool, std::unique_ptr<Workspace> workspace)
+            : pool_(pool)
+            , workspace_(std::move(workspace)) {
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() {
+            pool_.Release(std::move(workspace_));
+        }
+        Workspace& operator*() const {
+            return *workspace_;
+        }
+        Workspace* operator->() const {
+            return workspace_.get();
+        }
+    private:
+        const WorkspacePool& pool_;
+        std::unique_ptr<Workspace> workspace_;
+    };
+
+    Lease Acquire() const {
+        std::unique_ptr<Workspace> workspace;
+        {
+            std::lock_guard guard(mutex_);
+            if (!free_.empty()) {
+                workspace = std::move(free_.back());
+                free_.pop_back();
+            }
+        }
+        if (!workspace) {
+            workspace = std::make_unique<Workspace>();
+        }
+        return Lease(*this, std::move(workspace));
+    }
+
+private:
+    void Release(std::unique_ptr<Workspace> workspace) const {
+        std::lock_guard guard(mutex_);
+        free_.push_back(std::move(workspace));
+    }
+
+    mutable std::mutex mutex_;
+    mutable std::vector<std::unique_ptr<Workspace>> free_;
+};
+
+}  // namespace graph
@@ -0,0 +1,107 @@
+#include "contraction_hierarchy.h"
+#include "testing.h"
+#include "test_networks.h"
+
+#include <vector>
+
+namespace {
+/**
+ * Небольшая сеть с известными кратчайшими путями; вершина 5 изолирована
+ */
+graph::DirectedWeightedGraph<double> MakeSmallGraph() {
+    graph::DirectedWeightedGraph<double> graph(6);
+    graph.AddEdge({0, 1, 0, 1, 2.0});
+    graph.AddEdge({1, 1, 1, 2, 2.0});
+    graph.AddEdge({2, 1, 0, 2, 5.0});
+    graph.AddEdge({3, 1, 2, 3, 1.0});
+    graph.AddEdge({4, 1, 3, 4, 3.0});
+    graph.AddEdge({5, 1, 0, 4, 10.0});
+    graph.AddEdge({6, 1, 4, 0, 1.0});
+    graph.Freeze();
+    return graph;
+}
+
+void TestSmallNetwork() {
+    const auto graph = MakeSmallGraph();
+    parallel::ThreadPool thread_pool(2);
+    const graph::ContractionHierarchy<double> hierarchy(graph, thread_pool);
+    const struct {
+        graph::VertexId from;
+        graph::VertexId to;
+        double weight;
+    } expected_routes[] = {
+        {0, 4, 8.0},  // 0 → 1 → 2 → 3 → 4 короче прямого ребра 0 → 4
+        {4, 3, 6.0},  // 4 → 0 → 1 → 2 → 3
+        {3, 0, 4.0},  // 3 → 4 → 0
+        {2, 2, 0.0},
+    };
+    for (const auto& expected : expected_routes) {
+        const auto route = hierarchy.BuildRoute(expected.from, expected.to);
+        CHECK(route.has_value());
+        if (route) {
+            CHECK(route->weight == expected.weight);
+            CHECK(testing::IsPath(graph, expected.from, expected.to, route->edges, route->weight));
+        }
+    }
+    CHECK(!hierarchy.BuildRoute(0, 5));
+    CHECK(!hierarchy.BuildRoute(5, 0));
+}
+/**
+ * Маршруты и таблица весов совпадают по весу с поиском Дейкстры на случайных графах
+ */
+void TestMatchesDijkstra() {
+    parallel::ThreadPool thread_pool(4);
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        const auto graph = testing::MakeRandomGraph(seed, 40, 40 + seed * 8);
+        const graph::ContractionHierarchy<double> hierarchy(graph, thread_pool);
+        const auto expected = testing::ComputeAllPairsWeights(graph);
+        std::vector<graph::VertexId> vertices(graph.GetVertexCount());
+        for (graph::VertexId vertex = 0; vertex < vertices.size(); ++vertex) {
+            vertices[vertex] = vertex;
+        }
+        for (const graph::VertexId from : vertices) {
+            for (const graph::VertexId to : vertices) {
+                const auto route = hierarchy.BuildRoute(from, to);
+                CHECK(route.has_value() == expected[from][to].has_value());
+                if (route && expected[from][to]) {
+                    CHECK(route->weight == *expected[from][to]);
+                    CHECK(testing::IsPath(graph, from, to, route->edges, route->weight));
+                }
+            }
+        }
+        CHECK(hierarchy.BuildWeightsTable(vertices, vertices, thread_pool) == expected);
+    }
+}
+/**
+ * Иерархия не зависит от количества потоков сжатия
+ */
+void TestIndependentOfThreadCount() {
+    parallel::ThreadPool single_thread(1);
+    parallel::ThreadPool many_threads(4);
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        const auto graph = testing::MakeRandomGraph(seed, 60, 240);
+        const graph::ContractionHierarchy<double> lhs(graph, single_thread);
+        const graph::ContractionHierarchy<double> rhs(graph, many_threads);
+        CHECK(lhs.GetShortcutCount() == rhs.GetShortcutCount());
+        for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+            CHECK(lhs.GetRank(from) == rhs.GetRank(from));
+            for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+                const auto lhs_route = lhs.BuildRoute(from, to);
+                const auto rhs_route = rhs.BuildRoute(from, to);
+                CHECK(lhs_route.has_value() == rhs_route.has_value());
+                if (lhs_route && rhs_route) {
+                    CHECK(lhs_route->edges == rhs_route->edges);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestSmallNetwork);
+    RUN_TEST(TestMatchesDijkstra);
+    RUN_TEST(TestIndependentOfThreadCount);
+    return testing::Finish();
+}
@@ -0,0 +1,62 @@
+#include "dijkstra_router.h"
+#include "testing.h"
+#include "test_networks.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+/**
+ * Веса до набора целей совпадают с кратчайшими путями между всеми парами
+ */
+void TestBuildWeightsMatchesAllPairs() {
+    for (uint32_t seed = 1; seed <= 10; ++seed) {
+        const auto graph = testing::MakeRandomGraph(seed, 30, 30 + seed * 6);
+        const auto expected = testing::ComputeAllPairsWeights(graph);
+        const graph::DijkstraRouter<double> router(graph);
+        for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+            // повторяющаяся цель и подмножество вершин
+            const std::vector<graph::VertexId> targets = {from % 7, 3, 11, 3, 29};
+            const auto weights = router.BuildWeights(from, targets);
+            CHECK(weights.size() == targets.size());
+            for (size_t i = 0; i < targets.size() && i < weights.size(); ++i) {
+                CHECK(weights[i] == expected[from][targets[i]]);
+            }
+        }
+    }
+}
+/**
+ * После переполнения веса пути рабочая область не сохраняет метки целей:
+ * следующий запрос не останавливается раньше времени
+ */
+void TestBuildWeightsAfterOverflow() {
+    using Weight = uint32_t;
+    constexpr Weight MAX_WEIGHT = std::numeric_limits<Weight>::max();
+    // 0 → 1 → 2 переполняет вес; 4 достижима из 3 только через 2
+    graph::DirectedWeightedGraph<Weight> graph(5);
+    graph.AddEdge({0, 1, 0, 1, MAX_WEIGHT});
+    graph.AddEdge({1, 1, 1, 2, 1});
+    graph.AddEdge({2, 1, 3, 2, 1});
+    graph.AddEdge({3, 1, 2, 4, 4});
+    graph.Freeze();
+    const graph::DijkstraRouter<Weight> router(graph);
+    bool is_thrown = false;
+    try {
+        router.BuildWeights(0, {2});
+    } catch (const std::overflow_error&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown);
+    CHECK(router.BuildWeights(3, {4}) == (std::vector<std::optional<Weight>>{5}));
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestBuildWeightsMatchesAllPairs);
+    RUN_TEST(TestBuildWeightsAfterOverflow);
+    return testing::Finish();
+}
@@ -0,0 +1,137 @@
+#include "graph.h"
+#include "testing.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+bool operator==(const graph::Edge<double>& lhs, const graph::Edge<double>& rhs) {
+    return lhs.title_id == rhs.title_id && lhs.quantity == rhs.quantity && lhs.from == rhs.from
+            && lhs.to == rhs.to && lhs.weight == rhs.weight;
+}
+/**
+ * Заморозка упорядочивает рёбра по вершине начала, сохраняя порядок добавления внутри вершины
+ */
+void TestFreezeOrdersEdgesBySource() {
+    graph::DirectedWeightedGraph<double> graph(3);
+    const std::vector<graph::Edge<double>> edges = {
+        {0, 1, 2, 0, 1.0},
+        {1, 1, 0, 1, 2.0},
+        {2, 2, 2, 1, 3.0},
+        {3, 1, 0, 2, 4.0},
+    };
+    for (const auto& edge : edges) {
+        graph.AddEdge(edge);
+    }
+    CHECK(!graph.IsFrozen());
+    graph.Freeze();
+    CHECK(graph.IsFrozen());
+    CHECK(graph.GetEdgeCount() == edges.size());
+    CHECK(graph.GetEdge(0) == edges[1]);
+    CHECK(graph.GetEdge(1) == edges[3]);
+    CHECK(graph.GetEdge(2) == edges[0]);
+    CHECK(graph.GetEdge(3) == edges[2]);
+    for (graph::VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        for (const graph::EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            CHECK(graph.GetEdgeSource(edge_id) == vertex);
+        }
+        for (const graph::EdgeId edge_id : graph.GetIncomingEdges(vertex)) {
+            CHECK(graph.GetEdgeTarget(edge_id) == vertex);
+        }
+    }
+    CHECK(graph.GetIncidentEdges(1).begin() == graph.GetIncidentEdges(1).end());
+    CHECK(graph.GetEdgeWeight(1) == 4.0);
+}
+/**
+ * Соответствие идентификаторов после замены рёбер указывает на те же рёбра
+ */
+void TestReplaceEdgesRemap() {
+    graph::DirectedWeightedGraph<double> graph(4);
+    for (size_t i = 0; i < 8; ++i) {
+        graph.AddEdge({i, 1, i % 4, (i + 1) % 4, static_cast<double>(i)});
+    }
+    graph.Freeze();
+    std::vector<graph::Edge<double>> old_edges;
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        old_edges.push_back(graph.GetEdge(edge_id));
+    }
+    const std::vector<graph::Edge<double>> new_edges = {{100, 1, 3, 0, 0.5}, {101, 1, 0, 3, 0.25}};
+    const auto remap = graph.ReplaceEdges([](const graph::Edge<double>& edge) {
+        return edge.title_id % 3 == 0;
+    }, new_edges);
+    CHECK(graph.GetEdgeCount() == old_edges.size() - 3 + new_edges.size());
+    for (graph::EdgeId edge_id = 0; edge_id < old_edges.size(); ++edge_id) {
+        if (old_edges[edge_id].title_id % 3 == 0) {
+            CHECK(remap.kept[edge_id] == graph::EdgeIdsRemap::REMOVED);
+        }
+        else {
+            CHECK(graph.GetEdge(remap.kept[edge_id]) == old_edges[edge_id]);
+        }
+    }
+    CHECK(remap.added.size() == new_edges.size());
+    for (size_t i = 0; i < new_edges.size(); ++i) {
+        CHECK(graph.GetEdge(remap.added[i]) == new_edges[i]);
+    }
+    for (graph::VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        for (const graph::EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            CHECK(graph.GetEdgeSource(edge_id) == vertex);
+        }
+    }
+}
+/**
+ * Граф над столбцами другого графа обходится так же и копирует их при замене рёбер;
+ * несогласованные столбцы отклоняются
+ */
+void TestExternalColumns() {
+    graph::DirectedWeightedGraph<double> graph(4);
+    for (size_t i = 0; i < 8; ++i) {
+        graph.AddEdge({i, 1, (i * 3) % 4, (i + 1) % 4, static_cast<double>(i)});
+    }
+    graph.Freeze();
+    const auto& columns = graph.GetColumns();
+    auto external = graph::DirectedWeightedGraph<double>::FromColumns(4, graph.GetEdgeCount(), columns);
+    CHECK(external.has_value());
+    if (!external) {
+        return;
+    }
+    CHECK(external->GetColumns().targets == columns.targets);
+    const auto copy = *external;
+    CHECK(copy.GetColumns().targets == columns.targets);
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        CHECK(external->GetEdge(edge_id) == graph.GetEdge(edge_id));
+    }
+    for (graph::VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        CHECK(std::equal(external->GetIncomingEdges(vertex).begin(), external->GetIncomingEdges(vertex).end(),
+                         graph.GetIncomingEdges(vertex).begin(), graph.GetIncomingEdges(vertex).end()));
+    }
+    const auto first_edge = graph.GetEdge(0);
+    external->ReplaceEdges([](const graph::Edge<double>& edge) {
+        return edge.title_id == 0;
+    }, {});
+    CHECK(external->GetColumns().targets != columns.targets);
+    CHECK(external->GetEdgeCount() == graph.GetEdgeCount() - 1);
+    CHECK(graph.GetEdge(0) == first_edge);
+
+    CHECK(!graph::DirectedWeightedGraph<double>::FromColumns(4, graph.GetEdgeCount() + 1, columns));
+    std::vector<graph::VertexId> targets(columns.targets, columns.targets + graph.GetEdgeCount());
+    targets[2] = 4;
+    auto broken_columns = columns;
+    broken_columns.targets = targets.data();
+    CHECK(!graph::DirectedWeightedGraph<double>::FromColumns(4, graph.GetEdgeCount(), broken_columns));
+    std::vector<graph::VertexId> sources(columns.sources, columns.sources + graph.GetEdgeCount());
+    std::swap(sources.front(), sources.back());
+    broken_columns = columns;
+    broken_columns.sources = sources.data();
+    CHECK(!graph::DirectedWeightedGraph<double>::FromColumns(4, graph.GetEdgeCount(), broken_columns));
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestFreezeOrdersEdgesBySource);
+    RUN_TEST(TestReplaceEdgesRemap);
+    RUN_TEST(TestExternalColumns);
+    return testing::Finish();
+}
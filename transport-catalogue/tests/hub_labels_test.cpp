@@ -0,0 +1,113 @@
+#include "hub_labels.h"
+#include "testing.h"
+#include "test_networks.h"
+
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+/**
+ * Небольшая сеть с известными кратчайшими путями; вершина 5 изолирована
+ */
+graph::DirectedWeightedGraph<double> MakeSmallGraph() {
+    graph::DirectedWeightedGraph<double> graph(6);
+    graph.AddEdge({0, 1, 0, 1, 2.0});
+    graph.AddEdge({1, 1, 1, 2, 2.0});
+    graph.AddEdge({2, 1, 0, 2, 5.0});
+    graph.AddEdge({3, 1, 2, 3, 1.0});
+    graph.AddEdge({4, 1, 3, 4, 3.0});
+    graph.AddEdge({5, 1, 0, 4, 10.0});
+    graph.AddEdge({6, 1, 4, 0, 1.0});
+    graph.Freeze();
+    return graph;
+}
+/**
+ * Веса всех пар вершин по меткам
+ */
+std::vector<std::vector<std::optional<double>>> GetAllWeights(const graph::HubLabels<double>& labels) {
+    std::vector<std::vector<std::optional<double>>> weights(labels.GetVertexCount());
+    for (graph::VertexId from = 0; from < labels.GetVertexCount(); ++from) {
+        for (graph::VertexId to = 0; to < labels.GetVertexCount(); ++to) {
+            weights[from].push_back(labels.GetWeight(from, to));
+        }
+    }
+    return weights;
+}
+
+void TestSmallNetwork() {
+    const auto graph = MakeSmallGraph();
+    parallel::ThreadPool thread_pool(2);
+    const graph::ContractionHierarchy<double> hierarchy(graph, thread_pool);
+    const graph::HubLabels<double> labels(hierarchy, thread_pool);
+    CHECK(labels.GetVertexCount() == graph.GetVertexCount());
+    CHECK(labels.GetWeight(0, 4) == 8.0);  // 0 → 1 → 2 → 3 → 4 короче прямого ребра 0 → 4
+    CHECK(labels.GetWeight(4, 3) == 6.0);  // 4 → 0 → 1 → 2 → 3
+    CHECK(labels.GetWeight(3, 0) == 4.0);  // 3 → 4 → 0
+    CHECK(labels.GetWeight(2, 2) == 0.0);
+    CHECK(!labels.GetWeight(0, 5));
+    CHECK(!labels.GetWeight(5, 0));
+    bool is_thrown = false;
+    try {
+        labels.GetWeight(0, 6);
+    } catch (const std::out_of_range&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown);
+}
+/**
+ * Веса меток совпадают с поиском Дейкстры на случайных графах
+ * и не зависят от количества потоков построения
+ */
+void TestMatchesDijkstra() {
+    parallel::ThreadPool single_thread(1);
+    parallel::ThreadPool many_threads(4);
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        const auto graph = testing::MakeRandomGraph(seed, 40, 40 + seed * 8);
+        const graph::ContractionHierarchy<double> hierarchy(graph, many_threads);
+        const auto expected = testing::ComputeAllPairsWeights(graph);
+        const graph::HubLabels<double> labels(hierarchy, many_threads);
+        CHECK(GetAllWeights(labels) == expected);
+        const graph::HubLabels<double> single_thread_labels(hierarchy, single_thread);
+        CHECK(single_thread_labels.GetEntryCount() == labels.GetEntryCount());
+        CHECK(GetAllWeights(single_thread_labels) == expected);
+    }
+}
+/**
+ * Загруженный индекс отвечает так же, как сохранённый; повреждённые данные
+ * и данные с другим ключом не загружаются
+ */
+void TestSaveLoad() {
+    parallel::ThreadPool thread_pool(2);
+    const auto graph = testing::MakeRandomGraph(3, 50, 200);
+    const graph::ContractionHierarchy<double> hierarchy(graph, thread_pool);
+    const graph::HubLabels<double> labels(hierarchy, thread_pool);
+    std::ostringstream output;
+    labels.Save(output, 42);
+    const std::string content = output.str();
+
+    std::istringstream input(content);
+    const auto loaded = graph::HubLabels<double>::Load(input, 42);
+    CHECK(loaded.has_value());
+    if (loaded) {
+        CHECK(loaded->GetEntryCount() == labels.GetEntryCount());
+        CHECK(GetAllWeights(*loaded) == GetAllWeights(labels));
+    }
+    std::istringstream other_key_input(content);
+    CHECK(!graph::HubLabels<double>::Load(other_key_input, 43));
+    std::istringstream truncated_input(content.substr(0, content.size() / 2));
+    CHECK(!graph::HubLabels<double>::Load(truncated_input, 42));
+    std::istringstream float_input(content);
+    CHECK(!graph::HubLabels<float>::Load(float_input, 42));
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestSmallNetwork);
+    RUN_TEST(TestMatchesDijkstra);
+    RUN_TEST(TestSaveLoad);
+    return testing::Finish();
+}
@@ -0,0 +1,116 @@
+#include "dijkstra_router.h"
+#include "testing.h"
+#include "test_networks.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using ReachableVertices = std::vector<std::pair<graph::VertexId, double>>;
+/**
+ * Сеть с известными кратчайшими путями: 0 → 1 → 2 → 3 → 4 → 0 и рёбра 0 → 2, 0 → 4
+ */
+graph::DirectedWeightedGraph<double> MakeSmallGraph() {
+    graph::DirectedWeightedGraph<double> graph(5);
+    graph.AddEdge({0, 1, 0, 1, 2.0});
+    graph.AddEdge({1, 1, 1, 2, 2.0});
+    graph.AddEdge({2, 1, 0, 2, 5.0});
+    graph.AddEdge({3, 1, 2, 3, 1.0});
+    graph.AddEdge({4, 1, 3, 4, 3.0});
+    graph.AddEdge({5, 1, 0, 4, 10.0});
+    graph.AddEdge({6, 1, 4, 0, 1.0});
+    graph.Freeze();
+    return graph;
+}
+
+void TestSmallNetwork() {
+    const auto graph = MakeSmallGraph();
+    // граница включается
+    CHECK(graph::FindReachableVertices(graph, 0, 5.0) == (ReachableVertices{{0, 0.0}, {1, 2.0}, {2, 4.0}, {3, 5.0}}));
+    CHECK(graph::FindReachableVertices(graph, 0, 5.0, true)
+          == (ReachableVertices{{0, 0.0}, {4, 1.0}, {3, 4.0}, {2, 5.0}}));
+    CHECK(graph::FindReachableVertices(graph, 2, 0.0) == (ReachableVertices{{2, 0.0}}));
+}
+/**
+ * Достижимые вершины и их веса совпадают с кратчайшими путями между всеми парами
+ */
+void TestMatchesAllPairs() {
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        const auto graph = testing::MakeRandomGraph(seed, 30, 30 + seed * 6);
+        const auto weights = testing::ComputeAllPairsWeights(graph);
+        for (const double max_weight : {0.0, 7.0, 20.0, std::numeric_limits<double>::infinity()}) {
+            for (graph::VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+                for (const bool reverse : {false, true}) {
+                    const auto reachable = graph::FindReachableVertices(graph, vertex, max_weight, reverse);
+                    size_t expected_count = 0;
+                    for (graph::VertexId other = 0; other < graph.GetVertexCount(); ++other) {
+                        const auto& weight = reverse ? weights[other][vertex] : weights[vertex][other];
+                        expected_count += weight && *weight <= max_weight ? 1 : 0;
+                    }
+                    CHECK(reachable.size() == expected_count);
+                    for (size_t i = 0; i < reachable.size(); ++i) {
+                        const auto [other, weight] = reachable[i];
+                        const auto& expected = reverse ? weights[other][vertex] : weights[vertex][other];
+                        CHECK(expected && *expected == weight);
+                        CHECK(i == 0 || reachable[i - 1].second <= weight);
+                    }
+                }
+            }
+        }
+    }
+}
+/**
+ * Остановки изохроны маршрутизатора — остановки со временем поездки не больше предела
+ */
+void TestRouterMatchesTravelTimes() {
+    transport::RoutingSettings settings;
+    settings.bus_wait_time = 4;
+    settings.bus_velocity = 35.0;
+    settings.algorithm = transport::RoutingAlgorithm::DIJKSTRA;
+    const double max_time = 15.0;
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        transport::Catalogue catalogue;
+        testing::FillRandomCatalogue(catalogue, seed, 20, 8);
+        transport::Router router(settings);
+        router.Build(catalogue);
+        const auto stops = catalogue.GetStops(transport::SORTED);
+        for (const auto stop : stops) {
+            for (const bool reverse : {false, true}) {
+                const auto reachable = router.GetReachableStops(stop, max_time, reverse);
+                for (size_t i = 0; i < reachable.size(); ++i) {
+                    const auto travel_time = reverse ? router.GetTravelTime(reachable[i].stop, stop)
+                                                     : router.GetTravelTime(stop, reachable[i].stop);
+                    CHECK(travel_time.has_value());
+                    if (travel_time) {
+                        CHECK_NEAR(reachable[i].time, *travel_time, 1e-9);
+                    }
+                    CHECK(reachable[i].time <= max_time);
+                    CHECK(i == 0 || reachable[i - 1].time <= reachable[i].time);
+                }
+                for (const auto other : stops) {
+                    const auto travel_time = reverse ? router.GetTravelTime(other, stop)
+                                                     : router.GetTravelTime(stop, other);
+                    const bool is_reachable = std::any_of(reachable.begin(), reachable.end(),
+                                                          [other](const transport::ReachableStop& item) {
+                                                              return item.stop == other;
+                                                          });
+                    CHECK(is_reachable || !travel_time || *travel_time > max_time - 1e-9);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestSmallNetwork);
+    RUN_TEST(TestMatchesAllPairs);
+    RUN_TEST(TestRouterMatchesTravelTimes);
+    return testing::Finish();
+}
@@ -0,0 +1,106 @@
+#include "k_shortest_paths.h"
+#include "testing.h"
+#include "test_networks.h"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <vector>
+
+namespace {
+/**
+ * Веса всех простых путей из from в to по возрастанию (перебор в глубину)
+ */
+std::vector<double> EnumerateSimplePathWeights(const graph::DirectedWeightedGraph<double>& graph,
+                                               graph::VertexId from, graph::VertexId to) {
+    std::vector<double> weights;
+    std::vector<char> visited(graph.GetVertexCount(), 0);
+    const std::function<void(graph::VertexId, double)> visit = [&](graph::VertexId vertex, double weight) {
+        if (vertex == to) {
+            weights.push_back(weight);
+            return;
+        }
+        visited[vertex] = 1;
+        for (const graph::EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const graph::VertexId next = graph.GetEdgeTarget(edge_id);
+            if (!visited[next]) {
+                visit(next, weight + graph.GetEdgeWeight(edge_id));
+            }
+        }
+        visited[vertex] = 0;
+    };
+    visit(from, 0.0);
+    std::sort(weights.begin(), weights.end());
+    return weights;
+}
+/**
+ * Путь не проходит ни одну вершину дважды
+ */
+bool IsSimplePath(const graph::DirectedWeightedGraph<double>& graph, graph::VertexId from,
+                  const std::vector<graph::EdgeId>& edges) {
+    std::set<graph::VertexId> vertices = {from};
+    for (const graph::EdgeId edge_id : edges) {
+        if (!vertices.insert(graph.GetEdgeTarget(edge_id)).second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestSmallNetwork() {
+    // 0 → 1 → 3 (2), 0 → 2 → 3 (3), 0 → 3 (4), 0 → 1 → 2 → 3 (1 + 1 + 2 = 4)
+    graph::DirectedWeightedGraph<double> graph(4);
+    graph.AddEdge({0, 1, 0, 1, 1.0});
+    graph.AddEdge({1, 1, 1, 3, 1.0});
+    graph.AddEdge({2, 1, 0, 2, 1.0});
+    graph.AddEdge({3, 1, 2, 3, 2.0});
+    graph.AddEdge({4, 1, 0, 3, 4.0});
+    graph.AddEdge({5, 1, 1, 2, 1.0});
+    graph.AddEdge({6, 1, 3, 0, 1.0});
+    graph.Freeze();
+    const graph::KShortestPaths<double> paths(graph, 3);
+    const auto routes = paths.Find(0, 10);
+    CHECK(routes.size() == 4);
+    const std::vector<double> expected_weights = {2.0, 3.0, 4.0, 4.0};
+    for (size_t i = 0; i < routes.size() && i < expected_weights.size(); ++i) {
+        CHECK(routes[i].weight == expected_weights[i]);
+        CHECK(testing::IsPath(graph, 0, 3, routes[i].edges, routes[i].weight));
+    }
+    CHECK(paths.Find(0, 0).empty());
+    CHECK(paths.Find(0, 1).size() == 1);
+}
+/**
+ * Первые k путей совпадают по весам с перебором всех простых путей;
+ * все пути простые и различны
+ */
+void TestMatchesEnumeration() {
+    for (uint32_t seed = 1; seed <= 30; ++seed) {
+        const auto graph = testing::MakeRandomGraph(seed, 7, 12 + seed % 10, 6);
+        for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+            const graph::KShortestPaths<double> paths(graph, to);
+            for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+                const auto all_weights = EnumerateSimplePathWeights(graph, from, to);
+                for (const size_t k : {size_t{1}, size_t{4}, size_t{50}}) {
+                    const auto routes = paths.Find(from, k);
+                    CHECK(routes.size() == std::min(k, all_weights.size()));
+                    std::set<std::vector<graph::EdgeId>> distinct_routes;
+                    for (size_t i = 0; i < routes.size() && i < all_weights.size(); ++i) {
+                        CHECK(routes[i].weight == all_weights[i]);
+                        CHECK(testing::IsPath(graph, from, to, routes[i].edges, routes[i].weight));
+                        CHECK(IsSimplePath(graph, from, routes[i].edges));
+                        distinct_routes.insert(routes[i].edges);
+                    }
+                    CHECK(distinct_routes.size() == routes.size());
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestSmallNetwork);
+    RUN_TEST(TestMatchesEnumeration);
+    return testing::Finish();
+}
@@ -0,0 +1,115 @@
+#include "min_plus_kernel.h"
+#include "testing.h"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr float INFINITE_WEIGHT = std::numeric_limits<float>::infinity();
+constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+/**
+ * Строки таблицы маршрутов: строка через вершину и релаксируемая строка
+ */
+struct Rows {
+    std::vector<float> weights_through;
+    std::vector<uint32_t> prev_edges_through;
+    std::vector<float> weights;
+    std::vector<uint32_t> prev_edges;
+};
+/**
+ * Случайные строки с бесконечными весами, отсутствующими рёбрами и кандидатами,
+ * равными текущему весу. Веса — целые числа, поэтому суммы точны.
+ */
+Rows MakeRows(std::mt19937& generator, float weight_from, size_t count) {
+    std::uniform_int_distribution<int> weight_distribution(0, 40);
+    Rows rows;
+    for (size_t j = 0; j < count; ++j) {
+        const auto through = static_cast<float>(weight_distribution(generator));
+        rows.weights_through.push_back(generator() % 5 == 0 ? INFINITE_WEIGHT : through);
+        rows.prev_edges_through.push_back(generator() % 4 == 0 ? NO_EDGE : static_cast<uint32_t>(generator() % 1000));
+        switch (generator() % 4) {
+        case 0:
+            rows.weights.push_back(INFINITE_WEIGHT);
+            break;
+        case 1:
+            // кандидат равен текущему весу: строгое сравнение его не принимает
+            rows.weights.push_back(weight_from + through);
+            break;
+        default:
+            rows.weights.push_back(static_cast<float>(weight_distribution(generator)));
+        }
+        rows.prev_edges.push_back(static_cast<uint32_t>(generator() % 1000));
+    }
+    return rows;
+}
+/**
+ * Каждое поддерживаемое ядро даёт ту же строку, что и скалярный цикл,
+ * для длин, не кратных ширине вектора, и не трогает элементы за концом строки
+ */
+void TestKernelsMatchScalar() {
+    const auto initial_kernel = graph::GetMinPlusKernel();
+    CHECK(graph::IsMinPlusKernelSupported(graph::MinPlusKernel::SCALAR));
+    for (const auto kernel : {graph::MinPlusKernel::SCALAR, graph::MinPlusKernel::AVX2,
+                              graph::MinPlusKernel::AVX512}) {
+        if (!graph::IsMinPlusKernelSupported(kernel)) {
+            CHECK(!graph::SetMinPlusKernel(kernel));
+            continue;
+        }
+        CHECK(graph::SetMinPlusKernel(kernel));
+        CHECK(graph::GetMinPlusKernel() == kernel);
+        std::mt19937 generator(static_cast<uint32_t>(kernel) + 1);
+        for (size_t count = 0; count <= 70; ++count) {
+            for (const float weight_from : {0.0f, 3.0f, 17.0f, INFINITE_WEIGHT}) {
+                const uint32_t prev_edge_from = static_cast<uint32_t>(generator() % 1000);
+                const Rows rows = MakeRows(generator, weight_from, count);
+                auto expected_weights = rows.weights;
+                auto expected_prev_edges = rows.prev_edges;
+                graph::RelaxMinPlusRow<float>(weight_from, prev_edge_from, rows.weights_through.data(),
+                                              rows.prev_edges_through.data(), expected_weights.data(),
+                                              expected_prev_edges.data(), count);
+                // за концом строки — метки, которые ядро не должно изменить
+                auto weights = rows.weights;
+                auto prev_edges = rows.prev_edges;
+                weights.push_back(-1.0f);
+                prev_edges.push_back(12345);
+                auto weights_through = rows.weights_through;
+                auto prev_edges_through = rows.prev_edges_through;
+                weights_through.push_back(0.0f);
+                prev_edges_through.push_back(NO_EDGE);
+                graph::RelaxMinPlusRow(weight_from, prev_edge_from, weights_through.data(),
+                                       prev_edges_through.data(), weights.data(), prev_edges.data(), count);
+                CHECK(weights.back() == -1.0f && prev_edges.back() == 12345);
+                weights.pop_back();
+                prev_edges.pop_back();
+                CHECK(weights == expected_weights);
+                CHECK(prev_edges == expected_prev_edges);
+            }
+        }
+    }
+    graph::SetMinPlusKernel(initial_kernel);
+}
+/**
+ * Строка с известным результатом
+ */
+void TestSmallRow() {
+    const std::vector<float> weights_through = {1.0f, INFINITE_WEIGHT, 2.0f, 0.0f, 5.0f};
+    const std::vector<uint32_t> prev_edges_through = {10, 11, NO_EDGE, 13, 14};
+    std::vector<float> weights = {INFINITE_WEIGHT, INFINITE_WEIGHT, 9.0f, 3.0f, 8.0f};
+    std::vector<uint32_t> prev_edges = {NO_EDGE, NO_EDGE, 20, 21, 22};
+    graph::RelaxMinPlusRow(3.0f, 7, weights_through.data(), prev_edges_through.data(), weights.data(),
+                           prev_edges.data(), weights.size());
+    // 0 — улучшен; 1 — бесконечный кандидат; 2 — улучшен, ребро вершины; 3 — равен; 4 — хуже
+    CHECK(weights == (std::vector<float>{4.0f, INFINITE_WEIGHT, 5.0f, 3.0f, 8.0f}));
+    CHECK(prev_edges == (std::vector<uint32_t>{10, NO_EDGE, 7, 21, 22}));
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestKernelsMatchScalar);
+    RUN_TEST(TestSmallRow);
+    return testing::Finish();
+}
@@ -0,0 +1,115 @@
+#include "pareto_router.h"
+#include "testing.h"
+#include "test_networks.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace {
+/**
+ * Вес и количество учитываемых рёбер пути из множества Парето
+ */
+using Criteria = std::pair<double, size_t>;
+
+template <typename IsCountedEdge>
+std::vector<Criteria> GetCriteria(const std::vector<graph::ParetoRouter<double>::ParetoRoute>& routes,
+                                  const graph::DirectedWeightedGraph<double>& graph, graph::VertexId from,
+                                  graph::VertexId to, IsCountedEdge is_counted) {
+    std::vector<Criteria> criteria;
+    for (const auto& route : routes) {
+        const auto count = std::count_if(route.edges.begin(), route.edges.end(), is_counted);
+        CHECK(testing::IsPath(graph, from, to, route.edges, route.weight));
+        CHECK(static_cast<size_t>(count) == route.count);
+        criteria.emplace_back(route.weight, route.count);
+    }
+    return criteria;
+}
+/**
+ * Множество Парето перебором: наименьший вес пути не более чем с c учитываемыми рёбрами
+ * для каждого c (релаксацией Беллмана–Форда по парам вершина, количество)
+ */
+template <typename IsCountedEdge>
+std::vector<Criteria> ComputeParetoFront(const graph::DirectedWeightedGraph<double>& graph, graph::VertexId from,
+                                         graph::VertexId to, IsCountedEdge is_counted,
+                                         std::optional<size_t> max_count) {
+    const size_t count_limit = max_count ? *max_count : graph.GetVertexCount();
+    std::vector<std::vector<std::optional<double>>> weights(count_limit + 1,
+            std::vector<std::optional<double>>(graph.GetVertexCount()));
+    weights[0][from] = 0.0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t count = 0; count <= count_limit; ++count) {
+            for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+                const auto& weight = weights[count][graph.GetEdgeSource(edge_id)];
+                const size_t next_count = count + (is_counted(edge_id) ? 1 : 0);
+                if (!weight || next_count > count_limit) {
+                    continue;
+                }
+                auto& next_weight = weights[next_count][graph.GetEdgeTarget(edge_id)];
+                const double candidate = *weight + graph.GetEdgeWeight(edge_id);
+                if (!next_weight || candidate < *next_weight) {
+                    next_weight = candidate;
+                    changed = true;
+                }
+            }
+        }
+    }
+    std::vector<Criteria> front;
+    for (size_t count = 0; count <= count_limit; ++count) {
+        if (weights[count][to] && (front.empty() || *weights[count][to] < front.back().first)) {
+            front.emplace_back(*weights[count][to], count);
+        }
+    }
+    std::reverse(front.begin(), front.end());
+    return front;
+}
+
+void TestSmallNetwork() {
+    // 0 → 1 → 2 по двум учитываемым рёбрам (2), 0 → 2 по одному (5) и по неучитываемому (10)
+    graph::DirectedWeightedGraph<double> graph(3);
+    graph.AddEdge({0, 1, 0, 1, 1.0});
+    graph.AddEdge({1, 1, 1, 2, 1.0});
+    graph.AddEdge({2, 1, 0, 2, 5.0});
+    graph.AddEdge({3, 0, 0, 2, 10.0});
+    graph.Freeze();
+    const auto is_counted = [&graph](graph::EdgeId edge_id) {
+        return graph.GetEdge(edge_id).quantity != 0;
+    };
+    const graph::ParetoRouter<double> router(graph);
+    CHECK(GetCriteria(router.BuildRoutes(0, 2, is_counted), graph, 0, 2, is_counted)
+          == (std::vector<Criteria>{{2.0, 2}, {5.0, 1}, {10.0, 0}}));
+    CHECK(GetCriteria(router.BuildRoutes(0, 2, is_counted, 1), graph, 0, 2, is_counted)
+          == (std::vector<Criteria>{{5.0, 1}, {10.0, 0}}));
+    CHECK(router.BuildRoutes(2, 0, is_counted).empty());
+}
+/**
+ * Множество Парето совпадает с перебором по количеству учитываемых рёбер
+ */
+void TestMatchesLayeredSearch() {
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        const auto graph = testing::MakeRandomGraph(seed, 15, 40 + seed * 3, 10);
+        const auto is_counted = [&graph](graph::EdgeId edge_id) {
+            return graph.GetEdge(edge_id).title_id % 3 != 0;
+        };
+        const graph::ParetoRouter<double> router(graph);
+        for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+            for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+                for (const auto max_count : {std::optional<size_t>{}, std::optional<size_t>{1}}) {
+                    const auto routes = router.BuildRoutes(from, to, is_counted, max_count);
+                    CHECK(GetCriteria(routes, graph, from, to, is_counted)
+                          == ComputeParetoFront(graph, from, to, is_counted, max_count));
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestSmallNetwork);
+    RUN_TEST(TestMatchesLayeredSearch);
+    return testing::Finish();
+}
@@ -0,0 +1,131 @@
+#include "raptor.h"
+#include "testing.h"
+#include "test_networks.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+/**
+ * Маршруты A: 0 → 1 → 2 и B: 1 → 3 по расписанию, C: 0 → 3 без расписания
+ * (ожидание 5 минут)
+ */
+transit::RaptorRouter MakeSmallNetwork() {
+    const std::vector<transit::TransitRoute> routes = {
+        {{0, 1, 2}, {0.0, 10.0, 20.0}, {0.0, 30.0, 60.0}},
+        {{1, 3}, {0.0, 5.0}, {15.0, 45.0}},
+        {{0, 3}, {0.0, 50.0}, {}},
+    };
+    return transit::RaptorRouter(4, routes, 5.0);
+}
+/**
+ * Поездки пути следуют друг за другом от from до to
+ */
+bool IsJourney(const transit::RaptorRouter& router, const transit::RaptorRouter::Journey& journey,
+               transit::StopIndex from, transit::StopIndex to, double departure_time) {
+    transit::StopIndex stop = from;
+    double time = departure_time;
+    for (const auto& leg : journey.legs) {
+        if (router.GetStop(leg.route, leg.board_position) != stop || leg.board_time < time
+            || leg.board_position >= leg.alight_position || leg.arrival_time < leg.board_time) {
+            return false;
+        }
+        stop = router.GetStop(leg.route, leg.alight_position);
+        time = leg.arrival_time;
+    }
+    return stop == to && time == journey.arrival_time;
+}
+
+void TestSmallNetwork() {
+    const auto router = MakeSmallNetwork();
+    const struct {
+        double departure_time;
+        double arrival_time;
+        size_t leg_count;
+    } expected_journeys[] = {
+        {0.0, 20.0, 2},   // A в 0:00 до 1, B в 0:15 до 3
+        {1.0, 50.0, 2},   // A в 0:30, B в 0:45
+        {31.0, 86.0, 1},  // рейсов B больше нет: C после ожидания
+    };
+    for (const auto& expected : expected_journeys) {
+        const auto journey = router.BuildJourney(0, 3, expected.departure_time);
+        CHECK(journey.has_value());
+        if (journey) {
+            CHECK(journey->arrival_time == expected.arrival_time);
+            CHECK(journey->legs.size() == expected.leg_count);
+            CHECK(IsJourney(router, *journey, 0, 3, expected.departure_time));
+        }
+    }
+    CHECK(!router.BuildJourney(3, 0, 0.0));
+
+    const auto pareto_journeys = router.BuildParetoJourneys(0, 3, 0.0);
+    CHECK(pareto_journeys.size() == 2);
+    if (pareto_journeys.size() == 2) {
+        CHECK(pareto_journeys[0].arrival_time == 20.0 && pareto_journeys[0].legs.size() == 2);
+        CHECK(pareto_journeys[1].arrival_time == 55.0 && pareto_journeys[1].legs.size() == 1);
+    }
+    const std::vector<std::optional<double>> expected_arrivals = {0.0, 10.0, 20.0, 20.0};
+    CHECK(router.BuildArrivalTimes(0, 0.0) == expected_arrivals);
+}
+/**
+ * Без расписаний время прибытия совпадает с кратчайшим путём в графе с рёбрами
+ * ожидания и поездок между каждой остановкой маршрута и каждой последующей
+ */
+void TestFrequencyRoutesMatchDijkstra() {
+    const double wait_time = 4.0;
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        std::mt19937 generator(seed);
+        const size_t stop_count = 10 + seed % 15;
+        std::vector<transit::TransitRoute> routes(3 + seed % 8);
+        for (auto& route : routes) {
+            const size_t length = 2 + generator() % 6;
+            double ride_time = 0.0;
+            for (size_t position = 0; position < length; ++position) {
+                route.stops.push_back(generator() % stop_count);
+                ride_time += position == 0 ? 0.0 : static_cast<double>(1 + generator() % 15);
+                route.ride_times.push_back(ride_time);
+            }
+        }
+        const transit::RaptorRouter router(stop_count, routes, wait_time);
+        // вершина 2s — остановка s, 2s + 1 — посадка на ней
+        graph::DirectedWeightedGraph<double> graph(stop_count * 2);
+        for (size_t stop = 0; stop < stop_count; ++stop) {
+            graph.AddEdge({0, 0, stop * 2, stop * 2 + 1, wait_time});
+        }
+        for (const auto& route : routes) {
+            for (size_t from = 0; from < route.stops.size(); ++from) {
+                for (size_t to = from + 1; to < route.stops.size(); ++to) {
+                    graph.AddEdge({0, to - from, route.stops[from] * 2 + 1, route.stops[to] * 2,
+                                   route.ride_times[to] - route.ride_times[from]});
+                }
+            }
+        }
+        graph.Freeze();
+        const double departure_time = 100.0;
+        for (transit::StopIndex from = 0; from < stop_count; ++from) {
+            const graph::ShortestPathTree<double> tree(graph, from * 2);
+            const auto arrivals = router.BuildArrivalTimes(from, departure_time);
+            for (transit::StopIndex to = 0; to < stop_count; ++to) {
+                const auto weight = tree.GetWeight(to * 2);
+                CHECK(arrivals[to].has_value() == weight.has_value());
+                if (arrivals[to] && weight) {
+                    CHECK(*arrivals[to] == departure_time + *weight);
+                }
+                const auto journey = router.BuildJourney(from, to, departure_time);
+                CHECK(journey.has_value() == weight.has_value());
+                if (journey && weight) {
+                    CHECK(journey->arrival_time == departure_time + *weight);
+                    CHECK(IsJourney(router, *journey, from, to, departure_time));
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestSmallNetwork);
+    RUN_TEST(TestFrequencyRoutesMatchDijkstra);
+    return testing::Finish();
+}
@@ -0,0 +1,121 @@
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "testing.h"
+#include "transport_router.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string ROUTING_SETTINGS = R"("routing_settings": {"bus_wait_time": 2, "bus_velocity": 30})";
+/**
+ * Запросы статистики маршрутов и оптимальных маршрутов между всеми остановками
+ */
+std::string MakeStatRequests() {
+    const std::vector<std::string> stops = {"A", "B", "C", "D"};
+    std::string requests;
+    int id = 1;
+    for (const std::string bus : {"1", "2", "3", "4"}) {
+        requests += R"({"id": )" + std::to_string(id++) + R"(, "type": "Bus", "name": ")" + bus + R"("},)";
+    }
+    for (const auto& from : stops) {
+        for (const auto& to : stops) {
+            requests += R"({"id": )" + std::to_string(id++) + R"(, "type": "Route", "from": ")" + from
+                    + R"(", "to": ")" + to + R"("},)";
+        }
+    }
+    requests.pop_back();
+    return R"("stat_requests": [)" + requests + "]";
+}
+/**
+ * Остановки A, B, C, D и расстояния между ними; road_distances_b — расстояния от B
+ */
+std::string MakeStops(const std::string& road_distances_b) {
+    return R"({"type": "Stop", "name": "A", "latitude": 55.60, "longitude": 37.60,
+               "road_distances": {"B": 1000, "D": 3000}},
+              {"type": "Stop", "name": "B", "latitude": 55.61, "longitude": 37.61,
+               "road_distances": )" + road_distances_b + R"(},
+              {"type": "Stop", "name": "C", "latitude": 55.62, "longitude": 37.60,
+               "road_distances": {"D": 1500}},
+              {"type": "Stop", "name": "D", "latitude": 55.61, "longitude": 37.59})";
+}
+/**
+ * Ответы на запросы входного документа так же, как в main
+ */
+std::string ProcessInput(const std::string& input_text) {
+    JsonReader json_doc;
+    std::istringstream input(input_text);
+    json_doc.ReadInput(input);
+    renderer::MapRenderer renderer(json_doc.GetRenderSettings());
+    transport::Router router(json_doc.GetRoutingSettings());
+    RequestHandler handler(renderer, router);
+    json_doc.UploadData(handler);
+    json_doc.ApplyUpdates(handler);
+    std::ostringstream output;
+    json_doc.PrintResponses(handler, output);
+    return output.str();
+}
+/**
+ * Изменения update_requests дают те же ответы, что и исходные данные с этими изменениями;
+ * маршрут с неизвестной остановкой не добавляется
+ */
+void TestUpdateRequestsMatchBaseRequests() {
+    const std::string updated_input = "{" + ROUTING_SETTINGS + R"(, "base_requests": [)"
+            + MakeStops(R"({"C": 2000, "D": 800})") + R"(,
+              {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false},
+              {"type": "Bus", "name": "2", "stops": ["B", "D"], "is_roundtrip": false}],
+            "update_requests": [
+              {"type": "Stop", "name": "B", "road_distances": {"C": 500, "X": 100}},
+              {"type": "Bus", "name": "2", "stops": ["B", "C", "D", "B"], "is_roundtrip": true},
+              {"type": "Bus", "name": "3", "stops": ["A", "X"], "is_roundtrip": false},
+              {"type": "Bus", "name": "1", "stops": ["A", "X", "C"], "is_roundtrip": false},
+              {"type": "Bus", "name": "4", "stops": ["D", "A"], "is_roundtrip": false}],
+            )" + MakeStatRequests() + "}";
+    const std::string expected_input = "{" + ROUTING_SETTINGS + R"(, "base_requests": [)"
+            + MakeStops(R"({"C": 500, "D": 800})") + R"(,
+              {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false},
+              {"type": "Bus", "name": "2", "stops": ["B", "C", "D", "B"], "is_roundtrip": true},
+              {"type": "Bus", "name": "4", "stops": ["D", "A"], "is_roundtrip": false}],
+            )" + MakeStatRequests() + "}";
+    const std::string expected = ProcessInput(expected_input);
+    CHECK(expected.find("not found") != std::string::npos);
+    CHECK(ProcessInput(updated_input) == expected);
+}
+/**
+ * Изменение с неизвестной остановкой отклоняется целиком
+ */
+void TestUnknownStopsAreRejected() {
+    renderer::MapRenderer renderer({});
+    transport::Router router(transport::RoutingSettings{});
+    RequestHandler handler(renderer, router);
+    handler.AddStop("A", {55.60, 37.60});
+    handler.AddStop("B", {55.61, 37.61});
+    handler.SetDistance("A", "B", 1000);
+    handler.AddRoute("1", {"A", "B"}, true);
+    handler.UpdateInternalData();
+    const auto& catalogue = handler.GetCatalogue();
+
+    CHECK(!handler.UpdateRoute("1", {"A", "X", "B"}, true));
+    CHECK(!handler.UpdateRoute("2", {"X", "Y"}, true));
+    CHECK(!handler.UpdateRoute("2", {}, true));
+    CHECK(!handler.UpdateDistance("A", "X", 500));
+    CHECK(catalogue.FindRoute("1")->stops.size() == 2);
+    CHECK(catalogue.FindRoute("2") == nullptr);
+
+    CHECK(handler.UpdateRoute("1", {"B", "A"}, true));
+    CHECK(handler.UpdateDistance("B", "A", 700));
+    handler.ApplyUpdates();
+    CHECK(catalogue.FindRoute("1")->stops.front() == catalogue.FindStop("B"));
+    CHECK(catalogue.GetDistance(catalogue.FindStop("B"), catalogue.FindStop("A")) == 700);
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestUpdateRequestsMatchBaseRequests);
+    RUN_TEST(TestUnknownStopsAreRejected);
+    return testing::Finish();
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+/**
+ * Графы для тестов алгоритмов маршрутизации
+ */
+namespace testing {
+/**
+ * Случайный замороженный граф. Веса рёбер — целые числа от 1 до max_weight:
+ * суммы весов точны, а равные по весу пути встречаются часто.
+ */
+inline graph::DirectedWeightedGraph<double> MakeRandomGraph(uint32_t seed, size_t vertex_count, size_t edge_count,
+                                                            int max_weight = 20) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> vertex_distribution(0, vertex_count - 1);
+    std::uniform_int_distribution<int> weight_distribution(1, max_weight);
+    graph::DirectedWeightedGraph<double> graph(vertex_count);
+    for (size_t i = 0; i < edge_count; ++i) {
+        const graph::VertexId from = vertex_distribution(generator);
+        const graph::VertexId to = vertex_distribution(generator);
+        graph.AddEdge({i, 1, from, to, static_cast<double>(weight_distribution(generator))});
+    }
+    graph.Freeze();
+    return graph;
+}
+/**
+ * Является ли список рёбер путём из from в to с весом weight
+ */
+inline bool IsPath(const graph::DirectedWeightedGraph<double>& graph, graph::VertexId from, graph::VertexId to,
+                   const std::vector<graph::EdgeId>& edges, double weight) {
+    graph::VertexId vertex = from;
+    double path_weight = 0.0;
+    for (const graph::EdgeId edge_id : edges) {
+        if (edge_id >= graph.GetEdgeCount() || graph.GetEdgeSource(edge_id) != vertex) {
+            return false;
+        }
+        vertex = graph.GetEdgeTarget(edge_id);
+        path_weight += graph.GetEdgeWeight(edge_id);
+    }
+    return vertex == to && path_weight == weight;
+}
+/**
+ * Веса кратчайших путей между всеми парами вершин поиском Дейкстры
+ */
+inline std::vector<std::vector<std::optional<double>>> ComputeAllPairsWeights(
+        const graph::DirectedWeightedGraph<double>& graph) {
+    std::vector<std::vector<std::optional<double>>> weights;
+    std::vector<graph::VertexId> vertices(graph.GetVertexCount());
+    for (graph::VertexId vertex = 0; vertex < vertices.size(); ++vertex) {
+        vertices[vertex] = vertex;
+    }
+    for (const graph::VertexId from : vertices) {
+        weights.push_back(graph::ShortestPathTree<double>(graph, from).GetWeights(vertices));
+    }
+    return weights;
+}
+
+/**
+ * Заполнить пустой каталог случайной сетью: остановки S0, S1, ... и автобусы B0, B1, ...
+ * Маршруты часто проходят одни и те же перегоны, расстояния — целые метры.
+ */
+inline void FillRandomCatalogue(transport::Catalogue& catalogue, uint32_t seed, size_t stop_count,
+                                size_t bus_count) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> coordinate_distribution(0.0, 0.05);
+    std::uniform_int_distribution<int> distance_distribution(300, 3000);
+    for (size_t i = 0; i < stop_count; ++i) {
+        catalogue.AddStop({"S" + std::to_string(i),
+                           {55.6 + coordinate_distribution(generator), 37.5 + coordinate_distribution(generator)}});
+    }
+    std::vector<const transport::Stop*> stops;
+    for (size_t i = 0; i < stop_count; ++i) {
+        stops.push_back(catalogue.FindStop("S" + std::to_string(i)));
+    }
+    for (size_t i = 0; i < bus_count; ++i) {
+        std::shuffle(stops.begin(), stops.end(), generator);
+        const size_t length = std::uniform_int_distribution<size_t>(2, std::min<size_t>(8, stop_count))(generator);
+        std::vector<const transport::Stop*> route(stops.begin(), stops.begin() + length);
+        const bool is_roundtrip = generator() % 3 == 0;
+        if (is_roundtrip) {
+            route.push_back(route.front());
+        }
+        for (size_t j = 0; j + 1 < route.size(); ++j) {
+            catalogue.SetDistance(route[j], route[j + 1], distance_distribution(generator));
+        }
+        catalogue.AddRoute("B" + std::to_string(i), route, is_roundtrip);
+    }
+}
+/**
+ * Текстовая запись ответа маршрутизатора для сравнения ответов целиком
+ */
+inline std::string ToString(const transport::RouterResponse& response) {
+    std::ostringstream output;
+    output.precision(17);
+    output << response.total_time << ':';
+    for (const auto& item : response.route) {
+        if (const auto departure = std::get_if<transport::RouterResponse::Departure>(&item)) {
+            output << " wait " << departure->stop_name << ' ' << departure->time;
+        }
+        else {
+            const auto& ride = std::get<transport::RouterResponse::Route>(item);
+            output << " bus " << ride.bus << ' ' << ride.span_count << ' ' << ride.time;
+        }
+    }
+    return output.str();
+}
+
+}  // namespace testing
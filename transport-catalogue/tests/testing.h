@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+/**
+ * Средства модульных тестов: проверки и запуск тестовых функций.
+ * Проваленная проверка не прерывает тест, а увеличивает счётчик ошибок;
+ * код возврата программы (Finish) ненулевой, если хотя бы одна проверка провалена.
+ */
+namespace testing {
+/**
+ * Количество проваленных проверок
+ */
+inline int& GetFailureCount() {
+    static int failure_count = 0;
+    return failure_count;
+}
+
+inline void Check(bool condition, const char* expression, const char* file, int line) {
+    if (!condition) {
+        ++GetFailureCount();
+        std::cerr << file << ':' << line << ": check failed: " << expression << '\n';
+    }
+}
+
+inline void CheckNear(double lhs, double rhs, double tolerance, const char* expression,
+                      const char* file, int line) {
+    if (!(std::abs(lhs - rhs) <= tolerance)) {
+        ++GetFailureCount();
+        std::cerr << file << ':' << line << ": check failed: " << expression
+                  << " (" << lhs << " vs " << rhs << ")\n";
+    }
+}
+/**
+ * Выполнить тест; исключение считается проваленной проверкой
+ */
+template <typename Test>
+void Run(Test test, const char* name) {
+    const int failure_count = GetFailureCount();
+    try {
+        test();
+    }
+    catch (const std::exception& error) {
+        ++GetFailureCount();
+        std::cerr << name << ": exception: " << error.what() << '\n';
+    }
+    std::cerr << name << (GetFailureCount() == failure_count ? " OK" : " FAILED") << '\n';
+}
+/**
+ * Код возврата программы тестов
+ */
+inline int Finish() {
+    return GetFailureCount() == 0 ? 0 : 1;
+}
+
+}  // namespace testing
+
+#define CHECK(expression) ::testing::Check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+#define CHECK_NEAR(lhs, rhs, tolerance) \
+    ::testing::CheckNear((lhs), (rhs), (tolerance), #lhs " == " #rhs, __FILE__, __LINE__)
+#define RUN_TEST(test) ::testing::Run(test, #test)
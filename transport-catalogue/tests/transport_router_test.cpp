@@ -0,0 +1,430 @@
+#include "testing.h"
+#include "test_networks.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+const std::string CACHE_FILE = "transport_router_test.cache";
+
+transport::RoutingSettings MakeSettings(
+        transport::RoutingAlgorithm algorithm = transport::RoutingAlgorithm::FLOYD_WARSHALL) {
+    transport::RoutingSettings settings;
+    settings.bus_wait_time = 3;
+    settings.bus_velocity = 30.0;
+    settings.algorithm = algorithm;
+    settings.thread_count = 2;
+    return settings;
+}
+
+transport::RoutingSettings MakeCachedSettings() {
+    auto settings = MakeSettings();
+    settings.cache_file = CACHE_FILE;
+    settings.cache_key = 42;
+    return settings;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(content.data(), content.size());
+}
+/**
+ * Ответы маршрутизатора на все виды запросов между всеми остановками каталога
+ */
+std::vector<std::string> CollectAnswers(const transport::Router& router, const transport::Catalogue& catalogue) {
+    std::vector<std::string> answers;
+    const auto stops = catalogue.GetStops(transport::SORTED);
+    for (const auto from : stops) {
+        for (const auto to : stops) {
+            const auto route = router.GetOptimalRoute(from, to);
+            answers.push_back(route ? testing::ToString(*route) : "none");
+            std::string routes = "k:";
+            for (const auto& response : router.GetOptimalRoutes(from, to, 3)) {
+                routes += ' ' + testing::ToString(response);
+            }
+            answers.push_back(routes);
+            std::string pareto_routes = "pareto:";
+            for (const auto& response : router.GetParetoRoutes(from, to)) {
+                pareto_routes += ' ' + std::to_string(response.transfers) + ' ' + testing::ToString(response.response);
+            }
+            answers.push_back(pareto_routes);
+        }
+        for (const bool reverse : {false, true}) {
+            std::string reachable = "reachable:";
+            for (const auto& [stop, time] : router.GetReachableStops(from, 20.0, reverse)) {
+                reachable += ' ' + stop->name + ' ' + std::to_string(time);
+            }
+            answers.push_back(reachable);
+        }
+    }
+    return answers;
+}
+/**
+ * Маршрутизатор, загруженный из файла, отвечает так же, как построенный заново
+ */
+void TestCacheMatchesFreshBuild() {
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        transport::Catalogue catalogue;
+        testing::FillRandomCatalogue(catalogue, seed, 15, 8);
+        transport::Router fresh(MakeSettings());
+        fresh.Build(catalogue);
+        const auto expected = CollectAnswers(fresh, catalogue);
+
+        std::remove(CACHE_FILE.c_str());
+        transport::Router cold(MakeCachedSettings());
+        cold.Build(catalogue);
+        CHECK(!ReadFile(CACHE_FILE).empty());
+        CHECK(CollectAnswers(cold, catalogue) == expected);
+        transport::Router warm(MakeCachedSettings());
+        warm.Build(catalogue);
+        CHECK(CollectAnswers(warm, catalogue) == expected);
+    }
+    std::remove(CACHE_FILE.c_str());
+}
+/**
+ * Обрезанный файл или файл с повреждёнными разделами до таблицы маршрутов
+ * не загружается, маршрутизатор строится заново. Таблица при загрузке не читается:
+ * повреждённые последние рёбра маршрутов обнаруживаются при восстановлении маршрута.
+ */
+void TestCorruptedCacheIsRebuilt() {
+    transport::Catalogue catalogue;
+    testing::FillRandomCatalogue(catalogue, 7, 15, 8);
+    std::remove(CACHE_FILE.c_str());
+    transport::Router original(MakeCachedSettings());
+    original.Build(catalogue);
+    const auto expected = CollectAnswers(original, catalogue);
+    const std::string content = ReadFile(CACHE_FILE);
+    CHECK(content.size() > 64);
+    // таблица из 30 вершин в конце файла: веса double и 32-битные последние рёбра
+    const size_t vertex_count = 30;
+    const size_t table_size = vertex_count * vertex_count * (sizeof(double) + sizeof(uint32_t));
+    CHECK(content.size() > table_size);
+    const size_t table_begin = content.size() - table_size;
+
+    std::vector<std::string> corrupted_files = {content.substr(0, content.size() / 2), content.substr(0, 40)};
+    for (const size_t position : {size_t{16}, size_t{40}, table_begin / 3, table_begin / 2, table_begin - 1}) {
+        std::string corrupted = content;
+        corrupted[position] = static_cast<char>(corrupted[position] ^ 0x5a);
+        corrupted_files.push_back(corrupted);
+    }
+    for (const auto& corrupted : corrupted_files) {
+        WriteFile(CACHE_FILE, corrupted);
+        transport::Router router(MakeCachedSettings());
+        router.Build(catalogue);
+        CHECK(CollectAnswers(router, catalogue) == expected);
+        // повреждённый файл заменяется исправным
+        CHECK(ReadFile(CACHE_FILE) == content);
+    }
+
+    // последние рёбра маршрутов вне графа: запрос маршрута сообщает о повреждении
+    std::string corrupted = content;
+    std::fill(corrupted.end() - vertex_count * vertex_count * sizeof(uint32_t), corrupted.end(), '\x7f');
+    WriteFile(CACHE_FILE, corrupted);
+    transport::Router router(MakeCachedSettings());
+    router.Build(catalogue);
+    const auto stop = catalogue.FindStop("S0");
+    bool is_thrown = false;
+    try {
+        router.GetOptimalRoute(stop, stop);
+    } catch (const std::runtime_error&) {
+        is_thrown = true;
+    }
+    CHECK(is_thrown);
+    std::remove(CACHE_FILE.c_str());
+}
+/**
+ * Инкрементальное обновление сохраняет обновлённый маршрутизатор в файл
+ */
+void TestUpdateSavesCache() {
+    transport::Catalogue catalogue;
+    testing::FillRandomCatalogue(catalogue, 3, 15, 8);
+    std::remove(CACHE_FILE.c_str());
+    transport::Router router(MakeCachedSettings());
+    router.Build(catalogue);
+    const std::string content = ReadFile(CACHE_FILE);
+
+    const auto bus = catalogue.FindRoute("B0");
+    catalogue.SetDistance(bus->stops[0], bus->stops[1], 100);
+    router.Update(catalogue, {{}, {{bus->stops[0], bus->stops[1]}}});
+    const std::string updated_content = ReadFile(CACHE_FILE);
+    CHECK(!updated_content.empty());
+    CHECK(updated_content != content);
+
+    transport::Router fresh(MakeSettings());
+    fresh.Build(catalogue);
+    const auto expected = CollectAnswers(fresh, catalogue);
+    CHECK(CollectAnswers(router, catalogue) == expected);
+    // файл с ключом исходных данных больше не подходит к изменённому каталогу
+    transport::Router reloaded(MakeCachedSettings());
+    reloaded.Build(catalogue);
+    CHECK(CollectAnswers(reloaded, catalogue) == expected);
+    std::remove(CACHE_FILE.c_str());
+}
+
+/**
+ * Случайная правка каталога: новое расстояние перегона, новые остановки маршрута
+ * или новый маршрут. Возвращает изменения для Router::Update.
+ */
+transport::RouterUpdate EditCatalogue(transport::Catalogue& catalogue, std::mt19937& generator, size_t edit) {
+    const auto stops = catalogue.GetStops(transport::SORTED);
+    const auto buses = catalogue.GetBuses(transport::SORTED);
+    std::uniform_int_distribution<int> distance_distribution(300, 3000);
+    transport::RouterUpdate update;
+    if (edit % 3 == 0) {
+        const auto bus = buses[generator() % buses.size()];
+        const size_t position = generator() % (bus->stops.size() - 1);
+        catalogue.SetDistance(bus->stops[position], bus->stops[position + 1], distance_distribution(generator));
+        update.distances.emplace_back(bus->stops[position], bus->stops[position + 1]);
+        return update;
+    }
+    std::vector<const transport::Stop*> route;
+    for (size_t i = 0; i < 4; ++i) {
+        route.push_back(stops[generator() % stops.size()]);
+    }
+    for (size_t i = 0; i + 1 < route.size(); ++i) {
+        catalogue.SetDistance(route[i], route[i + 1], distance_distribution(generator));
+        update.distances.emplace_back(route[i], route[i + 1]);
+    }
+    // новые маршруты получают номера, которые при сортировке стоят перед прежними
+    const std::string bus_number = edit % 3 == 1 ? buses[generator() % buses.size()]->route
+                                                 : "A" + std::to_string(edit);
+    catalogue.UpdateRoute(bus_number, route, false);
+    update.buses.push_back(catalogue.FindRoute(bus_number));
+    return update;
+}
+/**
+ * После инкрементального обновления маршрутизатор отвечает так же, как построенный заново,
+ * включая выбор автобуса и места пересадки среди равных по времени маршрутов
+ */
+void TestUpdateMatchesFreshBuild() {
+    using transport::RoutingAlgorithm;
+    for (const auto algorithm : {RoutingAlgorithm::FLOYD_WARSHALL, RoutingAlgorithm::FLOYD_WARSHALL_PARALLEL,
+                                 RoutingAlgorithm::DIJKSTRA, RoutingAlgorithm::DIJKSTRA_CACHED,
+                                 RoutingAlgorithm::BIDIRECTIONAL_DIJKSTRA, RoutingAlgorithm::A_STAR,
+                                 RoutingAlgorithm::CONTRACTION_HIERARCHIES, RoutingAlgorithm::HUB_LABELS}) {
+        for (const bool prune_parallel_edges : {false, true}) {
+            auto settings = MakeSettings(algorithm);
+            settings.prune_parallel_edges = prune_parallel_edges;
+            for (uint32_t seed = 1; seed <= 3; ++seed) {
+                transport::Catalogue catalogue;
+                testing::FillRandomCatalogue(catalogue, seed, 12, 10);
+                transport::Router router(settings);
+                router.Build(catalogue);
+                std::mt19937 generator(seed);
+                for (size_t edit = 0; edit < 6; ++edit) {
+                    router.Update(catalogue, EditCatalogue(catalogue, generator, edit));
+                    transport::Router fresh(settings);
+                    fresh.Build(catalogue);
+                    CHECK(router.GetEdgeCount() == fresh.GetEdgeCount());
+                    CHECK(CollectAnswers(router, catalogue) == CollectAnswers(fresh, catalogue));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Времена ответов маршрутизатора на все виды запросов между всеми остановками каталога.
+ * Номера автобусов не сравниваются: в каталоге без закрытых перегонов части маршрутов
+ * названы иначе.
+ */
+std::vector<std::vector<double>> CollectTimes(const transport::Router& router, const transport::Catalogue& catalogue) {
+    std::vector<std::vector<double>> times;
+    const auto stops = catalogue.GetStops(transport::SORTED);
+    for (const auto from : stops) {
+        for (const auto to : stops) {
+            const auto route = router.GetOptimalRoute(from, to);
+            const auto travel_time = router.GetTravelTime(from, to);
+            times.push_back(route ? std::vector<double>{route->total_time} : std::vector<double>{});
+            times.push_back(travel_time ? std::vector<double>{*travel_time} : std::vector<double>{});
+            times.emplace_back();
+            for (const auto& response : router.GetOptimalRoutes(from, to, 3)) {
+                times.back().push_back(response.total_time);
+            }
+            times.emplace_back();
+            for (const auto& response : router.GetParetoRoutes(from, to)) {
+                times.back().push_back(static_cast<double>(response.transfers));
+                times.back().push_back(response.response.total_time);
+            }
+        }
+        for (const bool reverse : {false, true}) {
+            times.emplace_back();
+            for (const auto& [stop, time] : router.GetReachableStops(from, 20.0, reverse)) {
+                // номер остановки Sn
+                times.back().push_back(std::stod(stop->name.substr(1)));
+                times.back().push_back(time);
+            }
+        }
+    }
+    return times;
+}
+
+void CheckSameTimes(const std::vector<std::vector<double>>& lhs, const std::vector<std::vector<double>>& rhs) {
+    CHECK(lhs.size() == rhs.size());
+    for (size_t i = 0; i < lhs.size() && i < rhs.size(); ++i) {
+        CHECK(lhs[i].size() == rhs[i].size());
+        for (size_t j = 0; j < lhs[i].size() && j < rhs[i].size(); ++j) {
+            CHECK_NEAR(lhs[i][j], rhs[i][j], 1e-9);
+        }
+    }
+}
+/**
+ * Разрезать маршруты каталога по перегонам: части маршрута становятся отдельными автобусами
+ */
+void SplitRoutes(transport::Catalogue& catalogue,
+                 const std::set<std::pair<std::string, std::string>>& segments) {
+    std::vector<std::pair<std::string, std::vector<const transport::Stop*>>> routes;
+    for (const auto bus : catalogue.GetBuses(transport::SORTED)) {
+        routes.emplace_back(bus->route, bus->stops);
+    }
+    for (const auto& [bus_number, stops] : routes) {
+        std::vector<std::vector<const transport::Stop*>> parts(1);
+        for (size_t i = 0; i < stops.size(); ++i) {
+            if (i > 0 && segments.count({stops[i - 1]->name, stops[i]->name}) != 0) {
+                parts.emplace_back();
+            }
+            parts.back().push_back(stops[i]);
+        }
+        catalogue.UpdateRoute(bus_number, parts.front(), false);
+        for (size_t part = 1; part < parts.size(); ++part) {
+            catalogue.UpdateRoute(bus_number + '/' + std::to_string(part), parts[part], false);
+        }
+    }
+}
+/**
+ * С закрытыми перегонами маршрутизатор отвечает так же, как построенный без отсечения
+ * параллельных рёбер по каталогу, где маршруты разрезаны по закрытым перегонам,
+ * в том числе при отсечении параллельных рёбер и после загрузки из файла
+ */
+void TestSegmentClosuresMatchRebuild() {
+    using transport::RoutingAlgorithm;
+    const size_t stop_count = 8;
+    const size_t bus_count = 10;
+    std::remove(CACHE_FILE.c_str());
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        transport::Catalogue catalogue;
+        testing::FillRandomCatalogue(catalogue, seed, stop_count, bus_count);
+        const auto buses = catalogue.GetBuses(transport::SORTED);
+        std::mt19937 generator(seed);
+        for (const size_t closure_count : {1, 2, 3}) {
+            std::set<std::pair<std::string, std::string>> segments;
+            for (size_t i = 0; i < closure_count; ++i) {
+                const auto bus = buses[generator() % buses.size()];
+                const size_t position = generator() % (bus->stops.size() - 1);
+                segments.emplace(bus->stops[position]->name, bus->stops[position + 1]->name);
+            }
+            transport::Catalogue rebuilt_catalogue;
+            testing::FillRandomCatalogue(rebuilt_catalogue, seed, stop_count, bus_count);
+            SplitRoutes(rebuilt_catalogue, segments);
+            auto rebuilt_settings = MakeSettings(RoutingAlgorithm::DIJKSTRA);
+            rebuilt_settings.prune_parallel_edges = false;
+            transport::Router rebuilt(rebuilt_settings);
+            rebuilt.Build(rebuilt_catalogue);
+            const auto expected = CollectTimes(rebuilt, rebuilt_catalogue);
+
+            for (const auto algorithm : {RoutingAlgorithm::FLOYD_WARSHALL, RoutingAlgorithm::DIJKSTRA,
+                                         RoutingAlgorithm::CONTRACTION_HIERARCHIES}) {
+                for (const bool prune_parallel_edges : {false, true}) {
+                    auto settings = algorithm == RoutingAlgorithm::FLOYD_WARSHALL ? MakeCachedSettings()
+                                                                                  : MakeSettings(algorithm);
+                    settings.prune_parallel_edges = prune_parallel_edges;
+                    // файловый маршрутизатор закрывает перегоны после загрузки
+                    for (size_t build = 0; build < (settings.cache_file.empty() ? 1 : 2); ++build) {
+                        transport::Router router(settings);
+                        router.Build(catalogue);
+                        const auto open_times = CollectTimes(router, catalogue);
+                        for (const auto& [from, to] : segments) {
+                            CHECK(router.SetSegmentClosed(catalogue.FindStop(from), catalogue.FindStop(to), true));
+                        }
+                        CheckSameTimes(CollectTimes(router, catalogue), expected);
+                        router.ClearClosures();
+                        CheckSameTimes(CollectTimes(router, catalogue), open_times);
+                    }
+                    std::remove(CACHE_FILE.c_str());
+                }
+            }
+        }
+    }
+}
+/**
+ * При отсечении параллельных рёбер альтернативные маршруты те же, что без отсечения:
+ * поездки разных автобусов по одному перегону остаются разными маршрутами
+ */
+void TestAlternativesKeepParallelRides() {
+    auto settings = MakeSettings(transport::RoutingAlgorithm::DIJKSTRA);
+    auto keep_settings = settings;
+    keep_settings.prune_parallel_edges = false;
+    {
+        transport::Catalogue catalogue;
+        catalogue.AddStop({"A", {55.60, 37.60}});
+        catalogue.AddStop({"B", {55.61, 37.61}});
+        const auto a = catalogue.FindStop("A");
+        const auto b = catalogue.FindStop("B");
+        catalogue.SetDistance(a, b, 1000);
+        catalogue.AddRoute("1", {a, b}, false);
+        catalogue.AddRoute("2", {a, b}, false);
+        transport::Router router(settings);
+        router.Build(catalogue);
+        CHECK(router.GetPrunedEdgeCount() > 0);
+        std::set<std::string> buses;
+        for (const auto& response : router.GetOptimalRoutes(a, b, 3)) {
+            CHECK(response.route.size() == 2);
+            buses.insert(std::get<transport::RouterResponse::Route>(response.route.back()).bus);
+        }
+        CHECK(buses == (std::set<std::string>{"1", "2"}));
+    }
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        transport::Catalogue catalogue;
+        testing::FillRandomCatalogue(catalogue, seed, 8, 10);
+        transport::Router router(settings);
+        router.Build(catalogue);
+        transport::Router keep_router(keep_settings);
+        keep_router.Build(catalogue);
+        CHECK(router.GetPrunedEdgeCount() > 0);
+        CHECK(router.GetEdgeCount() + router.GetPrunedEdgeCount() == keep_router.GetEdgeCount());
+        const auto stops = catalogue.GetStops(transport::SORTED);
+        for (const auto from : stops) {
+            for (const auto to : stops) {
+                // среди равных по времени альтернатив порядок может отличаться
+                std::vector<double> times;
+                for (const auto& response : router.GetOptimalRoutes(from, to, 4)) {
+                    times.push_back(response.total_time);
+                }
+                std::vector<double> expected;
+                for (const auto& response : keep_router.GetOptimalRoutes(from, to, 4)) {
+                    expected.push_back(response.total_time);
+                }
+                CheckSameTimes({times}, {expected});
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    RUN_TEST(TestCacheMatchesFreshBuild);
+    RUN_TEST(TestCorruptedCacheIsRebuilt);
+    RUN_TEST(TestUpdateSavesCache);
+    RUN_TEST(TestUpdateMatchesFreshBuild);
+    RUN_TEST(TestSegmentClosuresMatchRebuild);
+    RUN_TEST(TestAlternativesKeepParallelRides);
+    return testing::Finish();
+}
@@ -0,0 +1,68 @@
+#include "thread_pool.h"
+/**
+ * Средства параллельного выполнения
+ */
+namespace parallel {
+/**
+ * Конструктор.
+ * При thread_count == 0 используются все доступные аппаратные потоки.
+ */
+ThreadPool::ThreadPool(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // вызывающий поток сам участвует в вычислениях
+    workers_.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+/**
+ * Деструктор. Дожидается выполнения поставленных задач.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard(mutex_);
+        stopping_ = true;
+    }
+    has_task_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+/**
+ * Количество потоков, участвующих в вычислениях (включая вызывающий)
+ */
+size_t ThreadPool::GetThreadCount() const {
+    return workers_.size() + 1;
+}
+/**
+ * Поставить задачу в очередь
+ */
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard guard(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    has_task_.notify_one();
+}
+/**
+ * Цикл рабочего потока
+ */
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            has_task_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+}  // namespace parallel
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+/**
+ * Средства параллельного выполнения
+ */
+namespace parallel {
+/**
+ * Пул потоков фиксированного размера
+ */
+class ThreadPool {
+public:
+    /**
+     * Конструктор.
+     * При thread_count == 0 используются все доступные аппаратные потоки.
+     */
+    explicit ThreadPool(size_t thread_count = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    /**
+     * Деструктор. Дожидается выполнения поставленных задач.
+     */
+    ~ThreadPool();
+    /**
+     * Количество потоков, участвующих в вычислениях (включая вызывающий)
+     */
+    size_t GetThreadCount() const;
+    /**
+     * Выполнить func(i) для каждого i из [begin, end) и дождаться завершения.
+     * Вызывающий поток участвует в вычислениях, поэтому допускаются вложенные вызовы.
+     * Первое выброшенное исключение пробрасывается вызывающему.
+     */
+    template <typename Func>
+    void ParallelFor(size_t begin, size_t end, Func func);
+private:
+    /**
+     * Общее состояние одного вызова ParallelFor
+     */
+    struct Batch {
+        std::atomic<size_t> next;
+        size_t end;
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    /**
+     * Поставить задачу в очередь
+     */
+    void Submit(std::function<void()> task);
+    /**
+     * Цикл рабочего потока
+     */
+    void WorkerLoop();
+    /**
+     * Обработать элементы пачки, пока они не закончатся
+     */
+    template <typename Func>
+    static void Drain(Batch& batch, size_t begin, const Func& func);
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable has_task_;
+    bool stopping_ = false;
+};
+
+template <typename Func>
+void ThreadPool::Drain(Batch& batch, size_t begin, const Func& func) {
+    const size_t total = batch.end - begin;
+    for (size_t i = batch.next++; i < batch.end; i = batch.next++) {
+        try {
+            func(i);
+        }
+        catch (...) {
+            std::lock_guard guard(batch.mutex);
+            if (!batch.error) {
+                batch.error = std::current_exception();
+            }
+        }
+        if (++batch.done == total) {
+            std::lock_guard guard(batch.mutex);
+            batch.finished.notify_all();
+        }
+    }
+}
+
+template <typename Func>
+void ThreadPool::ParallelFor(size_t begin, size_t end, Func func) {
+    if (begin >= end) {
+        return;
+    }
+    const size_t total = end - begin;
+    if (workers_.empty() || total == 1) {
+        for (size_t i = begin; i < end; ++i) {
+            func(i);
+        }
+        return;
+    }
+    auto batch = std::make_shared<Batch>();
+    batch->next = begin;
+    batch->end = end;
+    auto shared_func = std::make_shared<Func>(std::move(func));
+    const size_t helpers = std::min(workers_.size(), total - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        Submit([batch, shared_func, begin] {
+            Drain(*batch, begin, *shared_func);
+        });
+    }
+    Drain(*batch, begin, *shared_func);
+
+    std::unique_lock lock(batch->mutex);
+    batch->finished.wait(lock, [&batch, total] { return batch->done == total; });
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+}  // namespace parallel
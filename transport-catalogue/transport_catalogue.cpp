@@ -12,7 +12,9 @@ namespace transport {
 void Catalogue::AddStop(const Stop& stop) {
     if (stopname_to_stop_.count(stop.name)) return;
     stops_.push_back(stop);
+    stops_.back().id = static_cast<uint32_t>(stops_.size() - 1);
     stopname_to_stop_[stops_.back().name] = &stops_.back();
+    distances_.emplace_back();
 }
 /**
  * Добавить маршрут в каталог
@@ -21,7 +23,7 @@ void Catalogue::AddRoute(std::string_view bus_number,
                          const std::vector<const transport::Stop*> &stops,
                          bool is_roundtrip) {
     if (busname_to_bus_.count(bus_number)) return;
-    buses_.push_back({ std::string(bus_number), stops, is_roundtrip});
+    buses_.push_back({ std::string(bus_number), stops, is_roundtrip, {}, static_cast<uint32_t>(buses_.size())});
     Bus* bus = &buses_.back();
     busname_to_bus_[buses_.back().route] = bus;
     // добавляем маршрут в набор каждой остановки, через которую он проходит
@@ -31,6 +33,42 @@ void Catalogue::AddRoute(std::string_view bus_number,
         buses_by_stop.insert(bus);
     }
 }
+/**
+ * Заменить остановки маршрута; если маршрута нет — добавить его
+ */
+void Catalogue::UpdateRoute(std::string_view bus_number,
+                            const std::vector<const transport::Stop*>& stops,
+                            bool is_roundtrip) {
+    auto bus_it = busname_to_bus_.find(bus_number);
+    if (bus_it == busname_to_bus_.end()) {
+        AddRoute(bus_number, stops, is_roundtrip);
+        return;
+    }
+    Bus* bus = &buses_[bus_it->second->id];
+    for (auto stop : bus->stops) {
+        stop_to_buses_[stop].erase(bus);
+    }
+    bus->stops = stops;
+    bus->is_roundtrip = is_roundtrip;
+    for (auto stop : stops) {
+        stop_to_buses_[stop].insert(bus);
+    }
+}
+/**
+ * Задать расписание маршрута
+ */
+void Catalogue::SetDepartures(std::string_view bus_number, std::vector<double> departures) {
+    auto bus_it = busname_to_bus_.find(bus_number);
+    if (bus_it == busname_to_bus_.end()) return;
+    std::sort(departures.begin(), departures.end());
+    buses_[bus_it->second->id].departures = std::move(departures);
+}
+/**
+ * Есть ли расписание хотя бы у одного маршрута
+ */
+bool Catalogue::HasTimetables() const {
+    return std::any_of(buses_.begin(), buses_.end(), [](const Bus& bus) { return !bus.departures.empty(); });
+}
 /**
  * Найти маршрут по его номеру
  */
@@ -92,21 +130,41 @@ const std::vector<const Stop*> Catalogue::GetStops(SortMode sort) const {
 void Catalogue::SetDistance(const transport::Stop *from,
                             const transport::Stop *to,
                             int distance) {
-    if (from == nullptr || to == nullptr) return;
-    distances_[{from, to}] = distance;
+    if (!IsOwnStop(from) || !IsOwnStop(to)) return;
+    auto& entries = distances_[from->id];
+    for (auto& entry : entries) {
+        if (entry.to_id == to->id) {
+            entry.distance = distance;
+            return;
+        }
+    }
+    entries.push_back({to->id, distance});
 }
 /**
  * Получить расстояние между двумя остановками
  */
 int Catalogue::GetDistance(const transport::Stop *from, const transport::Stop *to) const {
-    auto it = distances_.find({from, to});
-    if (it != distances_.end()) {
-        return it->second;
+    if (!IsOwnStop(from) || !IsOwnStop(to)) return 0;
+    if (auto distance = FindDistance(from, to)) {
+        return *distance;
     }
-    it = distances_.find({to, from});
-    if (it != distances_.end()) {
-        return it->second;
+    return FindDistance(to, from).value_or(0);
+}
+/**
+ * Принадлежит ли остановка каталогу: идентификатор указывает на неё саму
+ */
+bool Catalogue::IsOwnStop(const transport::Stop *stop) const {
+    return stop != nullptr && stop->id < stops_.size() && &stops_[stop->id] == stop;
+}
+/**
+ * Расстояние от остановки from до остановки to, заданное именно в этом направлении
+ */
+std::optional<int> Catalogue::FindDistance(const transport::Stop *from, const transport::Stop *to) const {
+    for (const auto& entry : distances_[from->id]) {
+        if (entry.to_id == to->id) {
+            return entry.distance;
+        }
     }
-    else return 0;
+    return std::nullopt;
 }
 }
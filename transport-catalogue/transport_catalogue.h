@@ -7,6 +7,7 @@
 #include <set>
 #include <ostream>
 #include <unordered_set>
+#include <cstdint>
 #include "domain.h"
 /**
  * Сущности транспорта
@@ -50,6 +51,20 @@ public:
     void AddRoute(std::string_view bus_number,
                   const std::vector<const transport::Stop*>& stops,
                   bool is_roundtrip);
+    /**
+     * Заменить остановки маршрута; если маршрута нет — добавить его
+     */
+    void UpdateRoute(std::string_view bus_number,
+                     const std::vector<const transport::Stop*>& stops,
+                     bool is_roundtrip);
+    /**
+     * Задать расписание маршрута — время отправления рейсов от первой остановки
+     */
+    void SetDepartures(std::string_view bus_number, std::vector<double> departures);
+    /**
+     * Есть ли расписание хотя бы у одного маршрута
+     */
+    bool HasTimetables() const;
     /**
      * Найти маршрут по его номеру
      */
@@ -83,14 +98,21 @@ public:
      */
     int GetDistance(const transport::Stop* from, const transport::Stop* to) const;
 private:
-
-    struct DistanceHasher {
-        size_t operator() (const std::pair<const transport::Stop*, const transport::Stop*>& stops) const noexcept {
-            return hasher_(*stops.first) + hasher_(*stops.second) * 37 * 37 * 37;
-        }
-    private:
-        transport::StopHasher hasher_;
+    /**
+     * Расстояние до остановки с идентификатором to_id
+     */
+    struct DistanceEntry {
+        uint32_t to_id;
+        int distance;
     };
+    /**
+     * Принадлежит ли остановка каталогу
+     */
+    bool IsOwnStop(const transport::Stop* stop) const;
+    /**
+     * Расстояние от остановки from до остановки to, заданное именно в этом направлении
+     */
+    std::optional<int> FindDistance(const transport::Stop* from, const transport::Stop* to) const;
     /**
      * Остановки
      */
@@ -108,9 +130,11 @@ private:
      */
     std::unordered_map<std::string_view, const transport::Bus*> busname_to_bus_;
     /**
-     * Расстояния между парами остановок
+     * Расстояния между парами остановок: по идентификатору начальной остановки —
+     * список расстояний до соседних. Соседей у остановки единицы, поэтому поиск —
+     * линейный проход по небольшому непрерывному массиву без хэширования.
      */
-    std::unordered_map<std::pair<const transport::Stop*, const transport::Stop*>, int, DistanceHasher> distances_;
+    std::vector<std::vector<DistanceEntry>> distances_;
     /**
      * Маршруты, проходящие через остановки
      */
@@ -1,51 +1,807 @@
 #include "transport_router.h"
 
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+
 namespace transport {
+
+namespace {
+/**
+ * Создать маршрутизатор с предрасчётом всех пар с заданной политикой хранения.
+ * При наличии пула потоков используется блочный параллельный алгоритм.
+ */
+template <typename Storage>
+std::unique_ptr<graph::RoutingEngine<double>> CreateAllPairsRouter(const graph::DirectedWeightedGraph<double>& graph,
+                                                                   parallel::ThreadPool* thread_pool) {
+    if (thread_pool != nullptr) {
+        return std::make_unique<graph::Router<double, Storage>>(graph, *thread_pool);
+    }
+    return std::make_unique<graph::Router<double, Storage>>(graph);
+}
+/**
+ * Сигнатура файла сохранённого маршрутизатора
+ */
+constexpr char ROUTER_FILE_MAGIC[8] = {'T', 'C', 'R', 'O', 'U', 'T', 'E', 'R'};
+/**
+ * Версия формата файла сохранённого маршрутизатора
+ */
+constexpr uint32_t ROUTER_FILE_VERSION = 3;
+/**
+ * Заголовок файла сохранённого маршрутизатора.
+ * За ним следуют разделы, выровненные на 8 байт (см. RouterFileLayout):
+ * смещения строк, вершины остановок, номера остановок вершин, отброшенные параллельные
+ * рёбра, столбцы замороженного графа, строки (названия рёбер, затем названия остановок),
+ * затем таблица маршрутов — веса и последние рёбра маршрутов.
+ * Числа записываются в порядке байт машины.
+ */
+struct RouterFileHeader {
+    char magic[8];
+    uint32_t version;
+    /**
+     * Размер веса в таблице маршрутов: 4 (float) или 8 (double)
+     */
+    uint32_t weight_size;
+    uint64_t key;
+    uint64_t vertex_count;
+    uint64_t edge_count;
+    uint64_t pruned_edge_count;
+    uint64_t title_count;
+    uint64_t stop_count;
+    uint64_t strings_size;
+    /**
+     * Контрольная сумма разделов до таблицы маршрутов (ComputeChecksum)
+     */
+    uint64_t checksum;
+};
+/**
+ * Смещения разделов файла сохранённого маршрутизатора
+ */
+struct RouterFileLayout {
+    size_t string_offsets = 0;
+    size_t stop_vertices = 0;
+    size_t vertex_stops = 0;
+    size_t pruned_edges = 0;
+    size_t offsets = 0;
+    size_t sources = 0;
+    size_t targets = 0;
+    size_t edge_weights = 0;
+    size_t labels = 0;
+    size_t incoming_offsets = 0;
+    size_t incoming_edges = 0;
+    size_t strings = 0;
+    size_t weights = 0;
+    size_t prev_edges = 0;
+    size_t total_size = 0;
+};
+
+using GraphColumns = graph::DirectedWeightedGraph<double>::Columns;
+using EdgeLabel = graph::DirectedWeightedGraph<double>::EdgeLabel;
+
+static_assert(std::is_trivially_copyable_v<graph::Edge<double>> && std::is_trivially_copyable_v<EdgeLabel>,
+              "Graph edges are stored in the file as is");
+
+size_t AlignUp(size_t offset) {
+    return (offset + 7) / 8 * 8;
+}
+
+RouterFileLayout ComputeLayout(const RouterFileHeader& header) {
+    const size_t table_size = header.vertex_count * header.vertex_count;
+    const size_t vertex_count = header.vertex_count;
+    const size_t edge_count = header.edge_count;
+    RouterFileLayout layout;
+    layout.string_offsets = AlignUp(sizeof(RouterFileHeader));
+    layout.stop_vertices = AlignUp(layout.string_offsets
+                                   + (header.title_count + header.stop_count + 1) * sizeof(uint64_t));
+    layout.vertex_stops = AlignUp(layout.stop_vertices + header.stop_count * sizeof(uint64_t));
+    layout.pruned_edges = AlignUp(layout.vertex_stops + vertex_count * sizeof(uint64_t));
+    layout.offsets = AlignUp(layout.pruned_edges + header.pruned_edge_count * sizeof(graph::Edge<double>));
+    layout.sources = AlignUp(layout.offsets + (vertex_count + 1) * sizeof(graph::EdgeId));
+    layout.targets = AlignUp(layout.sources + edge_count * sizeof(graph::VertexId));
+    layout.edge_weights = AlignUp(layout.targets + edge_count * sizeof(graph::VertexId));
+    layout.labels = AlignUp(layout.edge_weights + edge_count * sizeof(double));
+    layout.incoming_offsets = AlignUp(layout.labels + edge_count * sizeof(EdgeLabel));
+    layout.incoming_edges = AlignUp(layout.incoming_offsets + (vertex_count + 1) * sizeof(graph::EdgeId));
+    layout.strings = AlignUp(layout.incoming_edges + edge_count * sizeof(graph::EdgeId));
+    layout.weights = AlignUp(layout.strings + header.strings_size);
+    layout.prev_edges = AlignUp(layout.weights + table_size * header.weight_size);
+    layout.total_size = layout.prev_edges + table_size * sizeof(uint32_t);
+    return layout;
+}
+/**
+ * Контрольная сумма FNV-1a по 8-байтовым словам: повреждённые веса рёбер нельзя
+ * обнаружить проверкой идентификаторов, а без неё они дали бы неверные маршруты
+ * в обход закрытий
+ */
+uint64_t ComputeChecksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    for (; offset < size; ++offset) {
+        hash ^= static_cast<unsigned char>(data[offset]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+/**
+ * Записать таблицу маршрутов в формате RoutesTableView: сначала веса, затем последние рёбра
+ */
+template <typename StoredWeight, typename Storage>
+void WriteRoutesTable(const Storage& storage, size_t vertex_count, size_t weights_offset,
+                      size_t prev_edges_offset, std::ostream& output) {
+    using View = graph::RoutesTableView<double, StoredWeight>;
+    std::vector<StoredWeight> weights(vertex_count);
+    std::vector<uint32_t> prev_edges(vertex_count);
+    output.seekp(static_cast<std::streamoff>(weights_offset));
+    for (graph::VertexId from = 0; from < vertex_count; ++from) {
+        for (graph::VertexId to = 0; to < vertex_count; ++to) {
+            weights[to] = storage.HasRoute(from, to) ? static_cast<StoredWeight>(storage.GetWeight(from, to))
+                                                     : View::NO_ROUTE;
+        }
+        output.write(reinterpret_cast<const char*>(weights.data()), vertex_count * sizeof(StoredWeight));
+    }
+    output.seekp(static_cast<std::streamoff>(prev_edges_offset));
+    for (graph::VertexId from = 0; from < vertex_count; ++from) {
+        for (graph::VertexId to = 0; to < vertex_count; ++to) {
+            const auto prev_edge = storage.HasRoute(from, to) ? storage.GetPrevEdge(from, to) : std::nullopt;
+            prev_edges[to] = prev_edge ? static_cast<uint32_t>(*prev_edge) : View::NO_EDGE;
+        }
+        output.write(reinterpret_cast<const char*>(prev_edges.data()), vertex_count * sizeof(uint32_t));
+    }
+}
+/**
+ * Ключ сохранённого маршрутизатора после инкрементального обновления: хэш FNV-1a
+ * прежнего ключа и изменённых данных. Одинаковые правки одинаковых исходных данных
+ * дают одинаковый ключ, поэтому такой маршрутизатор можно загрузить при следующем запуске.
+ */
+uint64_t ComputeUpdatedCacheKey(uint64_t key, const Catalogue& catalogue, const RouterUpdate& update) {
+    std::ostringstream text;
+    text << key << '\n';
+    for (const Bus* bus : update.buses) {
+        text << "bus " << bus->route << ' ' << bus->is_roundtrip;
+        for (const Stop* stop : bus->stops) {
+            text << ' ' << stop->name << '\t';
+        }
+        text << '\n';
+    }
+    for (const auto& [stop_from, stop_to] : update.distances) {
+        text << "distance " << stop_from->name << '\t' << stop_to->name << '\t'
+             << catalogue.GetDistance(stop_from, stop_to) << ' ' << catalogue.GetDistance(stop_to, stop_from) << '\n';
+    }
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : text.str()) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+/**
+ * Запас на погрешность вычислений с плавающей точкой, сохраняющий оценку нижней
+ */
+constexpr double LOWER_BOUND_SAFETY_FACTOR = 0.999999;
+/**
+ * Пара вершин графа: начало и конец ребра
+ */
+using VertexPair = std::pair<graph::VertexId, graph::VertexId>;
+
+struct VertexPairHasher {
+    size_t operator() (const VertexPair& vertices) const noexcept {
+        return hasher_(vertices.first) + hasher_(vertices.second) * 37 * 37 * 37;
+    }
+private:
+    std::hash<graph::VertexId> hasher_;
+};
+/**
+ * Ребро lhs лучше параллельного ребра rhs: меньше время, затем меньше пролётов,
+ * затем меньше номер автобуса — выбор не зависит ни от порядка рёбер, ни от того,
+ * какие идентификаторы названий получили автобусы
+ */
+bool IsPreferredEdge(const graph::Edge<double>& lhs, const graph::Edge<double>& rhs,
+                     const std::vector<std::string_view>& titles) {
+    return std::tie(lhs.weight, lhs.quantity, titles[lhs.title_id])
+            < std::tie(rhs.weight, rhs.quantity, titles[rhs.title_id]);
+}
+/**
+ * Оставить лучшее ребро между каждой парой вершин, сохраняя порядок оставшихся рёбер.
+ * Возвращает отброшенные рёбра в прежнем порядке.
+ */
+std::vector<graph::Edge<double>> PruneParallelEdges(std::vector<graph::Edge<double>>& edges,
+                                                    const std::vector<std::string_view>& titles) {
+    std::unordered_map<VertexPair, size_t, VertexPairHasher> best_edges;
+    best_edges.reserve(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const auto [it, inserted] = best_edges.emplace(VertexPair{edges[i].from, edges[i].to}, i);
+        if (!inserted && IsPreferredEdge(edges[i], edges[it->second], titles)) {
+            it->second = i;
+        }
+    }
+    std::vector<graph::Edge<double>> pruned_edges;
+    size_t kept_count = 0;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (best_edges.at({edges[i].from, edges[i].to}) == i) {
+            edges[kept_count++] = edges[i];
+        }
+        else {
+            pruned_edges.push_back(edges[i]);
+        }
+    }
+    edges.resize(kept_count);
+    return pruned_edges;
+}
+
+}
+
 /**
  * Сборка сервиса
  */
 void Router::Build(const Catalogue& catalogue) {
+    // граф и таблица загруженного файла читаются из отображения
+    router_.reset();
+    graph_ = graph::DirectedWeightedGraph<double>();
+    mapped_file_.reset();
+    raptor_.reset();
+    raptor_buses_.clear();
+    pruned_edges_.clear();
+    ResetSearchGraph();
+    closures_.Clear();
+    if (routing_settings_.algorithm == RoutingAlgorithm::RAPTOR && catalogue.HasTimetables()) {
+        BuildRaptor(catalogue);
+        return;
+    }
+    if (IsPersistent() && LoadFromFile(catalogue)) {
+        ApplyClosures();
+        return;
+    }
     const auto& stops_sorted = catalogue.GetStops(SortMode::SORTED);
-    graph_ = std::move(graph::DirectedWeightedGraph<double>(stops_sorted.size() * 2));
-    FillStops(std::move(stops_sorted));
-    FillBuses(catalogue);
-    router_ = std::make_unique<graph::Router<double>>(graph_);
+    if (routing_settings_.graph_model == TransitGraphModel::LINEAR) {
+        size_t vertex_count = stops_sorted.size();
+        for (const auto bus : catalogue.GetBuses(SortMode::SORTED)) {
+            vertex_count += bus->stops.size();
+        }
+        graph_ = graph::DirectedWeightedGraph<double>(vertex_count);
+        FillStopsLinear(stops_sorted);
+        FillBusesLinear(catalogue);
+    }
+    else {
+        graph_ = std::move(graph::DirectedWeightedGraph<double>(stops_sorted.size() * 2));
+        FillStops(std::move(stops_sorted));
+        FillBuses(catalogue);
+    }
+    graph_.Freeze();
+    ApplyClosures();
+    router_ = CreateRoutingEngine(catalogue);
+    if (IsPersistent()) {
+        SaveToFile();
+    }
+}
+/**
+ * Инкрементальное обновление после изменения каталога.
+ * Перестраиваются только рёбра остановок затронутых маршрутов.
+ */
+void Router::Update(const Catalogue& catalogue, const RouterUpdate& update) {
+    const auto& stops = catalogue.GetStops(SortMode::SORTED);
+    const bool same_stops = stops.size() == stop_ids_.size()
+            && std::all_of(stops.begin(), stops.end(), [this](const Stop* stop) { return stop_ids_.count(stop) != 0; });
+    // сохранённый маршрутизатор ищется и записывается по ключу изменённых данных
+    if (!routing_settings_.cache_file.empty()) {
+        routing_settings_.cache_key = ComputeUpdatedCacheKey(routing_settings_.cache_key, catalogue, update);
+    }
+    if (!router_ || !same_stops || routing_settings_.graph_model != TransitGraphModel::SPAN_EDGES) {
+        Build(catalogue);
+        return;
+    }
+    // затронуты изменённые маршруты и маршруты, проходящие между остановками с новым расстоянием
+    std::unordered_set<const Bus*> affected_buses(update.buses.begin(), update.buses.end());
+    for (const auto& [stop_from, stop_to] : update.distances) {
+        const StopInfo* stop_buses = catalogue.GetBusesByStop(stop_from);
+        if (stop_buses == nullptr) {
+            continue;
+        }
+        for (const Bus* bus : *stop_buses) {
+            const auto& bus_stops = bus->stops;
+            for (size_t i = 1; i < bus_stops.size(); ++i) {
+                if ((bus_stops[i - 1] == stop_from && bus_stops[i] == stop_to)
+                    || (bus_stops[i - 1] == stop_to && bus_stops[i] == stop_from)) {
+                    affected_buses.insert(bus);
+                    break;
+                }
+            }
+        }
+    }
+    if (affected_buses.empty()) {
+        return;
+    }
+    // рёбра вершины остановки перестраиваются все сразу: тогда порядок рёбер вершины
+    // и выбор между параллельными рёбрами те же, что при полной сборке. Перестраиваются
+    // вершины остановок затронутых маршрутов до и после правки.
+    std::unordered_set<size_t> affected_titles;
+    std::unordered_set<const Stop*> affected_stops;
+    for (const Bus* bus : affected_buses) {
+        affected_stops.insert(bus->stops.begin(), bus->stops.end());
+        if (const auto title_it = bus_title_ids_.find(bus); title_it != bus_title_ids_.end()) {
+            affected_titles.insert(title_it->second);
+        }
+    }
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        if (affected_titles.count(graph_.GetEdge(edge_id).title_id) != 0) {
+            affected_stops.insert(vertex_stops_[graph_.GetEdgeSource(edge_id)]);
+        }
+    }
+    // рёбра в порядке полной сборки: автобусы по номерам, поездки в порядке остановок
+    std::vector<graph::Edge<double>> new_edges;
+    for (const Bus* bus : catalogue.GetBuses(SortMode::SORTED)) {
+        if (std::none_of(bus->stops.begin(), bus->stops.end(), [&](const Stop* stop) {
+                return affected_stops.count(stop) != 0;
+            })) {
+            continue;
+        }
+        auto title_it = bus_title_ids_.find(bus);
+        if (title_it == bus_title_ids_.end()) {
+            title_it = bus_title_ids_.emplace(bus, edge_titles_.size()).first;
+            edge_titles_.push_back(bus->route);
+        }
+        for (auto& edge : MakeBusEdges(catalogue, bus, title_it->second)) {
+            if (affected_stops.count(vertex_stops_[edge.from]) != 0) {
+                new_edges.push_back(std::move(edge));
+            }
+        }
+    }
+    if (routing_settings_.prune_parallel_edges) {
+        // отброшенные рёбра перестроенных вершин заменяются новыми
+        auto pruned_edges = PruneParallelEdges(new_edges, edge_titles_);
+        pruned_edges_.erase(std::remove_if(pruned_edges_.begin(), pruned_edges_.end(),
+                                           [&](const graph::Edge<double>& edge) {
+                                               return affected_stops.count(vertex_stops_[edge.from]) != 0;
+                                           }),
+                            pruned_edges_.end());
+        pruned_edges_.insert(pruned_edges_.end(), pruned_edges.begin(), pruned_edges.end());
+    }
+    const size_t stop_count = stop_ids_.size();
+    const auto remap = graph_.ReplaceEdges([&](const graph::Edge<double>& edge) {
+        // рёбра ожидания названы по остановкам и не меняются
+        return edge.title_id >= stop_count && affected_stops.count(vertex_stops_[edge.from]) != 0;
+    }, std::move(new_edges));
+    if (!router_->UpdateGraph(remap)) {
+        router_ = CreateRoutingEngine(catalogue);
+        // граф скопирован из отображения при замене рёбер, таблица файла больше не используется
+        mapped_file_.reset();
+    }
+    // идентификаторы рёбер изменились
+    ResetSearchGraph();
+    ApplyClosures();
+    if (IsPersistent()) {
+        SaveToFile();
+    }
 }
 /**
  * Получить оптимальный маршрут
  */
-std::optional<RouterResponse> Router::GetOptimalRoute(const Stop* from, const Stop* to) const {
-    const auto route = router_->BuildRoute(stop_ids_.at(from), stop_ids_.at(to));
+std::optional<RouterResponse> Router::GetOptimalRoute(const Stop* from, const Stop* to,
+                                                     double departure_time) const {
+    if (raptor_) {
+        return GetOptimalJourney(from, to, departure_time);
+    }
+    const auto route = BuildRoute(stop_ids_.at(from), stop_ids_.at(to));
     if (!route) {
         return std::nullopt;
     }
+    return MakeRouterResponse(GetQueryGraph(), route->edges);
+}
+/**
+ * До k оптимальных маршрутов по возрастанию времени.
+ * Альтернативы ищутся по графу поиска: маршруты, отличающиеся только автобусом
+ * на параллельном ребре, не теряются при отсечении параллельных рёбер.
+ */
+std::vector<RouterResponse> Router::GetOptimalRoutes(const Stop* from, const Stop* to, size_t k,
+                                                     double departure_time) const {
+    std::vector<RouterResponse> responses;
+    if (raptor_) {
+        if (auto response = GetOptimalRoute(from, to, departure_time); response && k > 0) {
+            responses.push_back(std::move(*response));
+        }
+        return responses;
+    }
+    const auto& graph = GetSearchGraph();
+    const graph::KShortestPaths<double> paths(graph, stop_ids_.at(to), GetActiveClosures());
+    for (const auto& path : paths.Find(stop_ids_.at(from), k)) {
+        responses.push_back(MakeRouterResponse(graph, path.edges));
+    }
+    return responses;
+}
+/**
+ * Маршруты, оптимальные по Парето по времени и числу пересадок
+ */
+std::vector<ParetoRouterResponse> Router::GetParetoRoutes(const Stop* from, const Stop* to,
+                                                          std::optional<size_t> max_transfers,
+                                                          double departure_time) const {
+    std::vector<ParetoRouterResponse> responses;
+    if (raptor_) {
+        for (const auto& journey : raptor_->BuildParetoJourneys(stop_ids_.at(from), stop_ids_.at(to),
+                                                                departure_time)) {
+            const size_t transfers = journey.legs.empty() ? 0 : journey.legs.size() - 1;
+            if (!max_transfers || transfers <= *max_transfers) {
+                responses.push_back({transfers, MakeJourneyResponse(journey, departure_time)});
+            }
+        }
+        return responses;
+    }
+    // второй критерий — количество посадок: рёбер ожидания автобуса на остановке
+    const auto& graph = GetQueryGraph();
+    const auto is_boarding = [&graph](graph::EdgeId edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        return edge.title_id != NO_TITLE && edge.quantity == 0;
+    };
+    const auto max_boardings = max_transfers ? std::optional<size_t>(*max_transfers + 1) : std::nullopt;
+    const auto& pareto_router = &graph == &graph_ ? pareto_router_ : search_pareto_router_;
+    for (const auto& path : pareto_router.BuildRoutes(stop_ids_.at(from), stop_ids_.at(to), is_boarding,
+                                                      max_boardings, GetActiveClosures())) {
+        responses.push_back({path.count > 0 ? path.count - 1 : 0, MakeRouterResponse(graph, path.edges)});
+    }
+    return responses;
+}
+/**
+ * Описание маршрута по рёбрам графа
+ */
+RouterResponse Router::MakeRouterResponse(const graph::DirectedWeightedGraph<double>& graph,
+                                          const std::vector<graph::EdgeId>& edges) const {
     RouterResponse response;
-    response.route.reserve(route->edges.size());
-    for (const auto edge_id : route->edges) {
-        const auto& edge = graph_.GetEdge(edge_id);
-        if (edge.quantity == 0) {
-            response.route.emplace_back(RouterResponse::Departure{std::string(edge.title),
+    response.route.reserve(edges.size());
+    // предыдущее ребро маршрута было поездкой: следующая поездка продолжает её
+    bool riding = false;
+    for (const auto edge_id : edges) {
+        const auto edge = graph.GetEdge(edge_id);
+        response.total_time += edge.weight;
+        if (edge.title_id == NO_TITLE) {
+            riding = false;
+        }
+        else if (edge.quantity == 0) {
+            riding = false;
+            response.route.emplace_back(RouterResponse::Departure{std::string(edge_titles_[edge.title_id]),
                                                                   edge.weight});
         }
+        else if (riding) {
+            auto& ride = std::get<RouterResponse::Route>(response.route.back());
+            ride.span_count += static_cast<int>(edge.quantity);
+            ride.time += edge.weight;
+        }
         else {
-            response.route.emplace_back(RouterResponse::Route{std::string(edge.title),
+            riding = true;
+            response.route.emplace_back(RouterResponse::Route{std::string(edge_titles_[edge.title_id]),
                                                               static_cast<int>(edge.quantity),
                                                               edge.weight});
         }
-        response.total_time += edge.weight;
     }
     return response;
 }
+/**
+ * Оптимальные маршруты для пакета запросов
+ */
+std::vector<std::optional<RouterResponse>> Router::GetOptimalRoutesBatch(const std::vector<RouteRequest>& requests) const {
+    std::vector<std::optional<RouterResponse>> responses(requests.size());
+    GetThreadPool().ParallelFor(0, requests.size(), [&](size_t i) {
+        const auto& request = requests[i];
+        responses[i] = GetOptimalRoute(request.from, request.to, request.departure_time);
+    });
+    return responses;
+}
+/**
+ * Время поездки между остановками
+ */
+std::optional<double> Router::GetTravelTime(const Stop* from, const Stop* to, double departure_time) const {
+    if (raptor_) {
+        return GetTravelTimes({from}, {to}, departure_time).front().front();
+    }
+    if (GetActiveClosures() != nullptr) {
+        const auto route = BuildRoute(stop_ids_.at(from), stop_ids_.at(to));
+        return route ? std::optional<double>(route->weight) : std::nullopt;
+    }
+    return router_->BuildWeights(stop_ids_.at(from), {stop_ids_.at(to)}).front();
+}
+/**
+ * Матрица времени поездки между остановками
+ */
+std::vector<std::vector<std::optional<double>>> Router::GetTravelTimes(const std::vector<const Stop*>& from,
+                                                                       const std::vector<const Stop*>& to,
+                                                                       double departure_time) const {
+    const auto get_vertices = [this](const std::vector<const Stop*>& stops) {
+        std::vector<graph::VertexId> vertices;
+        vertices.reserve(stops.size());
+        for (const Stop* stop : stops) {
+            vertices.push_back(stop_ids_.at(stop));
+        }
+        return vertices;
+    };
+    const auto sources = get_vertices(from);
+    const auto targets = get_vertices(to);
+    if (const graph::Closures* closures = GetActiveClosures()) {
+        // предрасчёт не учитывает закрытий: один поиск с обходом закрытий на строку
+        std::vector<std::vector<std::optional<double>>> times(sources.size());
+        GetThreadPool().ParallelFor(0, sources.size(), [&](size_t row) {
+            times[row] = graph::ShortestPathTree<double>(GetSearchGraph(), sources[row], targets, closures)
+                    .GetWeights(targets);
+        });
+        return times;
+    }
+    if (!raptor_) {
+        return router_->BuildWeightsTable(sources, targets, GetThreadPool());
+    }
+    // один поиск RAPTOR находит время прибытия сразу на все остановки
+    std::vector<std::vector<std::optional<double>>> times(sources.size());
+    GetThreadPool().ParallelFor(0, sources.size(), [&](size_t row) {
+        const auto arrival_times = raptor_->BuildArrivalTimes(sources[row], departure_time);
+        auto& row_times = times[row];
+        row_times.reserve(targets.size());
+        for (const auto stop : targets) {
+            const auto& arrival_time = arrival_times[stop];
+            row_times.push_back(arrival_time ? std::optional<double>(*arrival_time - departure_time) : std::nullopt);
+        }
+    });
+    return times;
+}
+/**
+ * Остановки, достижимые за ограниченное время
+ */
+std::vector<ReachableStop> Router::GetReachableStops(const Stop* stop, double max_time, bool reverse,
+                                                     double departure_time) const {
+    std::vector<ReachableStop> reachable;
+    if (graph_.GetVertexCount() != 0) {
+        const auto vertices = graph::FindReachableVertices(GetQueryGraph(), stop_ids_.at(stop), max_time, reverse,
+                                                           GetActiveClosures());
+        for (const auto& [vertex_id, time] : vertices) {
+            // в граф входят и вспомогательные вершины, учитываем только вершины остановок
+            const Stop* vertex_stop = vertex_stops_[vertex_id];
+            if (stop_ids_.at(vertex_stop) == vertex_id) {
+                reachable.push_back({vertex_stop, time});
+            }
+        }
+    }
+    else {
+        std::vector<const Stop*> stops;
+        stops.reserve(stop_ids_.size());
+        for (const auto& [other_stop, id] : stop_ids_) {
+            stops.push_back(other_stop);
+        }
+        const auto times = reverse ? GetTravelTimes(stops, {stop}, departure_time)
+                                   : GetTravelTimes({stop}, stops, departure_time);
+        for (size_t i = 0; i < stops.size(); ++i) {
+            const auto& time = reverse ? times[i][0] : times[0][i];
+            if (time && !(max_time < *time)) {
+                reachable.push_back({stops[i], *time});
+            }
+        }
+    }
+    std::sort(reachable.begin(), reachable.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+        return std::tie(lhs.time, lhs.stop->name) < std::tie(rhs.time, rhs.stop->name);
+    });
+    return reachable;
+}
+/**
+ * Закрыть остановку или снова открыть её
+ */
+bool Router::SetStopClosed(const Stop* stop, bool is_closed) {
+    if (is_closed) {
+        closed_stops_.insert(stop);
+    }
+    else {
+        closed_stops_.erase(stop);
+    }
+    ApplyClosures();
+    return graph_.GetVertexCount() != 0;
+}
+/**
+ * Закрыть перегон между соседними остановками маршрутов или снова открыть его
+ */
+bool Router::SetSegmentClosed(const Stop* from, const Stop* to, bool is_closed) {
+    if (is_closed) {
+        closed_segments_.emplace(from, to);
+    }
+    else {
+        closed_segments_.erase({from, to});
+    }
+    ApplyClosures();
+    return graph_.GetVertexCount() != 0;
+}
+/**
+ * Открыть все остановки и перегоны
+ */
+void Router::ClearClosures() {
+    closed_stops_.clear();
+    closed_segments_.clear();
+    ApplyClosures();
+}
+/**
+ * Пересчитать маски закрытий графа.
+ * В модели с рёбрами-пролётами закрываются обе вершины остановки, а поездка —
+ * если она проходит закрытый перегон; в линейной модели закрывается вершина
+ * остановки (вершины автобусов на ней остаются открытыми) и ребро проезда перегона.
+ * Поездка другого автобуса между теми же остановками, отброшенная при отсечении
+ * параллельных рёбер, может не проходить закрытый перегон, поэтому поездки
+ * закрываются в графе поиска с возвращёнными отброшенными рёбрами.
+ */
+void Router::ApplyClosures() {
+    closures_.Clear();
+    if (graph_.GetVertexCount() == 0) {
+        return;
+    }
+    const bool is_linear = routing_settings_.graph_model == TransitGraphModel::LINEAR;
+    for (const Stop* stop : closed_stops_) {
+        const auto it = stop_ids_.find(stop);
+        if (it == stop_ids_.end()) {
+            continue;
+        }
+        closures_.SetVertexClosed(it->second, true);
+        if (!is_linear) {
+            closures_.SetVertexClosed(it->second + 1, true);
+        }
+    }
+    if (closed_segments_.empty()) {
+        return;
+    }
+    if (is_linear) {
+        // вершины автобусов следуют за вершинами всех остановок
+        const size_t stop_count = stop_ids_.size();
+        for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.from >= stop_count && edge.to >= stop_count
+                && closed_segments_.count({vertex_stops_[edge.from], vertex_stops_[edge.to]}) != 0) {
+                closures_.SetEdgeClosed(edge_id, true);
+            }
+        }
+        return;
+    }
+    // поездки, проходящие закрытый перегон: название, начало, конец и количество пролётов
+    using RideKey = std::tuple<size_t, graph::VertexId, graph::VertexId, size_t>;
+    std::set<RideKey> closed_rides;
+    for (const auto& [bus, title_id] : bus_title_ids_) {
+        const auto& bus_stops = bus->stops;
+        for (size_t i = 0; i < bus_stops.size(); ++i) {
+            bool is_crossing = false;
+            for (size_t j = i + 1; j < bus_stops.size(); ++j) {
+                is_crossing = is_crossing || closed_segments_.count({bus_stops[j - 1], bus_stops[j]}) != 0;
+                if (is_crossing) {
+                    closed_rides.emplace(title_id, stop_ids_.at(bus_stops[i]) + 1, stop_ids_.at(bus_stops[j]), j - i);
+                }
+            }
+        }
+    }
+    const auto& graph = GetSearchGraph();
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (closed_rides.count({edge.title_id, edge.from, edge.to, edge.quantity}) != 0) {
+            closures_.SetEdgeClosed(edge_id, true);
+        }
+    }
+}
+/**
+ * Закрытия графа, если что-то закрыто
+ */
+const graph::Closures* Router::GetActiveClosures() const {
+    return closures_.IsEmpty() ? nullptr : &closures_;
+}
+/**
+ * Граф поиска с возвращёнными отброшенными рёбрами
+ */
+const graph::DirectedWeightedGraph<double>& Router::GetSearchGraph() const {
+    if (pruned_edges_.empty()) {
+        return graph_;
+    }
+    // запросы из разных потоков могут обратиться к графу одновременно
+    if (!is_search_graph_built_.load(std::memory_order_acquire)) {
+        std::lock_guard lock(search_graph_mutex_);
+        if (!is_search_graph_built_.load(std::memory_order_relaxed)) {
+            search_graph_ = graph_;
+            search_edge_ids_ = search_graph_.ReplaceEdges([](const graph::Edge<double>&) {
+                return false;
+            }, pruned_edges_).kept;
+            is_search_graph_built_.store(true, std::memory_order_release);
+        }
+    }
+    return search_graph_;
+}
+/**
+ * Граф, по которому ищутся маршруты с учётом закрытий
+ */
+const graph::DirectedWeightedGraph<double>& Router::GetQueryGraph() const {
+    return GetActiveClosures() != nullptr ? GetSearchGraph() : graph_;
+}
+/**
+ * Сбросить граф поиска после изменения основного графа
+ */
+void Router::ResetSearchGraph() {
+    search_graph_ = graph::DirectedWeightedGraph<double>();
+    search_edge_ids_.clear();
+    is_search_graph_built_ = false;
+}
+/**
+ * Оптимальный маршрут между вершинами графа с учётом закрытий.
+ * Закрытия только убирают пути, поэтому маршрут средства маршрутизации, не задевающий
+ * закрытий, остаётся оптимальным, а если маршрута нет, его нет и с закрытиями.
+ * Иначе выполняется поиск Дейкстры в обход закрытий.
+ */
+std::optional<graph::RoutingEngine<double>::RouteInfo> Router::BuildRoute(graph::VertexId from,
+                                                                          graph::VertexId to) const {
+    const graph::Closures* closures = GetActiveClosures();
+    if (closures != nullptr && (closures->IsVertexClosed(from) || closures->IsVertexClosed(to))) {
+        return std::nullopt;
+    }
+    auto route = router_->BuildRoute(from, to);
+    if (!route || closures == nullptr) {
+        return route;
+    }
+    // возвращённые отброшенные рёбра не короче оставленных, поэтому маршрут основного графа,
+    // не задевающий закрытий, оптимален и в графе поиска
+    const auto& graph = GetSearchGraph();
+    if (&graph != &graph_) {
+        for (auto& edge_id : route->edges) {
+            edge_id = search_edge_ids_[edge_id];
+        }
+    }
+    if (!closures->IsPathOpen(graph, route->edges)) {
+        route = graph::ShortestPathTree<double>(graph, from, to, closures).BuildRoute(graph, to);
+    }
+    return route;
+}
+/**
+ * Статистика кэша деревьев кратчайших путей.
+ * Доступна только для алгоритма DIJKSTRA_CACHED.
+ */
+std::optional<graph::CachedDijkstraRouter<double>::CacheStats> Router::GetCacheStats() const {
+    const auto cached_router = dynamic_cast<const graph::CachedDijkstraRouter<double>*>(router_.get());
+    if (cached_router == nullptr) {
+        return std::nullopt;
+    }
+    return cached_router->GetCacheStats();
+}
+/**
+ * Статистика поисков по графу.
+ * Доступна для алгоритмов, выполняющих поиск на каждый запрос.
+ */
+std::optional<graph::SearchStats> Router::GetSearchStats() const {
+    if (!router_) {
+        return std::nullopt;
+    }
+    return router_->GetSearchStats();
+}
+/**
+ * Количество параллельных рёбер, отброшенных при построении графа
+ */
+size_t Router::GetPrunedEdgeCount() const {
+    return pruned_edges_.size();
+}
+/**
+ * Количество рёбер графа маршрутизации
+ */
+size_t Router::GetEdgeCount() const {
+    return graph_.GetEdgeCount();
+}
 /**
  * Заполнить данные об остановках
  */
 void Router::FillStops(const std::vector<const Stop*>& stops) {
     stop_ids_.clear();
+    vertex_stops_.clear();
+    edge_titles_.clear();
     graph::VertexId vertex_id = 0;
     for (const auto stop : stops) {
         stop_ids_[stop] = vertex_id;
+        vertex_stops_.push_back(stop);
+        vertex_stops_.push_back(stop);
+        edge_titles_.push_back(stop->name);
         graph_.AddEdge({
-                stop->name,
+                edge_titles_.size() - 1,
                 0,
                 vertex_id,
                 ++vertex_id,
@@ -58,22 +814,89 @@ void Router::FillStops(const std::vector<const Stop*>& stops) {
  * Заполнить данные о маршрутах
  */
 void Router::FillBuses(const Catalogue& catalogue) {
+    const auto& buses = catalogue.GetBuses(SortMode::SORTED);
+    bus_title_ids_.clear();
+    std::vector<graph::Edge<double>> bus_edges;
+    for (const auto bus : buses) {
+        const size_t title_id = edge_titles_.size();
+        edge_titles_.push_back(bus->route);
+        bus_title_ids_[bus] = title_id;
+        auto edges = MakeBusEdges(catalogue, bus, title_id);
+        bus_edges.insert(bus_edges.end(), edges.begin(), edges.end());
+    }
+    if (routing_settings_.prune_parallel_edges) {
+        pruned_edges_ = PruneParallelEdges(bus_edges, edge_titles_);
+    }
+    for (const auto& edge : bus_edges) {
+        graph_.AddEdge(edge);
+    }
+}
+/**
+ * Рёбра-поездки маршрута между каждой его остановкой и каждой последующей
+ */
+std::vector<graph::Edge<double>> Router::MakeBusEdges(const Catalogue& catalogue, const Bus* bus,
+                                                      size_t title_id) const {
+    std::vector<graph::Edge<double>> edges;
+    const auto& bus_stops = bus->stops;
+    // расстояния от начала маршрута: каждое расстояние между соседними остановками
+    // запрашивается у каталога один раз, а не для каждой пары остановок
+    std::vector<int> offsets(bus_stops.size(), 0);
+    for (size_t position = 1; position < bus_stops.size(); ++position) {
+        offsets[position] = offsets[position - 1] + catalogue.GetDistance(bus_stops[position - 1], bus_stops[position]);
+    }
+    for (size_t from = 0; from < bus_stops.size(); ++from) {
+        const graph::VertexId vertex_from = stop_ids_.at(bus_stops[from]) + 1;
+        for (size_t to = from + 1; to < bus_stops.size(); ++to) {
+            const int distance = offsets[to] - offsets[from];
+            edges.push_back({title_id,
+                             to - from,
+                             vertex_from,
+                             stop_ids_.at(bus_stops[to]),
+                             (static_cast<double>(distance) / routing_settings_.bus_velocity) * KOEF_MINUTES_PER_METRES
+                            });
+        }
+    }
+    return edges;
+}
+
+/**
+ * Заполнить данные об остановках для линейной модели графа
+ */
+void Router::FillStopsLinear(const std::vector<const Stop*>& stops) {
+    stop_ids_.clear();
+    vertex_stops_.clear();
+    edge_titles_.clear();
+    // идентификатор названия остановки совпадает с идентификатором её вершины
+    for (const auto stop : stops) {
+        stop_ids_[stop] = vertex_stops_.size();
+        vertex_stops_.push_back(stop);
+        edge_titles_.push_back(stop->name);
+    }
+}
+/**
+ * Заполнить данные о маршрутах для линейной модели графа.
+ * Для каждой позиции автобуса на маршруте создаётся вершина; посадка на автобус
+ * стоит времени ожидания, высадка бесплатна, проезд до следующей остановки
+ * стоит времени в пути.
+ */
+void Router::FillBusesLinear(const Catalogue& catalogue) {
     const auto& buses = catalogue.GetBuses(SortMode::SORTED);
     for (const auto bus : buses) {
         const auto& bus_stops = bus->stops;
-        auto stops_end = bus_stops.end();
-        for (auto it_from = bus_stops.begin(); it_from != stops_end; ++it_from) {
-            const transport::Stop* stop_from = *it_from;
-            const transport::Stop* stop_prev = stop_from;
-            int distance = 0;
-            for (auto it_to = std::next(it_from); it_to != stops_end; ++it_to) {
-                const transport::Stop* stop_to = *it_to;
-                distance += catalogue.GetDistance(stop_prev, stop_to);
-                stop_prev = stop_to;
-                graph_.AddEdge({bus->route,
-                                static_cast<size_t>(std::distance(it_from, it_to)),
-                                stop_ids_.at(stop_from) + 1,
-                                stop_ids_.at(stop_to),
+        const size_t title_id = edge_titles_.size();
+        edge_titles_.push_back(bus->route);
+        const graph::VertexId first_vertex = vertex_stops_.size();
+        for (size_t position = 0; position < bus_stops.size(); ++position) {
+            const transport::Stop* stop = bus_stops[position];
+            const graph::VertexId stop_vertex = stop_ids_.at(stop);
+            const graph::VertexId bus_vertex = first_vertex + position;
+            vertex_stops_.push_back(stop);
+            graph_.AddEdge({stop_vertex, 0, stop_vertex, bus_vertex,
+                            static_cast<double>(routing_settings_.bus_wait_time)});
+            graph_.AddEdge({NO_TITLE, 0, bus_vertex, stop_vertex, 0.0});
+            if (position > 0) {
+                const int distance = catalogue.GetDistance(bus_stops[position - 1], stop);
+                graph_.AddEdge({title_id, 1, bus_vertex - 1, bus_vertex,
                                 (static_cast<double>(distance) / routing_settings_.bus_velocity) * KOEF_MINUTES_PER_METRES
                                });
             }
@@ -81,4 +904,485 @@ void Router::FillBuses(const Catalogue& catalogue) {
     }
 }
 
+/**
+ * Построить маршрутизатор по расписанию.
+ * Маршрут RAPTOR — полная последовательность остановок автобуса;
+ * время в пути считается по дорожным расстояниям и скорости автобуса.
+ */
+void Router::BuildRaptor(const Catalogue& catalogue) {
+    graph_ = graph::DirectedWeightedGraph<double>();
+    router_.reset();
+    stop_ids_.clear();
+    vertex_stops_.clear();
+    edge_titles_.clear();
+    bus_title_ids_.clear();
+    for (const auto stop : catalogue.GetStops(SortMode::SORTED)) {
+        stop_ids_[stop] = vertex_stops_.size();
+        vertex_stops_.push_back(stop);
+    }
+    std::vector<transit::TransitRoute> routes;
+    for (const auto bus : catalogue.GetBuses(SortMode::SORTED)) {
+        if (bus->stops.size() < 2) {
+            continue;
+        }
+        transit::TransitRoute route;
+        route.stops.reserve(bus->stops.size());
+        for (const auto stop : bus->stops) {
+            route.stops.push_back(stop_ids_.at(stop));
+        }
+        route.ride_times = GetRideTimes(catalogue, bus);
+        route.departures = bus->departures;
+        routes.push_back(std::move(route));
+        raptor_buses_.push_back(bus);
+    }
+    raptor_ = std::make_unique<transit::RaptorRouter>(vertex_stops_.size(), routes,
+                                                      static_cast<double>(routing_settings_.bus_wait_time));
+}
+/**
+ * Оптимальный маршрут по расписанию
+ */
+std::optional<RouterResponse> Router::GetOptimalJourney(const Stop* from, const Stop* to,
+                                                        double departure_time) const {
+    const auto journey = raptor_->BuildJourney(stop_ids_.at(from), stop_ids_.at(to), departure_time);
+    if (!journey) {
+        return std::nullopt;
+    }
+    return MakeJourneyResponse(*journey, departure_time);
+}
+/**
+ * Описание маршрута по расписанию
+ */
+RouterResponse Router::MakeJourneyResponse(const transit::RaptorRouter::Journey& journey,
+                                           double departure_time) const {
+    RouterResponse response;
+    response.total_time = journey.arrival_time - departure_time;
+    response.route.reserve(journey.legs.size() * 2);
+    for (const auto& leg : journey.legs) {
+        const Stop* board_stop = vertex_stops_[raptor_->GetStop(leg.route, leg.board_position)];
+        response.route.emplace_back(RouterResponse::Departure{board_stop->name, leg.wait_time});
+        response.route.emplace_back(RouterResponse::Route{raptor_buses_[leg.route]->route,
+                                                          static_cast<int>(leg.alight_position - leg.board_position),
+                                                          leg.arrival_time - leg.board_time});
+    }
+    return response;
+}
+/**
+ * Время в пути от первой остановки маршрута до каждой его остановки, в минутах
+ */
+std::vector<double> Router::GetRideTimes(const Catalogue& catalogue, const Bus* bus) const {
+    std::vector<double> ride_times;
+    ride_times.reserve(bus->stops.size());
+    int distance = 0;
+    for (size_t position = 0; position < bus->stops.size(); ++position) {
+        if (position > 0) {
+            distance += catalogue.GetDistance(bus->stops[position - 1], bus->stops[position]);
+        }
+        ride_times.push_back((static_cast<double>(distance) / routing_settings_.bus_velocity) * KOEF_MINUTES_PER_METRES);
+    }
+    return ride_times;
+}
+
+/**
+ * Создать средство маршрутизации по графу в соответствии с настройками
+ */
+std::unique_ptr<graph::RoutingEngine<double>> Router::CreateRoutingEngine(const Catalogue& catalogue) {
+    if (routing_settings_.fixed_point_weights) {
+        if (auto engine = CreateFixedPointRoutingEngine()) {
+            return engine;
+        }
+    }
+    // без расписаний RAPTOR заменяется поиском по графу модели с ожиданием
+    if (routing_settings_.algorithm == RoutingAlgorithm::DIJKSTRA
+        || routing_settings_.algorithm == RoutingAlgorithm::RAPTOR) {
+        return std::make_unique<graph::DijkstraRouter<double>>(graph_);
+    }
+    if (routing_settings_.algorithm == RoutingAlgorithm::HUB_LABELS) {
+        return CreateHubLabelRouter();
+    }
+    if (routing_settings_.algorithm == RoutingAlgorithm::BIDIRECTIONAL_DIJKSTRA) {
+        return std::make_unique<graph::BidirectionalDijkstraRouter<double>>(graph_);
+    }
+    if (routing_settings_.algorithm == RoutingAlgorithm::A_STAR) {
+        return std::make_unique<graph::AStarRouter<double, TravelTimeLowerBound>>(graph_,
+                                                                                  CreateTravelTimeLowerBound(catalogue));
+    }
+    if (routing_settings_.algorithm == RoutingAlgorithm::DIJKSTRA_CACHED) {
+        return std::make_unique<graph::CachedDijkstraRouter<double>>(graph_,
+                                                                     routing_settings_.trees_cache_budget_mb * 1024 * 1024);
+    }
+    if (routing_settings_.algorithm == RoutingAlgorithm::CONTRACTION_HIERARCHIES) {
+        return std::make_unique<graph::ContractionHierarchy<double>>(graph_, GetThreadPool());
+    }
+    parallel::ThreadPool* thread_pool = nullptr;
+    if (routing_settings_.algorithm == RoutingAlgorithm::FLOYD_WARSHALL_PARALLEL) {
+        thread_pool = &GetThreadPool();
+    }
+    if (routing_settings_.compact_routes_storage) {
+        return CreateAllPairsRouter<graph::CompactRoutesStorage<double>>(graph_, thread_pool);
+    }
+    return CreateAllPairsRouter<graph::OptionalRoutesStorage<double>>(graph_, thread_pool);
+}
+
+/**
+ * Создать средство маршрутизации по весам в фиксированной точке
+ */
+std::unique_ptr<graph::RoutingEngine<double>> Router::CreateFixedPointRoutingEngine() {
+    using FixedGraph = graph::DirectedWeightedGraph<FixedPointWeight>;
+    using Engine = graph::RoutingEngine<FixedPointWeight>;
+    std::function<std::unique_ptr<Engine>(const FixedGraph&)> create_engine;
+    switch (routing_settings_.algorithm) {
+    case RoutingAlgorithm::DIJKSTRA:
+    case RoutingAlgorithm::RAPTOR:
+        create_engine = [](const FixedGraph& graph) {
+            return std::make_unique<graph::DijkstraRouter<FixedPointWeight>>(graph);
+        };
+        break;
+    case RoutingAlgorithm::BIDIRECTIONAL_DIJKSTRA:
+        create_engine = [](const FixedGraph& graph) {
+            return std::make_unique<graph::BidirectionalDijkstraRouter<FixedPointWeight>>(graph);
+        };
+        break;
+    case RoutingAlgorithm::CONTRACTION_HIERARCHIES:
+        create_engine = [this](const FixedGraph& graph) {
+            return std::make_unique<graph::ContractionHierarchy<FixedPointWeight>>(graph, GetThreadPool());
+        };
+        break;
+    default:
+        return nullptr;
+    }
+    return std::make_unique<graph::FixedPointRouter<FixedPointWeight>>(graph_, FIXED_POINT_UNITS_PER_MINUTE,
+                                                                       create_engine);
+}
+/**
+ * Загрузить индекс меток-хабов из файла или построить его по иерархии сжатия
+ */
+std::unique_ptr<graph::RoutingEngine<double>> Router::CreateHubLabelRouter() {
+    const auto& cache_file = routing_settings_.cache_file;
+    if (!cache_file.empty()) {
+        std::ifstream input(cache_file, std::ios::binary);
+        auto labels = graph::HubLabels<double>::Load(input, routing_settings_.cache_key);
+        if (labels && labels->GetVertexCount() == graph_.GetVertexCount()) {
+            return std::make_unique<graph::HubLabelRouter<double>>(graph_, std::move(*labels));
+        }
+    }
+    auto labels = graph::HubLabels<double>(graph::ContractionHierarchy<double>(graph_, GetThreadPool()),
+                                           GetThreadPool());
+    if (!cache_file.empty()) {
+        // как и таблица маршрутов, индекс пишется под временным именем и переименовывается целиком
+        const std::string temp_file = cache_file + ".tmp";
+        bool written = false;
+        {
+            std::ofstream output(temp_file, std::ios::binary | std::ios::trunc);
+            if (output) {
+                labels.Save(output, routing_settings_.cache_key);
+                written = output.good();
+            }
+        }
+        if (written) {
+            std::rename(temp_file.c_str(), cache_file.c_str());
+        }
+        else {
+            std::remove(temp_file.c_str());
+        }
+    }
+    return std::make_unique<graph::HubLabelRouter<double>>(graph_, std::move(labels));
+}
+
+/**
+ * Нижняя оценка времени поездки между вершинами графа для поиска A*
+ */
+TravelTimeLowerBound Router::CreateTravelTimeLowerBound(const Catalogue& catalogue) const {
+    // из вершины остановки (ожидания автобуса) уехать можно только после ожидания;
+    // остановки различаются по идентификатору их вершины
+    std::vector<TravelTimeLowerBound::VertexStop> vertex_stops;
+    vertex_stops.reserve(vertex_stops_.size());
+    for (graph::VertexId vertex_id = 0; vertex_id < vertex_stops_.size(); ++vertex_id) {
+        const Stop* stop = vertex_stops_[vertex_id];
+        const graph::VertexId stop_vertex = stop_ids_.at(stop);
+        vertex_stops.push_back({geo::ToCartesian(stop->coordinates),
+                                stop_vertex,
+                                vertex_id == stop_vertex ? static_cast<double>(routing_settings_.bus_wait_time) : 0.0});
+    }
+    // дорожное расстояние может быть меньше географического, поэтому оценка
+    // масштабируется минимальным их отношением
+    double min_distance_ratio = std::numeric_limits<double>::infinity();
+    for (const auto bus : catalogue.GetBuses(SortMode::SORTED)) {
+        const auto& bus_stops = bus->stops;
+        for (size_t i = 1; i < bus_stops.size(); ++i) {
+            const double geo_distance = geo::ComputeDistance(bus_stops[i - 1]->coordinates,
+                                                             bus_stops[i]->coordinates);
+            if (geo_distance > 0.0) {
+                min_distance_ratio = std::min(min_distance_ratio,
+                                              catalogue.GetDistance(bus_stops[i - 1], bus_stops[i]) / geo_distance);
+            }
+        }
+    }
+    if (!std::isfinite(min_distance_ratio)) {
+        min_distance_ratio = 0.0;
+    }
+    const double minutes_per_metre = min_distance_ratio * LOWER_BOUND_SAFETY_FACTOR
+            * KOEF_MINUTES_PER_METRES / routing_settings_.bus_velocity;
+    return TravelTimeLowerBound(std::move(vertex_stops), minutes_per_metre);
+}
+
+/**
+ * Пул потоков для параллельных вычислений, создаётся при первом обращении
+ */
+parallel::ThreadPool& Router::GetThreadPool() const {
+    // запросы из разных потоков могут обратиться к пулу одновременно
+    std::call_once(thread_pool_created_, [this] {
+        thread_pool_ = std::make_unique<parallel::ThreadPool>(routing_settings_.thread_count);
+    });
+    return *thread_pool_;
+}
+
+/**
+ * Сохраняется ли маршрутизатор в файл при текущих настройках
+ */
+bool Router::IsPersistent() const {
+    return !routing_settings_.cache_file.empty()
+            && (routing_settings_.algorithm == RoutingAlgorithm::FLOYD_WARSHALL
+                || routing_settings_.algorithm == RoutingAlgorithm::FLOYD_WARSHALL_PARALLEL);
+}
+/**
+ * Загрузить сохранённый маршрутизатор из файла, отобразив его в память.
+ * Возвращает false, если файла нет, он построен для других данных или повреждён.
+ * Граф и таблица маршрутов читаются из отображения без копирования. При загрузке
+ * проверяются заголовок и разделы до таблицы — их размер линеен по размеру графа;
+ * квадратичная таблица не читается: последние рёбра маршрутов проверяет
+ * RoutesTableView при восстановлении маршрута.
+ */
+bool Router::LoadFromFile(const Catalogue& catalogue) {
+    auto mapped_file = io::MappedFile::Open(routing_settings_.cache_file);
+    if (!mapped_file || mapped_file->GetSize() < sizeof(RouterFileHeader)) {
+        return false;
+    }
+    const char* data = mapped_file->GetData();
+    const size_t file_size = mapped_file->GetSize();
+    RouterFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const uint32_t weight_size = routing_settings_.compact_routes_storage ? sizeof(float) : sizeof(double);
+    if (std::memcmp(header.magic, ROUTER_FILE_MAGIC, sizeof(ROUTER_FILE_MAGIC)) != 0
+        || header.version != ROUTER_FILE_VERSION
+        || header.weight_size != weight_size
+        || header.key != routing_settings_.cache_key) {
+        return false;
+    }
+    // каждый элемент раздела занимает хотя бы байт, а таблица — квадрат числа вершин,
+    // поэтому при таких ограничениях вычисление размещения не переполняется
+    if (header.edge_count > file_size || header.pruned_edge_count > file_size || header.title_count > file_size
+        || header.stop_count > file_size || header.strings_size > file_size || header.stop_count > header.title_count
+        || (header.vertex_count != 0 && header.vertex_count > file_size / header.vertex_count)
+        || header.edge_count >= graph::RoutesTableView<double, double>::NO_EDGE) {
+        return false;
+    }
+    const auto layout = ComputeLayout(header);
+    if (layout.total_size != file_size
+        || header.checksum != ComputeChecksum(data + layout.string_offsets, layout.weights - layout.string_offsets)) {
+        return false;
+    }
+    GraphColumns columns;
+    columns.offsets = reinterpret_cast<const graph::EdgeId*>(data + layout.offsets);
+    columns.sources = reinterpret_cast<const graph::VertexId*>(data + layout.sources);
+    columns.targets = reinterpret_cast<const graph::VertexId*>(data + layout.targets);
+    columns.weights = reinterpret_cast<const double*>(data + layout.edge_weights);
+    columns.labels = reinterpret_cast<const EdgeLabel*>(data + layout.labels);
+    columns.incoming_offsets = reinterpret_cast<const graph::EdgeId*>(data + layout.incoming_offsets);
+    columns.incoming_edges = reinterpret_cast<const graph::EdgeId*>(data + layout.incoming_edges);
+    auto graph = graph::DirectedWeightedGraph<double>::FromColumns(header.vertex_count, header.edge_count, columns);
+    if (!graph) {
+        return false;
+    }
+    const auto is_valid_title = [&header](size_t title_id) {
+        return title_id < header.title_count || title_id == NO_TITLE;
+    };
+    for (size_t edge_id = 0; edge_id < header.edge_count; ++edge_id) {
+        if (!is_valid_title(columns.labels[edge_id].title_id)) {
+            return false;
+        }
+    }
+    const auto pruned_edges = reinterpret_cast<const graph::Edge<double>*>(data + layout.pruned_edges);
+    for (size_t i = 0; i < header.pruned_edge_count; ++i) {
+        const auto& edge = pruned_edges[i];
+        if (edge.from >= header.vertex_count || edge.to >= header.vertex_count || !is_valid_title(edge.title_id)) {
+            return false;
+        }
+    }
+    const auto string_offsets = reinterpret_cast<const uint64_t*>(data + layout.string_offsets);
+    const size_t string_count = header.title_count + header.stop_count;
+    for (size_t i = 0; i < string_count; ++i) {
+        if (string_offsets[i] > string_offsets[i + 1]) {
+            return false;
+        }
+    }
+    if (string_offsets[0] != 0 || string_offsets[string_count] != header.strings_size) {
+        return false;
+    }
+    const auto get_string = [&](size_t index) {
+        return std::string_view(data + layout.strings + string_offsets[index],
+                                string_offsets[index + 1] - string_offsets[index]);
+    };
+    const auto stop_vertices = reinterpret_cast<const uint64_t*>(data + layout.stop_vertices);
+    const auto vertex_stops = reinterpret_cast<const uint64_t*>(data + layout.vertex_stops);
+    std::vector<const Stop*> stops;
+    std::unordered_map<const Stop*, graph::VertexId> stop_ids;
+    for (size_t i = 0; i < header.stop_count; ++i) {
+        const Stop* stop = catalogue.FindStop(get_string(header.title_count + i));
+        if (stop == nullptr || stop_vertices[i] >= header.vertex_count
+            || vertex_stops[stop_vertices[i]] != i) {
+            return false;
+        }
+        stops.push_back(stop);
+        stop_ids[stop] = stop_vertices[i];
+    }
+    std::vector<const Stop*> vertex_stop_pointers;
+    vertex_stop_pointers.reserve(header.vertex_count);
+    for (size_t vertex_id = 0; vertex_id < header.vertex_count; ++vertex_id) {
+        if (vertex_stops[vertex_id] >= header.stop_count) {
+            return false;
+        }
+        vertex_stop_pointers.push_back(stops[vertex_stops[vertex_id]]);
+    }
+    // названия рёбер: сначала названия остановок, затем номера автобусов;
+    // они ссылаются на строки каталога, а не отображения, которое Update может снять
+    std::vector<std::string_view> edge_titles;
+    std::unordered_map<const Bus*, size_t> bus_title_ids;
+    for (size_t title_id = 0; title_id < header.title_count; ++title_id) {
+        if (title_id < header.stop_count) {
+            const Stop* stop = catalogue.FindStop(get_string(title_id));
+            if (stop == nullptr) {
+                return false;
+            }
+            edge_titles.push_back(stop->name);
+            continue;
+        }
+        const Bus* bus = catalogue.FindRoute(get_string(title_id));
+        if (bus == nullptr) {
+            return false;
+        }
+        edge_titles.push_back(bus->route);
+        bus_title_ids[bus] = title_id;
+    }
+
+    graph_ = std::move(*graph);
+    stop_ids_ = std::move(stop_ids);
+    vertex_stops_ = std::move(vertex_stop_pointers);
+    edge_titles_ = std::move(edge_titles);
+    bus_title_ids_ = std::move(bus_title_ids);
+    pruned_edges_.assign(pruned_edges, pruned_edges + header.pruned_edge_count);
+    const auto prev_edges = reinterpret_cast<const uint32_t*>(data + layout.prev_edges);
+    if (routing_settings_.compact_routes_storage) {
+        router_ = std::make_unique<graph::RoutesTableView<double, float>>(
+                graph_, reinterpret_cast<const float*>(data + layout.weights), prev_edges);
+    }
+    else {
+        router_ = std::make_unique<graph::RoutesTableView<double, double>>(
+                graph_, reinterpret_cast<const double*>(data + layout.weights), prev_edges);
+    }
+    mapped_file_ = std::move(mapped_file);
+    return true;
+}
+/**
+ * Сохранить граф, остановки и таблицу маршрутов в файл
+ */
+void Router::SaveToFile() const {
+    if (graph_.GetEdgeCount() >= std::numeric_limits<uint32_t>::max()) {
+        return;
+    }
+    std::vector<std::string_view> strings(edge_titles_.begin(), edge_titles_.end());
+    std::vector<uint64_t> stop_vertices;
+    std::unordered_map<const Stop*, uint64_t> stop_indices;
+    for (const auto& [stop, vertex_id] : stop_ids_) {
+        stop_indices[stop] = stop_vertices.size();
+        strings.push_back(stop->name);
+        stop_vertices.push_back(vertex_id);
+    }
+    std::vector<uint64_t> vertex_stops;
+    vertex_stops.reserve(vertex_stops_.size());
+    for (const Stop* stop : vertex_stops_) {
+        vertex_stops.push_back(stop_indices.at(stop));
+    }
+    std::vector<uint64_t> string_offsets = {0};
+    for (const auto string : strings) {
+        string_offsets.push_back(string_offsets.back() + string.size());
+    }
+
+    RouterFileHeader header{};
+    std::memcpy(header.magic, ROUTER_FILE_MAGIC, sizeof(ROUTER_FILE_MAGIC));
+    header.version = ROUTER_FILE_VERSION;
+    header.weight_size = routing_settings_.compact_routes_storage ? sizeof(float) : sizeof(double);
+    header.key = routing_settings_.cache_key;
+    header.vertex_count = graph_.GetVertexCount();
+    header.edge_count = graph_.GetEdgeCount();
+    header.pruned_edge_count = pruned_edges_.size();
+    header.title_count = edge_titles_.size();
+    header.stop_count = stop_vertices.size();
+    header.strings_size = string_offsets.back();
+    const auto layout = ComputeLayout(header);
+
+    // файл пишется под временным именем и переименовывается целиком,
+    // чтобы параллельно запущенный процесс не отобразил недописанный файл
+    const std::string temp_file = routing_settings_.cache_file + ".tmp";
+    bool written = false;
+    {
+        std::ofstream output(temp_file, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            return;
+        }
+        const auto write_section = [&output](size_t offset, const auto* values, size_t count) {
+            output.seekp(static_cast<std::streamoff>(offset));
+            output.write(reinterpret_cast<const char*>(values), count * sizeof(*values));
+        };
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_section(layout.string_offsets, string_offsets.data(), string_offsets.size());
+        write_section(layout.stop_vertices, stop_vertices.data(), stop_vertices.size());
+        write_section(layout.vertex_stops, vertex_stops.data(), vertex_stops.size());
+        write_section(layout.pruned_edges, pruned_edges_.data(), pruned_edges_.size());
+        const size_t vertex_count = header.vertex_count;
+        const size_t edge_count = header.edge_count;
+        const GraphColumns& columns = graph_.GetColumns();
+        write_section(layout.offsets, columns.offsets, vertex_count + 1);
+        write_section(layout.sources, columns.sources, edge_count);
+        write_section(layout.targets, columns.targets, edge_count);
+        write_section(layout.edge_weights, columns.weights, edge_count);
+        write_section(layout.labels, columns.labels, edge_count);
+        write_section(layout.incoming_offsets, columns.incoming_offsets, vertex_count + 1);
+        write_section(layout.incoming_edges, columns.incoming_edges, edge_count);
+        output.seekp(static_cast<std::streamoff>(layout.strings));
+        for (const auto string : strings) {
+            output.write(string.data(), string.size());
+        }
+        bool has_table = true;
+        if (const auto compact_router = dynamic_cast<const graph::Router<double, graph::CompactRoutesStorage<double>>*>(router_.get())) {
+            WriteRoutesTable<float>(compact_router->GetRoutesStorage(), header.vertex_count,
+                                    layout.weights, layout.prev_edges, output);
+        }
+        else if (const auto optional_router = dynamic_cast<const graph::Router<double, graph::OptionalRoutesStorage<double>>*>(router_.get())) {
+            WriteRoutesTable<double>(optional_router->GetRoutesStorage(), header.vertex_count,
+                                     layout.weights, layout.prev_edges, output);
+        }
+        else {
+            has_table = false;
+        }
+        written = has_table && output.good();
+    }
+    if (written) {
+        // контрольная сумма считается по записанному файлу, включая выравнивание разделов
+        const auto mapped_file = io::MappedFile::Open(temp_file);
+        std::fstream output(temp_file, std::ios::binary | std::ios::in | std::ios::out);
+        written = mapped_file && mapped_file->GetSize() == layout.total_size && output;
+        if (written) {
+            header.checksum = ComputeChecksum(mapped_file->GetData() + layout.string_offsets,
+                                              layout.weights - layout.string_offsets);
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            written = output.good();
+        }
+    }
+    if (!written) {
+        std::remove(temp_file.c_str());
+        return;
+    }
+    std::rename(temp_file.c_str(), routing_settings_.cache_file.c_str());
+}
+
 }
@@ -1,10 +1,97 @@
+#pragma once
+
 #include "transport_catalogue.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "cached_dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "astar_router.h"
+#include "bidirectional_dijkstra_router.h"
+#include "hub_labels.h"
+#include "fixed_point_router.h"
+#include "k_shortest_paths.h"
+#include "closures.h"
+#include "pareto_router.h"
+#include "routes_table_view.h"
+#include "mapped_file.h"
+#include "raptor.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <variant>
 
 namespace transport {
+/**
+ * Алгоритм поиска оптимального маршрута
+ */
+enum class RoutingAlgorithm {
+    /**
+     * Предрасчёт маршрутов между всеми парами остановок (Флойд–Уоршелл)
+     */
+    FLOYD_WARSHALL = 0,
+    /**
+     * Блочный многопоточный вариант предрасчёта Флойда–Уоршелла
+     */
+    FLOYD_WARSHALL_PARALLEL,
+    /**
+     * Поиск Дейкстры на каждый запрос, без предрасчёта
+     */
+    DIJKSTRA,
+    /**
+     * Деревья кратчайших путей строятся лениво для каждой остановки отправления
+     * и хранятся в LRU-кэше
+     */
+    DIJKSTRA_CACHED,
+    /**
+     * Иерархия сжатия с двунаправленным поиском
+     */
+    CONTRACTION_HIERARCHIES,
+    /**
+     * Поиск A* на каждый запрос с нижней оценкой времени по расстоянию по прямой
+     */
+    A_STAR,
+    /**
+     * Поиск по расписанию алгоритмом RAPTOR с учётом времени отправления.
+     * Маршруты без расписания ходят с интервалом bus_wait_time; если расписания
+     * нет ни у одного маршрута, используется граф с поиском Дейкстры.
+     */
+    RAPTOR,
+    /**
+     * Двунаправленный поиск Дейкстры на каждый запрос, без предрасчёта
+     */
+    BIDIRECTIONAL_DIJKSTRA,
+    /**
+     * Индекс меток-хабов, построенный по иерархии сжатия: время поездки
+     * (матрица времени) вычисляется слиянием меток без поиска, маршруты
+     * строятся двунаправленным поиском Дейкстры
+     */
+    HUB_LABELS
+};
+/**
+ * Модель графа маршрутизации
+ */
+enum class TransitGraphModel {
+    /**
+     * Две вершины на остановку; ребро-поездка соединяет каждую остановку автобуса
+     * с каждой последующей. Число рёбер квадратично по длине маршрута.
+     */
+    SPAN_EDGES = 0,
+    /**
+     * Вершина на остановку и вершина на каждую позицию автобуса на маршруте;
+     * рёбра посадки (с ожиданием), высадки и проезда до следующей остановки.
+     * Число рёбер линейно по длине маршрута.
+     */
+    LINEAR
+};
 /**
  * Настройки маршрутизации
  */
@@ -19,6 +106,76 @@ struct RoutingSettings {
      * Значение — вещественное число от 1 до 1000.
      */
     double bus_velocity = 0.0;
+    /**
+     * Алгоритм поиска оптимального маршрута
+     */
+    RoutingAlgorithm algorithm = RoutingAlgorithm::FLOYD_WARSHALL;
+    /**
+     * Количество потоков для параллельных вычислений.
+     * 0 — все доступные аппаратные потоки.
+     */
+    size_t thread_count = 0;
+    /**
+     * Хранить таблицу маршрутов всех пар в компактном виде
+     * (вес float и 32-битный идентификатор ребра вместо std::optional)
+     */
+    bool compact_routes_storage = false;
+    /**
+     * Предельный объём кэша деревьев кратчайших путей, в мегабайтах
+     */
+    size_t trees_cache_budget_mb = 256;
+    /**
+     * Модель графа маршрутизации
+     */
+    TransitGraphModel graph_model = TransitGraphModel::SPAN_EDGES;
+    /**
+     * Файл с сохранённым маршрутизатором; пустая строка — не сохранять.
+     * Используется для алгоритмов с предрасчётом всех пар (Флойд–Уоршелл)
+     * и для индекса меток-хабов.
+     */
+    std::string cache_file;
+    /**
+     * Ключ сохранённого маршрутизатора — хэш исходных данных и настроек.
+     * Файл с другим ключом перестраивается. Инкрементальное обновление продолжает
+     * ключ хэшем изменений и сохраняет обновлённый маршрутизатор под новым ключом.
+     */
+    uint64_t cache_key = 0;
+    /**
+     * Оставлять в графе одно лучшее ребро-поездку между каждой парой вершин.
+     * Рёбра разных автобусов по одному пролёту, не короче лучшего, не участвуют
+     * в оптимальных маршрутах. Отброшенные рёбра хранятся отдельно: альтернативные
+     * маршруты (routes_count) и поиск в обход закрытых перегонов идут по графу
+     * с возвращёнными рёбрами, поэтому их ответы не зависят от отсечения.
+     */
+    bool prune_parallel_edges = true;
+    /**
+     * Искать маршруты по весам в фиксированной точке — целым сотым долям секунды.
+     * Применяется к алгоритмам DIJKSTRA (поразрядная куча вместо двоичной),
+     * BIDIRECTIONAL_DIJKSTRA и CONTRACTION_HIERARCHIES, остальные работают с double.
+     * Время в ответах по-прежнему складывается из весов рёбер в минутах.
+     */
+    bool fixed_point_weights = false;
+};
+/**
+ * Изменения каталога для инкрементального обновления маршрутизатора.
+ * Набор остановок должен оставаться прежним.
+ */
+struct RouterUpdate {
+    /**
+     * Добавленные или изменённые маршруты
+     */
+    std::vector<const Bus*> buses;
+    /**
+     * Пары остановок, расстояние между которыми изменено
+     */
+    std::vector<std::pair<const Stop*, const Stop*>> distances;
+};
+/**
+ * Остановка, достижимая за ограниченное время
+ */
+struct ReachableStop {
+    const Stop* stop;
+    double time;
 };
 struct RouterResponse {
     double total_time = 0.0;
@@ -36,13 +193,97 @@ struct RouterResponse {
     std::vector<std::variant<Departure, Route>> route;
 };
 /**
- * Средство маршрутизации
+ * Запрос оптимального маршрута в пакете запросов
+ */
+struct RouteRequest {
+    const Stop* from = nullptr;
+    const Stop* to = nullptr;
+    /**
+     * Время отправления в минутах от начала суток
+     */
+    double departure_time = 0.0;
+};
+/**
+ * Маршрут из множества Парето по времени и числу пересадок
+ */
+struct ParetoRouterResponse {
+    size_t transfers = 0;
+    RouterResponse response;
+};
+/**
+ * Нижняя оценка времени поездки между вершинами графа для поиска A*.
+ * Расстояние по прямой (длина хорды) между остановками, умноженное на минимальное
+ * отношение дорожного расстояния к географическому среди соседних остановок маршрутов,
+ * переведённое во время движения автобуса. Из вершины ожидания до другой остановки
+ * к оценке добавляется время ожидания автобуса: без посадки её не покинуть.
+ * Оценка согласована: хорда удовлетворяет неравенству треугольника,
+ * а вес любого ребра-поездки не меньше оценки между его концами.
+ */
+class TravelTimeLowerBound {
+public:
+    /**
+     * Остановка вершины графа
+     */
+    struct VertexStop {
+        /**
+         * Декартовы координаты остановки
+         */
+        geo::CartesianPoint point;
+        /**
+         * Идентификатор остановки; у вершин одной остановки совпадает
+         */
+        size_t stop_index = 0;
+        /**
+         * Время, которое нужно потратить в вершине до отправления (ожидание автобуса)
+         */
+        double boarding_time = 0.0;
+    };
+
+    TravelTimeLowerBound(std::vector<VertexStop> vertex_stops, double minutes_per_metre)
+        : vertex_stops_(std::move(vertex_stops))
+        , minutes_per_metre_(minutes_per_metre) {}
+
+    double operator()(graph::VertexId from, graph::VertexId to) const {
+        const auto& stop_from = vertex_stops_[from];
+        const auto& stop_to = vertex_stops_[to];
+        if (stop_from.stop_index == stop_to.stop_index) {
+            return 0.0;
+        }
+        return stop_from.boarding_time
+                + geo::ComputeChordDistance(stop_from.point, stop_to.point) * minutes_per_metre_;
+    }
+
+private:
+    /**
+     * Остановка каждой вершины графа
+     */
+    std::vector<VertexStop> vertex_stops_;
+    /**
+     * Нижняя граница времени проезда одного метра расстояния по прямой, в минутах
+     */
+    double minutes_per_metre_;
+};
+/**
+ * Средство маршрутизации.
+ * Константные методы запросов реентерабельны: их можно вызывать одновременно
+ * из разных потоков, пока не выполняются Build, Update и изменение закрытий. Временные данные
+ * поисков берутся из пулов рабочих областей алгоритмов, пул потоков создаётся
+ * при первом обращении ровно один раз.
  */
 class Router {
     /**
      * Коэффициент для перевода км/ч в м/мин
      */
     static constexpr double KOEF_MINUTES_PER_METRES = 0.06;
+    /**
+     * Идентификатор названия ребра, не отображаемого в маршруте (высадка из автобуса)
+     */
+    static constexpr size_t NO_TITLE = std::numeric_limits<size_t>::max();
+    /**
+     * Вес ребра в фиксированной точке — сотые доли секунды
+     */
+    using FixedPointWeight = uint32_t;
+    static constexpr double FIXED_POINT_UNITS_PER_MINUTE = 6000.0;
 public:
     /**
      * Конструктор
@@ -58,9 +299,100 @@ public:
      */
     void Build(const Catalogue &catalogue);
     /**
-     * Получить оптимальный маршрут
+     * Инкрементальное обновление после изменения каталога.
+     * Перестраиваются только рёбра остановок затронутых маршрутов; граф и ответы
+     * совпадают с полной сборкой. Поиски по графу (DIJKSTRA, BIDIRECTIONAL_DIJKSTRA)
+     * продолжают работу, алгоритмы с предрасчётом строятся заново.
+     * Если обновление невозможно (изменился набор остановок, линейная модель графа),
+     * выполняется полная сборка.
+     */
+    void Update(const Catalogue& catalogue, const RouterUpdate& update);
+    /**
+     * Получить оптимальный маршрут.
+     * departure_time — время отправления в минутах от начала суток;
+     * учитывается только при маршрутизации по расписанию.
+     */
+    std::optional<RouterResponse> GetOptimalRoute(const Stop* from, const Stop* to,
+                                                  double departure_time = 0.0) const;
+    /**
+     * Оптимальные маршруты для пакета запросов, в порядке запросов.
+     * Запросы выполняются параллельно на пуле потоков маршрутизатора.
+     */
+    std::vector<std::optional<RouterResponse>> GetOptimalRoutesBatch(const std::vector<RouteRequest>& requests) const;
+    /**
+     * До k оптимальных маршрутов без циклов (простых путей по графу), по возрастанию времени.
+     * При маршрутизации по расписанию граф не строится, и возвращается только
+     * оптимальный маршрут.
+     */
+    std::vector<RouterResponse> GetOptimalRoutes(const Stop* from, const Stop* to, size_t k,
+                                                 double departure_time = 0.0) const;
+    /**
+     * Маршруты, оптимальные по Парето по времени и числу пересадок: по возрастанию
+     * времени и убыванию числа пересадок. max_transfers ограничивает число пересадок.
+     * При маршрутизации по расписанию множество строит RAPTOR по раундам поездок.
      */
-    std::optional<RouterResponse> GetOptimalRoute(const Stop* from, const Stop* to) const;
+    std::vector<ParetoRouterResponse> GetParetoRoutes(const Stop* from, const Stop* to,
+                                                      std::optional<size_t> max_transfers = std::nullopt,
+                                                      double departure_time = 0.0) const;
+    /**
+     * Матрица времени поездки: строка на каждую остановку from, столбец на каждую
+     * остановку to (nullopt — маршрута нет). Вычисляются только суммарные времена,
+     * поиски из разных остановок выполняются параллельно.
+     */
+    std::vector<std::vector<std::optional<double>>> GetTravelTimes(const std::vector<const Stop*>& from,
+                                                                   const std::vector<const Stop*>& to,
+                                                                   double departure_time = 0.0) const;
+    /**
+     * Время поездки между остановками без построения маршрута (nullopt — маршрута нет)
+     */
+    std::optional<double> GetTravelTime(const Stop* from, const Stop* to, double departure_time = 0.0) const;
+    /**
+     * Остановки, достижимые из stop не более чем за max_time минут, по возрастанию времени.
+     * При reverse — остановки, из которых stop достижима за max_time.
+     * Выполняется один ограниченный поиск Дейкстры по графу; при маршрутизации
+     * по расписанию граф не строится, и времена берутся из матрицы времени поездки.
+     */
+    std::vector<ReachableStop> GetReachableStops(const Stop* stop, double max_time, bool reverse = false,
+                                                 double departure_time = 0.0) const;
+    /**
+     * Закрыть остановку (is_closed) или снова открыть её. На закрытой остановке нельзя
+     * сесть в автобус или выйти из него, автобусы проезжают её без остановки;
+     * маршрутов из закрытой остановки и до неё нет.
+     * Закрытия применяются сразу, без пересборки: запросы обходят закрытые вершины
+     * и рёбра графа, а предрасчитанный маршрут, не задевающий закрытий, остаётся в силе.
+     * Закрытия сохраняются при Build и Update. Возвращает false, если граф не строится
+     * (маршрутизация по расписанию) и закрытие будет учтено только после сборки графа.
+     */
+    bool SetStopClosed(const Stop* stop, bool is_closed);
+    /**
+     * Закрыть перегон from → to между соседними остановками маршрутов или снова открыть его.
+     * Закрытие действует на поездки всех автобусов, проходящих перегон в этом направлении.
+     * Поездки других автобусов между теми же остановками, отброшенные при отсечении
+     * параллельных рёбер (prune_parallel_edges), участвуют в поиске в обход закрытий.
+     */
+    bool SetSegmentClosed(const Stop* from, const Stop* to, bool is_closed);
+    /**
+     * Открыть все остановки и перегоны
+     */
+    void ClearClosures();
+    /**
+     * Статистика кэша деревьев кратчайших путей.
+     * Доступна только для алгоритма DIJKSTRA_CACHED.
+     */
+    std::optional<graph::CachedDijkstraRouter<double>::CacheStats> GetCacheStats() const;
+    /**
+     * Статистика поисков по графу.
+     * Доступна для алгоритмов, выполняющих поиск на каждый запрос.
+     */
+    std::optional<graph::SearchStats> GetSearchStats() const;
+    /**
+     * Количество параллельных рёбер, отброшенных при построении графа
+     */
+    size_t GetPrunedEdgeCount() const;
+    /**
+     * Количество рёбер графа маршрутизации (0, если граф не строится)
+     */
+    size_t GetEdgeCount() const;
 private:
     /**
      * Заполнить данные об остановках
@@ -70,6 +402,102 @@ private:
      * Заполнить данные о маршрутах
      */
     void FillBuses(const Catalogue& catalogue);
+    /**
+     * Рёбра-поездки маршрута между каждой его остановкой и каждой последующей
+     */
+    std::vector<graph::Edge<double>> MakeBusEdges(const Catalogue& catalogue, const Bus* bus, size_t title_id) const;
+    /**
+     * Заполнить данные об остановках для линейной модели графа
+     */
+    void FillStopsLinear(const std::vector<const Stop*>& stops);
+    /**
+     * Заполнить данные о маршрутах для линейной модели графа
+     */
+    void FillBusesLinear(const Catalogue& catalogue);
+    /**
+     * Пересчитать маски закрытий графа по закрытым остановкам и перегонам
+     */
+    void ApplyClosures();
+    /**
+     * Закрытия графа или nullptr, если ничего не закрыто
+     */
+    const graph::Closures* GetActiveClosures() const;
+    /**
+     * Граф поиска: основной граф с возвращёнными параллельными рёбрами, отброшенными
+     * при построении. Без отсечения совпадает с основным графом. Строится при первом
+     * обращении, в том числе из константных запросов. Маски закрытий относятся к нему.
+     */
+    const graph::DirectedWeightedGraph<double>& GetSearchGraph() const;
+    /**
+     * Граф, по которому ищутся маршруты с учётом закрытий: при закрытиях — граф поиска,
+     * иначе основной граф
+     */
+    const graph::DirectedWeightedGraph<double>& GetQueryGraph() const;
+    /**
+     * Сбросить граф поиска после изменения основного графа
+     */
+    void ResetSearchGraph();
+    /**
+     * Оптимальный маршрут между вершинами графа с учётом закрытий.
+     * Идентификаторы рёбер маршрута относятся к GetQueryGraph().
+     */
+    std::optional<graph::RoutingEngine<double>::RouteInfo> BuildRoute(graph::VertexId from, graph::VertexId to) const;
+    /**
+     * Описание маршрута по рёбрам графа
+     */
+    RouterResponse MakeRouterResponse(const graph::DirectedWeightedGraph<double>& graph,
+                                      const std::vector<graph::EdgeId>& edges) const;
+    /**
+     * Построить маршрутизатор по расписанию
+     */
+    void BuildRaptor(const Catalogue& catalogue);
+    /**
+     * Оптимальный маршрут по расписанию
+     */
+    std::optional<RouterResponse> GetOptimalJourney(const Stop* from, const Stop* to, double departure_time) const;
+    /**
+     * Описание маршрута по расписанию
+     */
+    RouterResponse MakeJourneyResponse(const transit::RaptorRouter::Journey& journey, double departure_time) const;
+    /**
+     * Время в пути от первой остановки маршрута до каждой его остановки, в минутах
+     */
+    std::vector<double> GetRideTimes(const Catalogue& catalogue, const Bus* bus) const;
+    /**
+     * Создать средство маршрутизации по графу в соответствии с настройками
+     */
+    std::unique_ptr<graph::RoutingEngine<double>> CreateRoutingEngine(const Catalogue& catalogue);
+    /**
+     * Создать средство маршрутизации по весам в фиксированной точке;
+     * nullptr, если алгоритм их не поддерживает
+     */
+    std::unique_ptr<graph::RoutingEngine<double>> CreateFixedPointRoutingEngine();
+    /**
+     * Нижняя оценка времени поездки между вершинами графа для поиска A*
+     */
+    TravelTimeLowerBound CreateTravelTimeLowerBound(const Catalogue& catalogue) const;
+    /**
+     * Загрузить индекс меток-хабов из файла сохранённого маршрутизатора
+     * или построить его и сохранить
+     */
+    std::unique_ptr<graph::RoutingEngine<double>> CreateHubLabelRouter();
+    /**
+     * Пул потоков для параллельных вычислений, создаётся при первом обращении
+     */
+    parallel::ThreadPool& GetThreadPool() const;
+    /**
+     * Сохраняется ли маршрутизатор в файл при текущих настройках
+     */
+    bool IsPersistent() const;
+    /**
+     * Загрузить сохранённый маршрутизатор из файла, отобразив его в память.
+     * Возвращает false, если файла нет, он построен для других данных или повреждён.
+     */
+    bool LoadFromFile(const Catalogue& catalogue);
+    /**
+     * Сохранить граф, остановки и таблицу маршрутов в файл
+     */
+    void SaveToFile() const;
 private:
     /**
      * Настройки маршрутизации
@@ -79,14 +507,76 @@ private:
      * Граф
      */
     graph::DirectedWeightedGraph<double> graph_;
+    /**
+     * Поиск по двум критериям: времени и числу пересадок
+     */
+    graph::ParetoRouter<double> pareto_router_{graph_};
     /**
      * Идентификатор вершины графа по указателю на остановку
+     * (при маршрутизации по расписанию — индекс остановки)
      */
     std::unordered_map<const transport::Stop*, graph::VertexId> stop_ids_;
+    /**
+     * Остановка каждой вершины графа
+     */
+    std::vector<const transport::Stop*> vertex_stops_;
+    /**
+     * Названия рёбер графа по идентификатору: названия остановок и номера автобусов.
+     * Ссылаются на строки каталога.
+     */
+    std::vector<std::string_view> edge_titles_;
+    /**
+     * Идентификатор названия рёбер каждого маршрута
+     */
+    std::unordered_map<const transport::Bus*, size_t> bus_title_ids_;
+    /**
+     * Параллельные рёбра-поездки, отброшенные при построении графа
+     */
+    std::vector<graph::Edge<double>> pruned_edges_;
+    /**
+     * Закрытые остановки
+     */
+    std::unordered_set<const transport::Stop*> closed_stops_;
+    /**
+     * Закрытые перегоны между соседними остановками маршрутов
+     */
+    std::set<std::pair<const transport::Stop*, const transport::Stop*>> closed_segments_;
+    /**
+     * Закрытые вершины и рёбра графа
+     */
+    graph::Closures closures_;
+    /**
+     * Граф поиска с возвращёнными отброшенными рёбрами; строится лениво
+     */
+    mutable graph::DirectedWeightedGraph<double> search_graph_;
+    graph::ParetoRouter<double> search_pareto_router_{search_graph_};
+    /**
+     * Идентификатор в search_graph_ каждого ребра основного графа
+     */
+    mutable std::vector<graph::EdgeId> search_edge_ids_;
+    mutable std::atomic<bool> is_search_graph_built_{false};
+    mutable std::mutex search_graph_mutex_;
     /**
      * Маршрутизация по графу
      */
-    std::unique_ptr<graph::Router<double>> router_;
+    std::unique_ptr<graph::RoutingEngine<double>> router_;
+    /**
+     * Маршрутизация по расписанию; если задана, граф не строится
+     */
+    std::unique_ptr<transit::RaptorRouter> raptor_;
+    /**
+     * Автобус каждого маршрута RAPTOR
+     */
+    std::vector<const Bus*> raptor_buses_;
+    /**
+     * Пул потоков; создаётся лениво, в том числе из константных запросов
+     */
+    mutable std::unique_ptr<parallel::ThreadPool> thread_pool_;
+    mutable std::once_flag thread_pool_created_;
+    /**
+     * Загруженный файл маршрутизатора: граф и таблица маршрутов читаются из него
+     */
+    std::optional<io::MappedFile> mapped_file_;
 };
 
 }